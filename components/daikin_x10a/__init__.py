@@ -1,32 +1,213 @@
+import ast
+
 import esphome.codegen as cg
 import esphome.config_validation as cv
+import esphome.final_validate as fv
 from esphome.components import uart, sensor, text_sensor
 from esphome.const import (
     CONF_ID, CONF_NAME, UNIT_CELSIUS,
     CONF_UNIT_OF_MEASUREMENT, CONF_DEVICE_CLASS,
     CONF_STATE_CLASS, CONF_ACCURACY_DECIMALS,
     CONF_DISABLED_BY_DEFAULT, CONF_FORCE_UPDATE,
+    CONF_UPDATE_INTERVAL, ENTITY_CATEGORY_DIAGNOSTIC,
+    CONF_HOST, CONF_PORT, CONF_PROTOCOL,
+    STATE_CLASS_MEASUREMENT, STATE_CLASS_TOTAL_INCREASING,
+    UNIT_MILLISECOND, UNIT_SECOND,
 )
-from esphome.core import ID
+from esphome.core import CORE, ID
+from esphome.helpers import cpp_string_escape
 
 DEPENDENCIES = ["uart"]
-AUTO_LOAD = ["sensor", "text_sensor"]
+AUTO_LOAD = ["sensor", "text_sensor", "socket"]
 CODEOWNERS = ["@local"]
+# One daikin_x10a block per heat pump, each on its own UART
+MULTI_CONF = True
+DOMAIN = "daikin_x10a"
 
 CONF_UART_ID = "uart_id"
 CONF_REGISTERS = "registers"
+CONF_REGISTRIES = "registries"
+CONF_SCAN_INTERVAL = "scan_interval"
+CONF_BOOT_DELAY = "boot_delay"
+CONF_ADAPTIVE_BACKOFF = "adaptive_backoff"
+CONF_INTERVAL = "interval"
+CONF_PRIORITY = "priority"
+CONF_DECODE_BENCHMARK_BASELINE = "decode_benchmark_baseline"
+CONF_PUBLISH_DEADBAND = "publish_deadband"
+CONF_PUBLISH_DEADBAND_PERCENT = "publish_deadband_percent"
+CONF_PUBLISH_MAX_AGE = "publish_max_age"
+CONF_UART_TASK = "uart_task"
+CONF_DIAGNOSTICS = "diagnostics"
+CONF_TELEMETRY = "telemetry"
+CONF_DECODED_VALUES = "decoded_values"
+CONF_FLUSH_INTERVAL = "flush_interval"
+CONF_WARM_START = "warm_start"
+CONF_WRITE_INTERVAL = "write_interval"
+CONF_STALE_REGISTRIES = "stale_registries"
+CONF_DERIVED = "derived"
+CONF_FORMULA = "formula"
+CONF_INPUTS = "inputs"
+CONF_INTEGRATE = "integrate"
+CONF_MAX_GAP = "max_gap"
+CONF_HISTORY = "history"
+CONF_RESOLUTION = "resolution"
+CONF_RAW_SIZE = "raw_size"
+CONF_MINUTE_SLOTS = "minute_slots"
+CONF_QUARTER_SLOTS = "quarter_hour_slots"
+CONF_PSRAM = "psram"
+CONF_NAME_PREFIX = "name_prefix"
+CONF_REPROBE_INTERVAL = "reprobe_interval"
+CONF_REGISTRY_PROBE = "registry_probe"
 
-# Convids that produce text output (based on convert_one_ in daikin_x10a.cpp)
+# Convids that produce text output (based on select_converter_ in daikin_x10a.cpp)
 TEXT_CONVIDS = {200, 201, 203, 204, 211, 217, 300, 301, 302, 303, 304, 305, 306, 307, 315, 316}
 
+# Every convid select_converter_ has a converter for; rows with any other convid would only ever read "Conv N NA"
+KNOWN_CONVIDS = (
+    {0x00, 100}
+    | set(range(101, 109))
+    | set(range(151, 157))
+    | TEXT_CONVIDS
+    | {312}
+    | set(range(401, 407))
+)
+
+# A frame is at most 255 + 2 bytes: 0x40, registryID, length, data..., checksum
+MAX_DATA_BYTES = 255 + 2 - 4
+
+# Poll interval in milliseconds; "once" (POLL_ONCE = 0) reads the registry a single time after boot
+def poll_interval(value):
+    if isinstance(value, str) and value.lower() == "once":
+        return 0
+    value = cv.positive_time_period_milliseconds(value)
+    if value.total_milliseconds == 0:
+        raise cv.Invalid("Poll interval must be larger than 0, use 'once' to read a registry only at boot")
+    return value.total_milliseconds
+
+# 0 = decoded when its registry is read, 1 = read and published as a sensor. The X10A protocol only has the read request
+# (0x03 0x40 registryID crc), so there is no write mode; settings are changed through the relays (see the selects in m5poe.yaml)
+def register_mode(value):
+    value = cv.int_(value)
+    if value not in (0, 1):
+        raise cv.Invalid(
+            f"Register mode {value} is not supported, use 0 or 1: the X10A protocol can only read registers, not write them"
+        )
+    return value
+
+
+# Field ranges match the narrow types of RegisterDef (register_definitions.h)
 REGISTER_SCHEMA = cv.Schema({
-    cv.Required("mode"): cv.int_,
-    cv.Required("convid"): cv.hex_int,
-    cv.Required("offset"): cv.int_,
-    cv.Required("registryID"): cv.int_,
-    cv.Required("dataSize"): cv.int_,
-    cv.Required("dataType"): cv.int_,
+    cv.Required("mode"): register_mode,
+    cv.Required("convid"): cv.All(cv.hex_int, cv.int_range(min=0, max=0xFFFF)),
+    cv.Required("offset"): cv.int_range(min=0, max=MAX_DATA_BYTES - 1),
+    cv.Required("registryID"): cv.int_range(min=0, max=255),
+    cv.Required("dataSize"): cv.int_range(min=0, max=MAX_DATA_BYTES),
+    cv.Required("dataType"): cv.int_range(min=-128, max=127),
     cv.Required("label"): cv.string,
+    cv.Optional(CONF_INTERVAL): poll_interval,
+    cv.Optional(CONF_PRIORITY): cv.int_range(min=0, max=255),
+})
+
+# Instances that can share the UART task (DaikinX10A::MAX_TASK_INSTANCES)
+MAX_TASK_INSTANCES = 4
+
+# Diagnostic sensors: key -> (unit, accuracy_decimals, state_class); each key has a set_<key>_sensor() setter
+DIAGNOSTIC_SENSORS = {
+    "round_trip_min": (UNIT_MILLISECOND, 1, STATE_CLASS_MEASUREMENT),
+    "round_trip_p50": (UNIT_MILLISECOND, 1, STATE_CLASS_MEASUREMENT),
+    "round_trip_p99": (UNIT_MILLISECOND, 1, STATE_CLASS_MEASUREMENT),
+    "round_trip_max": (UNIT_MILLISECOND, 1, STATE_CLASS_MEASUREMENT),
+    "timeouts": (None, 0, STATE_CLASS_TOTAL_INCREASING),
+    "crc_mismatches": (None, 0, STATE_CLASS_TOTAL_INCREASING),
+    "error_frames": (None, 0, STATE_CLASS_TOTAL_INCREASING),
+    "wrong_registry_frames": (None, 0, STATE_CLASS_TOTAL_INCREASING),
+    "sweep_duration": (UNIT_SECOND, 1, STATE_CLASS_MEASUREMENT),
+    "loop_time_max": (UNIT_MILLISECOND, 2, STATE_CLASS_MEASUREMENT),
+    "bytes_per_second": ("B/s", 0, STATE_CLASS_MEASUREMENT),
+}
+
+
+def _diagnostic_sensor_schema(unit, decimals, state_class):
+    kwargs = {"accuracy_decimals": decimals, "state_class": state_class, "entity_category": ENTITY_CATEGORY_DIAGNOSTIC}
+    if unit is not None:
+        kwargs["unit_of_measurement"] = unit
+    return sensor.sensor_schema(**kwargs)
+
+
+DIAGNOSTICS_SCHEMA = cv.Schema({
+    cv.Optional(CONF_UPDATE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+    **{cv.Optional(key): _diagnostic_sensor_schema(*spec) for key, spec in DIAGNOSTIC_SENSORS.items()},
+    # Which registries answer, e.g. "27 of 30 answer; no answer: 0x30 0x31 0xA1; past frame end: 0x60"
+    cv.Optional(CONF_REGISTRY_PROBE): text_sensor.text_sensor_schema(entity_category=ENTITY_CATEGORY_DIAGNOSTIC),
+})
+
+# Binary stream of every request, frame and (optionally) decoded value; tools/x10a_telemetry.py is the listener
+TELEMETRY_SCHEMA = cv.Schema({
+    cv.Required(CONF_HOST): cv.ipv4address,
+    cv.Required(CONF_PORT): cv.port,
+    cv.Optional(CONF_PROTOCOL, default="udp"): cv.one_of("udp", "tcp", lower=True),
+    cv.Optional(CONF_DECODED_VALUES, default=False): cv.boolean,
+    # Longest time a record waits in the batch before it is sent; a full batch (1400 bytes) goes out right away
+    cv.Optional(CONF_FLUSH_INTERVAL, default="100ms"): cv.positive_time_period_milliseconds,
+})
+
+# Last frame of every registry kept in flash and published again at boot, so sensors have a value before the first sweep
+WARM_START_SCHEMA = cv.Schema({
+    # Shortest time between two flash writes of the changed registries; a clean shutdown (OTA, reboot) writes right away
+    cv.Optional(CONF_WRITE_INTERVAL, default="15min"): cv.All(
+        cv.positive_time_period_milliseconds, cv.Range(min=cv.TimePeriod(minutes=1))
+    ),
+    # Registries whose values still come from flash; drops to 0 once the first sweep has read them all
+    cv.Optional(CONF_STALE_REGISTRIES): sensor.sensor_schema(
+        accuracy_decimals=0, entity_category=ENTITY_CATEGORY_DIAGNOSTIC
+    ),
+})
+
+# Derived metrics (daikin_derived.h): a formula over registers and earlier metrics, or the time integral of a metric (kW -> kWh).
+# Every metric is an ordinary sensor; its id is the name other formulas use for it
+DERIVED_MAX_METRICS = 32  # dirty and dependency sets are 32-bit masks
+DERIVED_STACK_SIZE = 8
+DERIVED_BINOPS = {ast.Add: "ADD", ast.Sub: "SUB", ast.Mult: "MUL", ast.Div: "DIV"}
+DERIVED_CALLS = {"min": ("MIN", 2), "max": ("MAX", 2), "abs": ("ABS", 1)}
+
+DERIVED_SCHEMA = cv.All(
+    sensor.sensor_schema().extend({
+        # e.g. "max(0, flow * (lwt - iwt)) * 4.18 / 60"; numbers, + - * /, min(), max() and abs()
+        cv.Exclusive(CONF_FORMULA, "derived"): cv.string_strict,
+        # id of another derived metric, integrated over time in hours
+        cv.Exclusive(CONF_INTEGRATE, "derived"): cv.validate_id_name,
+        # formula name -> register label
+        cv.Optional(CONF_INPUTS, default={}): cv.Schema({cv.validate_id_name: cv.string}),
+        # integrate: a longer gap between two samples (the HP did not answer) is left out instead of interpolated
+        cv.Optional(CONF_MAX_GAP, default="15min"): cv.positive_time_period_milliseconds,
+    }),
+    cv.has_exactly_one_key(CONF_FORMULA, CONF_INTEGRATE),
+)
+
+# History (daikin_history.h) of selected registers in memory allocated once at boot: every sample delta encoded, plus 1-minute and
+# 15-minute min/avg/max. Exported with GET /history.csv or /history.bin on port, or pushed with export_history() from a lambda
+HISTORY_MAX_SERIES = 32
+HISTORY_SCHEMA = cv.Schema({
+    # register labels, numeric registers of registries that are read
+    cv.Required(CONF_REGISTERS): cv.All(cv.ensure_list(cv.string), cv.Length(min=1, max=HISTORY_MAX_SERIES)),
+    # step every value is stored in; 1-minute and 15-minute values are int16 steps, so they reach +-32767 * resolution
+    cv.Optional(CONF_RESOLUTION, default=0.1): cv.positive_not_null_float,
+    # bytes of raw samples per register, 2-3 bytes a sample
+    cv.Optional(CONF_RAW_SIZE, default=4096): cv.int_range(min=0, max=1 << 20),
+    # 6 bytes each; 360 = 6 hours, 672 = 7 days. Timestamps are uptime (millis), so the 15-minute ring stays below its 49 day wrap
+    cv.Optional(CONF_MINUTE_SLOTS, default=360): cv.int_range(min=0, max=4096),
+    cv.Optional(CONF_QUARTER_SLOTS, default=672): cv.int_range(min=0, max=4096),
+    # a period without new frame repeats the last value for this long (identical frames are not decoded), then stays empty
+    cv.Optional(CONF_MAX_GAP, default="15min"): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_PSRAM, default=False): cv.boolean,
+    cv.Optional(CONF_PORT): cv.port,
+})
+
+# Schedule of a whole registry; overrides the interval/priority derived from its registers
+REGISTRY_SCHEMA = cv.Schema({
+    cv.Required("registryID"): cv.int_range(min=0, max=255),
+    cv.Optional(CONF_INTERVAL): poll_interval,
+    cv.Optional(CONF_PRIORITY): cv.int_range(min=0, max=255),
 })
 
 daikin_x10a_ns = cg.esphome_ns.namespace("daikin_x10a")
@@ -39,60 +220,421 @@ DaikinX10A.add_method(
     [cg.std_string],
 )
 
-# Add method to register dynamic sensors
+# Register handles (index into the generated register table) for lambdas that read a register often
 DaikinX10A.add_method(
-    "register_dynamic_sensor",
+    "find_register",
+    cg.uint16,
+    [cg.const_char_ptr],
+)
+
+DaikinX10A.add_method(
+    "get_register_float",
+    cg.float_,
+    [cg.uint16],
+)
+
+DaikinX10A.add_method(
+    "get_register_text",
+    cg.const_char_ptr,
+    [cg.uint16],
+)
+
+# Add method to bind sensors to a register handle
+DaikinX10A.add_method(
+    "bind_sensor",
     cg.void,
-    [cg.std_string, sensor.Sensor.operator("ptr")],
+    [cg.uint16, sensor.Sensor.operator("ptr")],
 )
 
-# Add method to update dynamic sensors
+# Add method to update bound sensors
 DaikinX10A.add_method(
     "update_sensor",
     cg.void,
-    [cg.std_string, cg.float_],
+    [cg.uint16, cg.float_],
 )
 
-# Add method to register dynamic text sensors
+# Add method to bind text sensors to a register handle
 DaikinX10A.add_method(
-    "register_dynamic_text_sensor",
+    "bind_text_sensor",
     cg.void,
-    [cg.std_string, text_sensor.TextSensor.operator("ptr")],
+    [cg.uint16, text_sensor.TextSensor.operator("ptr")],
 )
 
-CONFIG_SCHEMA = cv.Schema(
+def _register_desc(r):
+    return f"'{r['label']}' (registry 0x{r['registryID']:02X}, offset {r['offset']}, convid {r['convid']})"
+
+
+# Checks the register table as a whole: unknown convids, values that run past the end of a frame and partially overlapping
+# values. Rows that read exactly the same bytes are allowed; the bit tables (300-307) and e.g. a pressure and its
+# converted temperature (105/405) do that by design
+def validate_register_table(config):
+    registers = config.get(CONF_REGISTERS, [])
+    for r in registers:
+        if r["convid"] not in KNOWN_CONVIDS and r["mode"] >= 1:
+            raise cv.Invalid(f"Register {_register_desc(r)} has a convid that cannot be decoded; set its mode to 0")
+        if r["convid"] != 0x00 and r["offset"] + r["dataSize"] > MAX_DATA_BYTES:
+            raise cv.Invalid(
+                f"Register {_register_desc(r)} with dataSize {r['dataSize']} ends beyond the {MAX_DATA_BYTES} data bytes of a frame"
+            )
+
+    by_registry = {}
+    for r in registers:
+        if r["convid"] in KNOWN_CONVIDS and r["convid"] != 0x00 and r["dataSize"] > 0:
+            by_registry.setdefault(r["registryID"], []).append(r)
+    for rows in by_registry.values():
+        rows = sorted(rows, key=lambda r: (r["offset"], r["dataSize"]))
+        for a, b in zip(rows, rows[1:]):
+            same_bytes = a["offset"] == b["offset"] and a["dataSize"] == b["dataSize"]
+            if not same_bytes and b["offset"] < a["offset"] + a["dataSize"]:
+                raise cv.Invalid(f"Register {_register_desc(b)} overlaps {_register_desc(a)}")
+    return config
+
+
+def validate_derived(config):
+    compile_derived(config)
+    return config
+
+
+def validate_history(config):
+    history = config.get(CONF_HISTORY)
+    if history is None:
+        return config
+    if history[CONF_PSRAM] and not CORE.is_esp32:
+        raise cv.Invalid(f"{CONF_HISTORY}: {CONF_PSRAM} is only available on the ESP32")
+    history_handles(config)
+    return config
+
+
+def validate_uart_task(config):
+    if config[CONF_UART_TASK] and not CORE.is_esp32:
+        raise cv.Invalid(f"{CONF_UART_TASK} is only available on the ESP32")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(DaikinX10A),
         cv.Required(CONF_UART_ID): cv.use_id(uart.UARTComponent),
         cv.Required("mode"): cv.int_,
+        # Put in front of the names of the register sensors, so a second heat pump's sensors can be told apart
+        cv.Optional(CONF_NAME_PREFIX, default=""): cv.string,
         cv.Optional(CONF_REGISTERS): cv.ensure_list(REGISTER_SCHEMA),
+        cv.Optional(CONF_REGISTRIES): cv.ensure_list(REGISTRY_SCHEMA),
+        cv.Optional(CONF_SCAN_INTERVAL, default="30s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_BOOT_DELAY, default="15s"): cv.positive_time_period_milliseconds,
+        # Max factor by which a registry's interval stretches while it keeps returning identical data (1 = off)
+        cv.Optional(CONF_ADAPTIVE_BACKOFF, default=4): cv.int_range(min=1, max=64),
+        # A registry the heat pump does not answer at boot leaves the schedule and is only asked again after this time
+        cv.Optional(CONF_REPROBE_INTERVAL, default="60min"): cv.All(
+            cv.positive_time_period_milliseconds, cv.Range(min=cv.TimePeriod(minutes=1))
+        ),
+        # Decode time of all registries measured by run_decode_benchmark() on a known-good build; later builds are compared against it
+        cv.Optional(CONF_DECODE_BENCHMARK_BASELINE): cv.positive_time_period_microseconds,
+        # Change detection: a sensor is only re-published when its value moves past the deadband,
+        # or when publish_max_age has passed since the last full publish of its registry (0s = never)
+        cv.Optional(CONF_PUBLISH_DEADBAND, default=0.0): cv.positive_float,
+        cv.Optional(CONF_PUBLISH_DEADBAND_PERCENT, default="0%"): cv.percentage,
+        cv.Optional(CONF_PUBLISH_MAX_AGE, default="5min"): cv.positive_time_period_milliseconds,
+        # Poll and decode on a FreeRTOS task of its own, so bus timing does not depend on how busy loop() is (ESP32 only)
+        cv.Optional(CONF_UART_TASK, default=False): cv.boolean,
+        # Bus and firmware timing as diagnostic sensors; without this block the instrumentation is not compiled in
+        cv.Optional(CONF_DIAGNOSTICS): DIAGNOSTICS_SCHEMA,
+        cv.Optional(CONF_TELEMETRY): TELEMETRY_SCHEMA,
+        # With warm_start the first sweep starts as soon as the UART is quiet; boot_delay then only caps the wait
+        cv.Optional(CONF_WARM_START): WARM_START_SCHEMA,
+        cv.Optional(CONF_DERIVED): cv.ensure_list(DERIVED_SCHEMA),
+        cv.Optional(CONF_HISTORY): HISTORY_SCHEMA,
     }
-).extend(cv.COMPONENT_SCHEMA)
+).extend(cv.COMPONENT_SCHEMA), validate_register_table, validate_uart_task, validate_derived, validate_history)
+
+
+# Several heat pumps: every block needs a UART, a history port and register sensor names of its own
+def validate_instances(config):
+    instances = fv.full_config.get().get(DOMAIN, [])
+    if len(instances) < 2:
+        return config
+    others = [c for c in instances if c[CONF_ID] != config[CONF_ID]]
+    for other in others:
+        if other[CONF_UART_ID] == config[CONF_UART_ID]:
+            raise cv.Invalid(f"{config[CONF_ID]} and {other[CONF_ID]} use the same UART; every heat pump needs a UART of its own")
+        if other[CONF_NAME_PREFIX] == config[CONF_NAME_PREFIX] and other.get(CONF_REGISTERS) and config.get(CONF_REGISTERS):
+            raise cv.Invalid(
+                f"{config[CONF_ID]} and {other[CONF_ID]} have the same {CONF_NAME_PREFIX}, their register sensors would get the same names"
+            )
+        port = config.get(CONF_HISTORY, {}).get(CONF_PORT)
+        if port is not None and other.get(CONF_HISTORY, {}).get(CONF_PORT) == port:
+            raise cv.Invalid(f"{config[CONF_ID]} and {other[CONF_ID]} both export their history on port {port}")
+    if sum(1 for c in instances if c[CONF_UART_TASK]) > MAX_TASK_INSTANCES:
+        raise cv.Invalid(f"At most {MAX_TASK_INSTANCES} instances can share the UART task")
+    return config
+
+
+FINAL_VALIDATE_SCHEMA = validate_instances
+
+
+# Register sensors keep their daikin_<label> ids while there is one heat pump, so lambdas and automations using them keep working.
+# With several, every instance prefixes its own id: <id>_<label>
+def register_sensor_id_prefix(config):
+    if len(CORE.config.get(DOMAIN, [])) < 2:
+        return "daikin"
+    return config[CONF_ID].id
+
+
+# Emits the register table as one constexpr array, sorted by registryID and offset, which the compiler places in flash.
+# Rows with a convid select_converter_ does not know (only allowed for mode 0) stay in: get_register_value() reads "Conv N NA"
+def register_table_rows(config):
+    return sorted(config.get(CONF_REGISTERS, []), key=lambda r: (r["registryID"], r["offset"]))
+
+# Handle of a register a derived metric or the history reads: it has to be numeric and its registry has to be read
+def numeric_register_handle(config, label, owner):
+    rows = register_table_rows(config)
+    handles = [h for h, r in enumerate(rows) if r["label"] == label]
+    if len(handles) != 1:
+        problem = "is not in the register table" if not handles else "is not unique"
+        raise cv.Invalid(f"{owner}: register label '{label}' {problem}")
+    r = rows[handles[0]]
+    if r["convid"] in TEXT_CONVIDS or r["convid"] == 0x00 or r["convid"] not in KNOWN_CONVIDS:
+        raise cv.Invalid(f"{owner}: register {_register_desc(r)} is not numeric")
+    if not any(o["registryID"] == r["registryID"] and o["mode"] >= 1 for o in rows):
+        raise cv.Invalid(
+            f"{owner}: registry 0x{r['registryID']:02X} of '{label}' is never read, give one of its registers mode 1"
+        )
+    return handles[0]
+
+
+def history_handles(config):
+    labels = config[CONF_HISTORY][CONF_REGISTERS]
+    if len(set(labels)) != len(labels):
+        raise cv.Invalid(f"{CONF_HISTORY}: every register can only be listed once")
+    return [numeric_register_handle(config, label, CONF_HISTORY) for label in labels]
+
+
+def _formula_names(formula):
+    try:
+        tree = ast.parse(formula, mode="eval")
+    except SyntaxError as err:
+        raise cv.Invalid(f"Formula '{formula}': {err.msg}") from err
+    calls = {id(n.func) for n in ast.walk(tree) if isinstance(n, ast.Call)}
+    return tree.body, {n.id for n in ast.walk(tree) if isinstance(n, ast.Name) and id(n) not in calls}
+
+
+# Formula -> postfix program of (code, arg, value); resolve(name) returns ("REGISTER", handle) or ("METRIC", index)
+def _compile_formula(formula, resolve):
+    body, _ = _formula_names(formula)
+    ops = []
+    depth = [0, 0]  # current, deepest
+
+    def push(code, arg=0, value=0.0, pops=0):
+        depth[0] += 1 - pops
+        depth[1] = max(depth[1], depth[0])
+        ops.append((code, arg, value))
+
+    def emit(node):
+        if isinstance(node, ast.Constant) and type(node.value) in (int, float):
+            push("CONST", value=float(node.value))
+        elif isinstance(node, ast.Name):
+            push(*resolve(node.id))
+        elif isinstance(node, ast.UnaryOp) and isinstance(node.op, (ast.USub, ast.UAdd)):
+            emit(node.operand)
+            if isinstance(node.op, ast.USub):
+                push("NEG", pops=1)
+        elif isinstance(node, ast.BinOp) and type(node.op) in DERIVED_BINOPS:
+            emit(node.left)
+            emit(node.right)
+            push(DERIVED_BINOPS[type(node.op)], pops=2)
+        elif (isinstance(node, ast.Call) and isinstance(node.func, ast.Name) and node.func.id in DERIVED_CALLS
+              and not node.keywords and len(node.args) == DERIVED_CALLS[node.func.id][1]):
+            for arg in node.args:
+                emit(arg)
+            push(DERIVED_CALLS[node.func.id][0], pops=len(node.args))
+        else:
+            raise cv.Invalid(
+                f"Formula '{formula}': only numbers, input names, metric ids, + - * /, min(a, b), max(a, b) and abs(a) are supported"
+            )
+
+    emit(body)
+    if depth[1] > DERIVED_STACK_SIZE:
+        raise cv.Invalid(f"Formula '{formula}' nests too deep, at most {DERIVED_STACK_SIZE} intermediate values")
+    return ops
+
+
+# fnv1_hash() of esphome/core/helpers.h
+def _fnv1_hash(text):
+    value = 2166136261
+    for byte in text.encode():
+        value = (value * 16777619) & 0xFFFFFFFF
+        value ^= byte
+    return value
+
+
+# Orders the metrics so every one comes after the metrics it uses and compiles them; returns (ops, defs, metrics in that order)
+# where a def is (first_op, op_count, integrated metric index or None, max_gap_ms, restore_key). An integral keeps its total in the
+# preference of its id, so reordering the block does not hand one total to another metric
+def compile_derived(config):
+    metrics = config.get(CONF_DERIVED, [])
+    if len(metrics) > DERIVED_MAX_METRICS:
+        raise cv.Invalid(f"At most {DERIVED_MAX_METRICS} derived metrics are supported")
+    by_id = {m[CONF_ID].id: m for m in metrics}
+
+    def uses(metric):
+        if CONF_INTEGRATE in metric:
+            names = {metric[CONF_INTEGRATE]}
+        else:
+            names = _formula_names(metric[CONF_FORMULA])[1] - set(metric[CONF_INPUTS])
+        for name in names:
+            if name not in by_id:
+                raise cv.Invalid(f"Derived metric '{metric[CONF_NAME]}': '{name}' is neither one of its inputs nor a derived metric id")
+        return [by_id[name] for name in sorted(names)]
+
+    order, state = [], {}
+    def visit(metric):
+        key = metric[CONF_ID].id
+        if state.get(key) == "done":
+            return
+        if state.get(key) == "visiting":
+            raise cv.Invalid(f"Derived metric '{metric[CONF_NAME]}' depends on itself")
+        state[key] = "visiting"
+        for used in uses(metric):
+            visit(used)
+        state[key] = "done"
+        order.append(metric)
+    for metric in metrics:
+        visit(metric)
+
+    index = {m[CONF_ID].id: i for i, m in enumerate(order)}
+    ops, defs = [], []
+    for metric in order:
+        if CONF_INTEGRATE in metric:
+            key = _fnv1_hash(f"daikin_x10a_derived_{metric[CONF_ID].id}") or 1
+            defs.append((len(ops), 0, index[metric[CONF_INTEGRATE]], metric[CONF_MAX_GAP].total_milliseconds, key))
+            continue
+        inputs = metric[CONF_INPUTS]
+        def resolve(name, metric=metric, inputs=inputs):
+            if name in inputs:
+                return "REGISTER", numeric_register_handle(config, inputs[name], f"Derived metric '{metric[CONF_NAME]}'")
+            return "METRIC", index[name]
+        program = _compile_formula(metric[CONF_FORMULA], resolve)
+        defs.append((len(ops), len(program), None, metric[CONF_MAX_GAP].total_milliseconds, 0))
+        ops += program
+    return ops, defs, order
+
 
 async def to_code(config):
     uart_comp = await cg.get_variable(config[CONF_UART_ID])
     var = cg.new_Pvariable(config[CONF_ID], uart_comp)
     await cg.register_component(var, config)
     await uart.register_uart_device(var, config)
+    cg.add(var.set_instance_name(config[CONF_ID].id))
+
+    cg.add(var.set_publish_deadband(config[CONF_PUBLISH_DEADBAND]))
+    cg.add(var.set_publish_deadband_percent(config[CONF_PUBLISH_DEADBAND_PERCENT]))
+    cg.add(var.set_publish_max_age(config[CONF_PUBLISH_MAX_AGE]))
+    cg.add(var.set_scan_interval(config[CONF_SCAN_INTERVAL]))
+    cg.add(var.set_boot_delay(config[CONF_BOOT_DELAY]))
+    cg.add(var.set_adaptive_backoff(config[CONF_ADAPTIVE_BACKOFF]))
+    cg.add(var.set_reprobe_interval(config[CONF_REPROBE_INTERVAL]))
+    cg.add(var.set_uart_task(config[CONF_UART_TASK]))
+    if CONF_DIAGNOSTICS in config:
+        diagnostics = config[CONF_DIAGNOSTICS]
+        cg.add_define("USE_DAIKIN_X10A_DIAGNOSTICS")
+        cg.add(var.set_diagnostics_interval(diagnostics[CONF_UPDATE_INTERVAL]))
+        for key in DIAGNOSTIC_SENSORS:
+            if key in diagnostics:
+                sens = await sensor.new_sensor(diagnostics[key])
+                cg.add(getattr(var, f"set_{key}_sensor")(sens))
+        if CONF_REGISTRY_PROBE in diagnostics:
+            sens = await text_sensor.new_text_sensor(diagnostics[CONF_REGISTRY_PROBE])
+            cg.add(var.set_registry_probe_sensor(sens))
+    if CONF_DECODE_BENCHMARK_BASELINE in config:
+        cg.add(var.set_benchmark_baseline(config[CONF_DECODE_BENCHMARK_BASELINE].total_microseconds * 1000))
+
+    # Registry schedule: shortest interval and highest priority of its read registers, unless the registry is configured itself
+    schedules = {}
+    for r in config.get(CONF_REGISTERS, []):
+        if r["mode"] < 1 or (CONF_INTERVAL not in r and CONF_PRIORITY not in r):
+            continue
+        interval, priority = schedules.get(r["registryID"], (None, 0))
+        if CONF_INTERVAL in r and r[CONF_INTERVAL] != 0:
+            interval = r[CONF_INTERVAL] if interval in (None, 0) else min(interval, r[CONF_INTERVAL])
+        elif CONF_INTERVAL in r and interval is None:
+            interval = 0
+        priority = max(priority, r.get(CONF_PRIORITY, 0))
+        schedules[r["registryID"]] = (interval, priority)
+    for reg in config.get(CONF_REGISTRIES, []):
+        interval, priority = schedules.get(reg["registryID"], (None, 0))
+        schedules[reg["registryID"]] = (reg.get(CONF_INTERVAL, interval), reg.get(CONF_PRIORITY, priority))
+    for registry_id, (interval, priority) in schedules.items():
+        if interval is None:
+            interval = config[CONF_SCAN_INTERVAL].total_milliseconds
+        cg.add(var.set_registry_schedule(registry_id, interval, priority))
+
+    if CONF_TELEMETRY in config:
+        telemetry = config[CONF_TELEMETRY]
+        cg.add_define("USE_DAIKIN_X10A_TELEMETRY")
+        cg.add(var.set_telemetry_target(str(telemetry[CONF_HOST]), telemetry[CONF_PORT], telemetry[CONF_PROTOCOL] == "tcp"))
+        cg.add(var.set_telemetry_values(telemetry[CONF_DECODED_VALUES]))
+        cg.add(var.set_telemetry_flush_interval(telemetry[CONF_FLUSH_INTERVAL]))
+
+    if CONF_WARM_START in config:
+        warm_start = config[CONF_WARM_START]
+        cg.add_define("USE_DAIKIN_X10A_WARM_START")
+        cg.add(var.set_warm_start_write_interval(warm_start[CONF_WRITE_INTERVAL]))
+        if CONF_STALE_REGISTRIES in warm_start:
+            sens = await sensor.new_sensor(warm_start[CONF_STALE_REGISTRIES])
+            cg.add(var.set_stale_registries_sensor(sens))
+
+    if CONF_HISTORY in config:
+        history = config[CONF_HISTORY]
+        cg.add_define("USE_DAIKIN_X10A_HISTORY")
+        cg.add(var.set_history_storage(
+            history[CONF_RAW_SIZE], history[CONF_MINUTE_SLOTS], history[CONF_QUARTER_SLOTS], history[CONF_RESOLUTION],
+            history[CONF_MAX_GAP], history[CONF_PSRAM],
+        ))
+        for handle in history_handles(config):
+            cg.add(var.add_history_register(handle))
+        if CONF_PORT in history:
+            cg.add(var.set_history_http_port(history[CONF_PORT]))
+
+    table = register_table_rows(config)
+    handles = {id(r): handle for handle, r in enumerate(table)}
+
+    ops, defs, metrics = compile_derived(config)
+    if metrics:
+        cg.add_define("USE_DAIKIN_X10A_DERIVED")
+        prefix = config[CONF_ID].id
+        op_rows = ",\n".join(f"  {{DerivedOp::{code}, {arg}, {value!r}f}}" for code, arg, value in ops)
+        def_rows = ",\n".join(
+            f"  {{{first}, {count}, {'DERIVED_NO_METRIC' if source is None else source}, {max_gap}, {key}UL}}"
+            for first, count, source, max_gap, key in defs
+        )
+        cg.add_global(cg.RawStatement(f"static constexpr DerivedOp {prefix}_derived_ops[] = {{\n{op_rows}\n}};"))
+        cg.add_global(cg.RawStatement(f"static constexpr DerivedDef {prefix}_derived[] = {{\n{def_rows}\n}};"))
+        cg.add(var.set_derived_metrics(
+            cg.RawExpression(f"{prefix}_derived_ops"), cg.RawExpression(f"{prefix}_derived"), len(metrics)
+        ))
+        for i, metric in enumerate(metrics):
+            sens = await sensor.new_sensor(metric)
+            cg.add(var.bind_derived_sensor(i, sens))
+
+    if table:
+        table_id = f"{config[CONF_ID].id}_register_table"
+        entries = ",\n".join(
+            f"  {{{cpp_string_escape(r['label'])}, {r['convid']}, {r['registryID']}, {r['offset']}, "
+            f"{r['dataSize']}, {r['dataType']}, {r['mode']}}}"
+            for r in table
+        )
+        cg.add_global(cg.RawStatement(
+            f"static constexpr RegisterDef {table_id}[] = {{\n{entries}\n}};"
+        ))
+        cg.add(var.set_register_table(cg.RawExpression(table_id), len(table)))
 
     if CONF_REGISTERS in config:
+        id_prefix = register_sensor_id_prefix(config)
         for idx, r in enumerate(config[CONF_REGISTERS]):
-            # Add register to component
-            cg.add(
-                var.add_register(
-                    r["mode"],
-                    r["convid"],
-                    r["offset"],
-                    r["registryID"],
-                    r["dataSize"],
-                    r["dataType"],
-                    r["label"],
-                )
-            )
-
-            # AUTO-CREATE SENSOR for mode=1 registers
+            # AUTO-CREATE SENSOR for mode=1 registers, bound to the register's row in the table by its handle
             if r["mode"] == 1:
-                # Sanitize label for C++ identifier
+                handle = handles[id(r)]
+                # Sanitize label for C++ identifier, prefixed as register_sensor_id_prefix() says
                 label_sanitized = (r["label"]
                                   .lower()
                                   .replace(" ", "_")
@@ -105,22 +647,22 @@ async def to_code(config):
 
                 if is_text:
                     # Text sensor for text-producing convids (217, 307, 200, etc.)
-                    ts_id = ID(f"daikin_{label_sanitized}", is_declaration=True, type=text_sensor.TextSensor)
+                    ts_id = ID(f"{id_prefix}_{label_sanitized}", is_declaration=True, type=text_sensor.TextSensor)
                     ts = cg.new_Pvariable(ts_id)
                     ts_config = {
                         CONF_ID: ts_id,
-                        CONF_NAME: r["label"],
+                        CONF_NAME: config[CONF_NAME_PREFIX] + r["label"],
                         CONF_DISABLED_BY_DEFAULT: False,
                     }
                     await text_sensor.register_text_sensor(ts, ts_config)
-                    cg.add(var.register_dynamic_text_sensor(r["label"], ts))
+                    cg.add(var.bind_text_sensor(handle, ts))
                 else:
                     # Numeric sensor for numeric convids (105, 151, etc.)
-                    sensor_id = ID(f"daikin_{label_sanitized}", is_declaration=True, type=sensor.Sensor)
+                    sensor_id = ID(f"{id_prefix}_{label_sanitized}", is_declaration=True, type=sensor.Sensor)
                     sens = cg.new_Pvariable(sensor_id)
                     sensor_config = {
                         CONF_ID: sensor_id,
-                        CONF_NAME: r["label"],
+                        CONF_NAME: config[CONF_NAME_PREFIX] + r["label"],
                         CONF_UNIT_OF_MEASUREMENT: UNIT_CELSIUS,
                         CONF_DEVICE_CLASS: "temperature",
                         CONF_STATE_CLASS: sensor.StateClasses.STATE_CLASS_MEASUREMENT,
@@ -129,4 +671,4 @@ async def to_code(config):
                         CONF_FORCE_UPDATE: False,
                     }
                     await sensor.register_sensor(sens, sensor_config)
-                    cg.add(var.register_dynamic_sensor(r["label"], sens))
+                    cg.add(var.bind_sensor(handle, sens))
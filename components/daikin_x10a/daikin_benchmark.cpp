@@ -0,0 +1,128 @@
+#include "daikin_x10a.h"
+#include "register_definitions.h"
+#include "esphome/core/log.h"
+#include "daikin_package.h"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef USE_ESP32
+#include <esp_heap_caps.h>
+#endif
+
+namespace esphome {
+namespace daikin_x10a {
+
+static constexpr uint32_t Benchmark_Iterations = 1000;
+static constexpr uint32_t Benchmark_TolerancePercent = 20;  // allowed slowdown against decode_benchmark_baseline
+
+struct BenchmarkFamily {
+  const char *name;
+  int first_convid;
+  int last_convid;
+};
+
+static const BenchmarkFamily Benchmark_Families[] = {
+  {"signed 101-108", 101, 108},
+  {"unsigned 151-156", 151, 156},
+  {"tables 200-316", 200, 316},
+  {"R32 press->temp 401-406", 401, 406},
+};
+
+//__________________________________________________________________________________________________________________________ run_decode_benchmark begin
+// Times the decoder on the device: the converter of every convid family, then convert_registry_values_() on a synthetic frame for every
+// registry of the decode plan, i.e. its eager registers, which is what every frame costs. Register states (values, texts, generations) are
+// restored afterwards and nothing is published. It is not split across loops: polling is suspended while it runs, Benchmark_Iterations
+// decodes of every registry, and a request already sent may time out and is asked again. Not while the UART task runs, which owns the
+// frames
+bool DaikinX10A::run_decode_benchmark() {
+  if (task_running_) {
+    ESP_LOGW("ESPoeDaikin", "run_decode_benchmark() is not available while the UART task is running");
+    return false;
+  }
+  const bool debug = debug_mode_;
+  debug_mode_ = false;
+
+  //____________________________________ selected converter per convid family
+  uint8_t input[2];
+  for (const auto &family : Benchmark_Families) {
+    uint32_t elapsed_us = 0;
+    uint32_t conversions = 0;
+    for (int convid = family.first_convid; convid <= family.last_convid; convid++) {
+      const RegisterDef scratch{"benchmark", (uint16_t)convid, 0, 0, 2, -1, 1};
+      const ConvertFn convert = select_converter_(scratch);
+      if (convert == nullptr || convert == &DaikinX10A::convert_unsupported_) continue;
+      RegisterState state;
+
+      const uint32_t start = micros();
+      for (uint32_t i = 0; i < Benchmark_Iterations; i++) {
+        input[0] = (uint8_t)i;
+        input[1] = (uint8_t)(i >> 3);
+        convert(scratch, state, input);
+      }
+      elapsed_us += micros() - start;
+      conversions += Benchmark_Iterations;
+    }
+    if (conversions == 0) continue;
+    ESP_LOGI("ESPoeDaikin", "Benchmark %-24s %6u ns/register", family.name, (unsigned)((uint64_t)elapsed_us * 1000 / conversions));
+  }
+
+  //____________________________________ convert_registry_values_ per registry, on a frame as long as its furthest register needs
+  // The text pointers of the states point into register_text_, so both are copied back element by element
+  const std::vector<RegisterState> saved_states = register_states_;
+  const std::vector<char> saved_text = register_text_;
+
+#ifdef USE_ESP32
+  const size_t heap_before = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+#endif
+  uint64_t sweep_ns = 0;
+  uint32_t frames = 0;
+  for (size_t registry_id = 0; registry_id < registry_spans_.size(); registry_id++) {
+    const RegistrySpan &span = registry_spans_[registry_id];
+    if (span.eager == 0) continue;
+
+    size_t end = 3;
+    for (uint16_t i = span.first; i < span.first + span.count; i++) end = std::max<size_t>(end, decode_plan_[i].end);
+    if (end + 1 > daikin_package::MAX_FRAME_SIZE) continue;
+
+    daikin_package frame(daikin_package::Mode::RECEIVE);
+    frame.push_back(0x40);
+    frame.push_back((uint8_t)registry_id);
+    frame.push_back((uint8_t)(end - 1));
+    for (size_t i = 3; i < end; i++) frame.push_back((uint8_t)(i * 37 + registry_id));
+    frame.push_back((uint8_t)~0);  // checksum is not looked at by convert_registry_values_()
+
+    const uint32_t start = micros();
+    for (uint32_t i = 0; i < Benchmark_Iterations; i++) convert_registry_values_(frame, span, false);
+    const uint64_t frame_ns = (uint64_t)(micros() - start) * 1000 / Benchmark_Iterations;
+
+    ESP_LOGI("ESPoeDaikin", "Benchmark registry 0x%02X: %3u of %3u registers, %6u ns/frame, %5u ns/register", (unsigned)registry_id,
+             (unsigned)span.eager, (unsigned)span.count, (unsigned)frame_ns, (unsigned)(frame_ns / span.eager));
+    sweep_ns += frame_ns;
+    frames++;
+  }
+#ifdef USE_ESP32
+  const size_t heap_after = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+  const long retained = (long)heap_before - (long)heap_after;
+  ESP_LOGI("ESPoeDaikin", "Benchmark heap retained: %ld bytes over %u frames", retained, (unsigned)(frames * Benchmark_Iterations));
+#endif
+
+  std::copy(saved_states.begin(), saved_states.end(), register_states_.begin());
+  std::copy(saved_text.begin(), saved_text.end(), register_text_.begin());
+  debug_mode_ = debug;
+
+  //____________________________________ regression gate
+  ESP_LOGI("ESPoeDaikin", "Benchmark decode of all %u registries: %u ns", (unsigned)frames, (unsigned)sweep_ns);
+  if (benchmark_baseline_ns_ == 0) return true;
+  const uint64_t limit = (uint64_t)benchmark_baseline_ns_ * (100 + Benchmark_TolerancePercent) / 100;
+  if (sweep_ns > limit) {
+    ESP_LOGW("ESPoeDaikin", "Benchmark regression: %u ns is more than %u%% above the %u ns baseline", (unsigned)sweep_ns,
+             (unsigned)Benchmark_TolerancePercent, (unsigned)benchmark_baseline_ns_);
+    return false;
+  }
+  return true;
+}
+//________________________________________________________________ run_decode_benchmark end
+
+}  // namespace daikin_x10a
+}  // namespace esphome
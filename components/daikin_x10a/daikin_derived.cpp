@@ -0,0 +1,186 @@
+#include "daikin_x10a.h"
+#include "esphome/core/log.h"
+
+#ifdef USE_DAIKIN_X10A_DERIVED
+
+#include <algorithm>
+#include <cmath>
+
+namespace esphome {
+namespace daikin_x10a {
+
+static constexpr uint32_t Derived_SaveIntervalMs = 60000;  // integral totals handed to the preferences, which commit them to flash
+
+//__________________________________________________________________________________________________________________________ derived metrics begin
+void DaikinX10A::set_derived_metrics(const DerivedOp *ops, const DerivedDef *defs, uint8_t count) {
+  derived_ops_ = ops;
+  derived_defs_ = defs;
+  derived_states_.assign(std::min<uint8_t>(count, DERIVED_MAX_METRICS), DerivedState{});
+}
+
+void DaikinX10A::bind_derived_sensor(uint8_t index, sensor::Sensor *sens) {
+  if (index < derived_states_.size()) derived_states_[index].sensor = sens;
+}
+
+float DaikinX10A::get_derived_value(uint8_t index) const {
+  return index < derived_states_.size() ? derived_states_[index].value : NAN;
+}
+
+// Runs from setup(), after compile_registers_(): which registries feed which metrics, and which metrics feed which
+void DaikinX10A::compile_derived_() {
+  derived_triggers_.clear();
+  derived_inputs_.clear();
+  for (uint8_t i = 0; i < derived_states_.size(); i++) {
+    const DerivedDef &def = derived_defs_[i];
+    const uint32_t bit = 1UL << i;
+    if (def.integrate != DERIVED_NO_METRIC) {
+      derived_states_[def.integrate].integrals |= bit;
+      continue;
+    }
+    for (uint16_t op = def.first_op; op < def.first_op + def.op_count; op++) {
+      const DerivedOp &o = derived_ops_[op];
+      if (o.code == DerivedOp::METRIC) derived_states_[o.arg].dependents |= bit;
+      if (o.code != DerivedOp::REGISTER || o.arg >= register_count_) continue;
+      this->queue_register_(o.arg);
+      auto input = std::find_if(derived_inputs_.begin(), derived_inputs_.end(),
+                                [&o](const DerivedInput &in) { return in.handle == o.arg; });
+      if (input == derived_inputs_.end()) {
+        derived_inputs_.push_back(DerivedInput{o.arg, 0});
+        input = derived_inputs_.end() - 1;
+      }
+      input->metrics |= bit;
+
+      const uint8_t registry_id = register_table_[o.arg].registryID;
+      auto trigger = std::find_if(derived_triggers_.begin(), derived_triggers_.end(),
+                                  [registry_id](const DerivedTrigger &t) { return t.registry_id == registry_id; });
+      if (trigger == derived_triggers_.end()) {
+        derived_triggers_.push_back(DerivedTrigger{registry_id, 0, 0});
+        trigger = derived_triggers_.end() - 1;
+      }
+      trigger->metrics |= bit;
+    }
+  }
+  // The metrics come in dependency order: one pass follows every formula of a registry down to the integrals it feeds
+  for (auto &trigger : derived_triggers_) {
+    uint32_t reached = trigger.metrics;
+    for (uint8_t i = 0; i < derived_states_.size(); i++) {
+      if ((reached & (1UL << i)) == 0) continue;
+      reached |= derived_states_[i].dependents | derived_states_[i].integrals;
+      if (derived_defs_[i].integrate != DERIVED_NO_METRIC) trigger.integrals |= 1UL << i;
+    }
+  }
+
+  // Integrals continue from the total saved before the reboot
+  bool restoring = false;
+  for (uint8_t i = 0; i < derived_states_.size(); i++) {
+    const DerivedDef &def = derived_defs_[i];
+    DerivedState &state = derived_states_[i];
+    if (def.integrate == DERIVED_NO_METRIC || def.restore_key == 0) continue;
+    restoring = true;
+    state.pref = global_preferences->make_preference<double>(def.restore_key, true);
+    if (!state.pref.load(&state.total) || !std::isfinite(state.total)) state.total = 0;
+    state.saved_total = state.total;
+    state.value = static_cast<float>(state.total);
+    if (state.sensor != nullptr) state.sensor->publish_state(state.value);
+  }
+  if (restoring) this->set_interval("derived", Derived_SaveIntervalMs, [this]() { this->save_derived_(); });
+}
+
+void DaikinX10A::save_derived_() {
+  for (uint8_t i = 0; i < derived_states_.size(); i++) {
+    DerivedState &state = derived_states_[i];
+    if (derived_defs_[i].restore_key == 0 || state.total == state.saved_total) continue;
+    if (state.pref.save(&state.total)) state.saved_total = state.total;
+  }
+}
+
+// A frame of the registry arrived: its integrals are sampled with the next loop(), also for a frame identical to the last one, so they
+// get a sample with every poll rather than with every change. Its formulas only when the frame changed, and then only those with an
+// input register that changed. Called by the poller, which may be the UART task; derived_triggers_ does not change after setup()
+void DaikinX10A::mark_derived_(uint8_t registry_id, bool changed) {
+  for (const auto &trigger : derived_triggers_) {
+    if (trigger.registry_id != registry_id) continue;
+    derived_samples_.fetch_or(trigger.integrals, std::memory_order_release);
+    if (changed) derived_changed_.fetch_or(trigger.metrics, std::memory_order_release);
+  }
+}
+
+// Evaluates the dirty metrics in dependency order. A metric that changed makes the formulas using it dirty; every evaluation is a sample
+// for the integrals of the metric, also when the value did not change
+void DaikinX10A::evaluate_derived_() {
+  const uint32_t changed = derived_changed_.exchange(0, std::memory_order_acquire);
+  derived_dirty_ |= derived_samples_.exchange(0, std::memory_order_acquire);
+  if (changed != 0) {
+    for (auto &input : derived_inputs_) {
+      if ((input.metrics & changed) == 0) continue;
+      const float value = this->get_register_float(input.handle);
+      if (value == input.last || (std::isnan(value) && std::isnan(input.last))) continue;
+      input.last = value;
+      derived_dirty_ |= input.metrics;
+    }
+  }
+  const uint32_t now = millis();
+  for (uint8_t i = 0; i < derived_states_.size(); i++) {
+    const uint32_t bit = 1UL << i;
+    if ((derived_dirty_ & bit) == 0) continue;
+    derived_dirty_ &= ~bit;
+
+    DerivedState &state = derived_states_[i];
+    const DerivedDef &def = derived_defs_[i];
+    float value;
+    if (def.integrate == DERIVED_NO_METRIC) {
+      value = this->run_formula_(def);
+    } else {
+      // Trapezoid between the previous and this sample of the source; nothing across a gap (no answer from the HP, NAN inputs)
+      const float sample = derived_states_[def.integrate].value;
+      const uint32_t dt = now - state.last_ms;
+      if (!std::isnan(sample) && !std::isnan(state.last_sample) && dt <= def.max_gap_ms)
+        state.total += (state.last_sample + sample) * 0.5 * dt / 3600000.0;
+      state.last_sample = sample;
+      state.last_ms = now;
+      value = static_cast<float>(state.total);
+    }
+
+    derived_dirty_ |= state.integrals;
+    if (value == state.value || (std::isnan(value) && std::isnan(state.value))) continue;
+    state.value = value;
+    derived_dirty_ |= state.dependents;
+    if (state.sensor != nullptr) state.sensor->publish_state(value);
+  }
+}
+
+// Postfix program on a fixed stack; __init__.py checked the depth. NAN in (no value yet, not available) is NAN out, so is x / 0
+float DaikinX10A::run_formula_(const DerivedDef &def) {
+  float stack[DERIVED_STACK_SIZE];
+  uint8_t sp = 0;
+  for (uint16_t i = def.first_op; i < def.first_op + def.op_count; i++) {
+    const DerivedOp &op = derived_ops_[i];
+    switch (op.code) {
+      case DerivedOp::CONST: stack[sp++] = op.value; break;
+      case DerivedOp::REGISTER: stack[sp++] = this->get_register_float(op.arg); break;
+      case DerivedOp::METRIC: stack[sp++] = derived_states_[op.arg].value; break;
+      case DerivedOp::NEG: stack[sp - 1] = -stack[sp - 1]; break;
+      case DerivedOp::ABS: stack[sp - 1] = std::fabs(stack[sp - 1]); break;
+      default: {
+        const float b = stack[--sp];
+        float &a = stack[sp - 1];
+        switch (op.code) {
+          case DerivedOp::ADD: a += b; break;
+          case DerivedOp::SUB: a -= b; break;
+          case DerivedOp::MUL: a *= b; break;
+          case DerivedOp::DIV: a = (b == 0.0f) ? NAN : a / b; break;
+          case DerivedOp::MIN: a = (std::isnan(a) || std::isnan(b)) ? NAN : std::min(a, b); break;
+          case DerivedOp::MAX: a = (std::isnan(a) || std::isnan(b)) ? NAN : std::max(a, b); break;
+          default: break;
+        }
+      }
+    }
+  }
+  return sp == 1 ? stack[0] : NAN;
+}
+//________________________________________________________________ derived metrics end
+
+}  // namespace daikin_x10a
+}  // namespace esphome
+
+#endif  // USE_DAIKIN_X10A_DERIVED
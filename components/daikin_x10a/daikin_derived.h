@@ -0,0 +1,27 @@
+// daikin_derived.h
+#pragma once
+
+#include <cstdint>
+
+// Derived metrics: __init__.py compiles every formula of the derived block into a postfix program over register handles, constants
+// and earlier metrics, and generates the programs as constexpr arrays next to the register table. daikin_derived.cpp evaluates them on
+// a fixed stack of DERIVED_STACK_SIZE floats, only for metrics whose input registries delivered a new frame
+inline constexpr uint8_t DERIVED_STACK_SIZE = 8;
+inline constexpr uint8_t DERIVED_MAX_METRICS = 32;  // dirty and dependency sets are 32-bit masks
+inline constexpr uint8_t DERIVED_NO_METRIC = 0xFF;
+
+struct DerivedOp {
+  enum Code : uint8_t { CONST, REGISTER, METRIC, ADD, SUB, MUL, DIV, NEG, MIN, MAX, ABS };
+  Code code;
+  uint16_t arg;  // register handle (REGISTER) or metric index (METRIC)
+  float value;   // CONST
+};
+
+// One metric, in dependency order: a formula (op_count ops from first_op) or the time integral of an earlier metric in unit-hours
+struct DerivedDef {
+  uint16_t first_op;
+  uint8_t op_count;
+  uint8_t integrate;    // metric that is integrated, DERIVED_NO_METRIC for a formula
+  uint32_t max_gap_ms;  // integral: a longer gap between two samples is left out instead of interpolated
+  uint32_t restore_key; // integral: preference its total is kept in across reboots; 0 starts it at 0 with every boot
+};
@@ -0,0 +1,130 @@
+#include "daikin_x10a.h"
+#include "esphome/core/log.h"
+
+#ifdef USE_DAIKIN_X10A_DIAGNOSTICS
+
+#include <algorithm>
+#include <cstdio>
+
+namespace esphome {
+namespace daikin_x10a {
+
+// Upper bound of every round trip bucket; the last bucket takes everything above 600 ms
+static constexpr uint32_t RoundTrip_BucketBoundsUs[] = {
+  10000, 20000, 30000, 40000, 50000, 60000, 80000, 100000,
+  125000, 150000, 200000, 250000, 300000, 400000, 600000, UINT32_MAX,
+};
+static constexpr uint16_t RoundTrip_DecayCount = 1024;
+
+//__________________________________________________________________________________________________________________________ record_round_trip_ begin
+void DaikinX10A::record_round_trip_(RoundTripStats &stats, uint32_t rtt_us) {
+  static_assert(sizeof(RoundTrip_BucketBoundsUs) / sizeof(RoundTrip_BucketBoundsUs[0]) == ROUND_TRIP_BUCKETS, "one bound per bucket");
+
+  size_t bucket = 0;
+  while (rtt_us > RoundTrip_BucketBoundsUs[bucket]) bucket++;
+  stats.buckets[bucket]++;
+  stats.min_us = std::min<uint32_t>(stats.min_us, rtt_us);
+  stats.max_us = std::max<uint32_t>(stats.max_us, rtt_us);
+
+  if (++stats.count < RoundTrip_DecayCount) return;
+  stats.count = 0;
+  for (auto &n : stats.buckets) {
+    n /= 2;
+    stats.count += n;
+  }
+}
+
+// Upper bound of the bucket holding the per_mille-th round trip, capped at the largest one seen
+uint32_t DaikinX10A::round_trip_percentile_(const std::array<uint32_t, ROUND_TRIP_BUCKETS> &buckets, uint32_t count,
+                                            uint32_t per_mille, uint32_t max_us) {
+  const uint32_t rank = std::max<uint32_t>(1, (count * per_mille + 999) / 1000);
+  uint32_t seen = 0;
+  for (size_t i = 0; i < ROUND_TRIP_BUCKETS; i++) {
+    seen += buckets[i];
+    if (seen >= rank) return std::min(RoundTrip_BucketBoundsUs[i], max_us);
+  }
+  return max_us;
+}
+//________________________________________________________________ record_round_trip_ end
+
+//__________________________________________________________________________________________________________________________ publish_diagnostics_ begin
+// Logs the round trips of every registry and publishes the configured diagnostic sensors. Round trips are merged over all registries
+void DaikinX10A::publish_diagnostics_() {
+  std::array<uint32_t, ROUND_TRIP_BUCKETS> merged{};
+  uint32_t count = 0;
+  uint32_t min_us = UINT32_MAX;
+  uint32_t max_us = 0;
+
+  for (const auto &entry : poll_schedule_) {
+    const RoundTripStats &stats = entry.round_trips;
+    std::array<uint32_t, ROUND_TRIP_BUCKETS> buckets{};
+    uint32_t entry_count = 0;
+    for (size_t i = 0; i < ROUND_TRIP_BUCKETS; i++) {
+      buckets[i] = stats.buckets[i];
+      merged[i] += stats.buckets[i];
+      entry_count += stats.buckets[i];
+    }
+    if (entry_count == 0) continue;
+    count += entry_count;
+    min_us = std::min<uint32_t>(min_us, stats.min_us);
+    max_us = std::max<uint32_t>(max_us, stats.max_us);
+
+    ESP_LOGD("ESPoeDaikin", "Registry 0x%02X round trip min %.1f, p50 %.1f, p99 %.1f, max %.1f ms", entry.registry_id,
+             stats.min_us / 1000.0f, round_trip_percentile_(buckets, entry_count, 500, stats.max_us) / 1000.0f,
+             round_trip_percentile_(buckets, entry_count, 990, stats.max_us) / 1000.0f, stats.max_us / 1000.0f);
+  }
+
+  if (count > 0) {
+    if (round_trip_min_sensor_ != nullptr) round_trip_min_sensor_->publish_state(min_us / 1000.0f);
+    if (round_trip_p50_sensor_ != nullptr)
+      round_trip_p50_sensor_->publish_state(round_trip_percentile_(merged, count, 500, max_us) / 1000.0f);
+    if (round_trip_p99_sensor_ != nullptr)
+      round_trip_p99_sensor_->publish_state(round_trip_percentile_(merged, count, 990, max_us) / 1000.0f);
+    if (round_trip_max_sensor_ != nullptr) round_trip_max_sensor_->publish_state(max_us / 1000.0f);
+  }
+
+  if (timeouts_sensor_ != nullptr) timeouts_sensor_->publish_state(timeouts_);
+  if (crc_mismatches_sensor_ != nullptr) crc_mismatches_sensor_->publish_state(rx_decoder_.crc_mismatches());
+  if (error_frames_sensor_ != nullptr) error_frames_sensor_->publish_state(error_frames_);
+  if (wrong_registry_frames_sensor_ != nullptr) wrong_registry_frames_sensor_->publish_state(wrong_registry_frames_);
+  if (sweep_duration_sensor_ != nullptr && last_sweep_ms_ != 0) sweep_duration_sensor_->publish_state(last_sweep_ms_ / 1000.0f);
+
+  if (loop_time_max_sensor_ != nullptr) loop_time_max_sensor_->publish_state(loop_time_max_us_ / 1000.0f);
+  loop_time_max_us_ = 0;
+
+  const uint32_t now = millis();
+  const uint32_t bytes = bytes_received_;
+  if (bytes_per_second_sensor_ != nullptr && now != diagnostics_ms_)
+    bytes_per_second_sensor_->publish_state((bytes - diagnostics_bytes_) * 1000.0f / (now - diagnostics_ms_));
+  diagnostics_bytes_ = bytes;
+  diagnostics_ms_ = now;
+}
+//________________________________________________________________ publish_diagnostics_ end
+
+//__________________________________________________________________________________________________________________________ publish_probe_results_ begin
+// "27 of 30 answer; no answer: 0x30 0x31 0xA1; past frame end: 0x60", cut to the 255 characters a state may have
+void DaikinX10A::publish_probe_results_() {
+  char text[256];
+  size_t len = std::snprintf(text, sizeof(text), "%u of %u answer", (unsigned)probe_answering_, (unsigned)poll_schedule_.size());
+  bool full = false;
+  for (const bool dead : {true, false}) {
+    const char *title = dead ? "; no answer:" : "; past frame end:";
+    bool first = true;
+    for (const auto &entry : poll_schedule_) {
+      if (dead ? !entry.dead : (entry.dead || !entry.short_frame)) continue;
+      full = len + 24 > sizeof(text);  // room for the longest title, an id and " ..."
+      if (full) break;
+      len += std::snprintf(text + len, sizeof(text) - len, "%s 0x%02X", first ? title : "", entry.registry_id);
+      first = false;
+    }
+    if (full) break;
+  }
+  if (full) std::snprintf(text + len, sizeof(text) - len, " ...");
+  registry_probe_sensor_->publish_state(text);
+}
+//________________________________________________________________ publish_probe_results_ end
+
+}  // namespace daikin_x10a
+}  // namespace esphome
+
+#endif  // USE_DAIKIN_X10A_DIAGNOSTICS
@@ -0,0 +1,230 @@
+#include "daikin_x10a.h"
+#include "esphome/core/log.h"
+
+#ifdef USE_DAIKIN_X10A_HISTORY
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef USE_ESP32
+#include <esp_heap_caps.h>
+#endif
+
+namespace esphome {
+namespace daikin_x10a {
+
+static constexpr uint32_t History_IdleTimeoutMs = 10000;  // a client that neither sends its request nor takes data is dropped
+static constexpr uint8_t History_ChunksPerLoop = 8;       // bounds the time a single loop() spends on an export
+
+//__________________________________________________________________________________________________________________________ history begin
+void DaikinX10A::set_history_storage(uint32_t raw_bytes, uint16_t minute_slots, uint16_t quarter_slots, float resolution,
+                                     uint32_t hold_ms, bool psram) {
+  history_raw_bytes_ = raw_bytes;
+  history_slots_[0] = minute_slots;
+  history_slots_[1] = quarter_slots;
+  history_resolution_ = resolution;
+  history_hold_ms_ = hold_ms;
+  history_psram_ = psram;
+}
+
+void DaikinX10A::add_history_register(RegisterHandle handle) {
+  if (handle < register_count_ && history_handles_.size() < HISTORY_MAX_SERIES) history_handles_.push_back(handle);
+}
+
+// Runs at the end of setup(): one allocation for all series, nothing is allocated while samples come in. Frames restored by the warm
+// start are not history, so whatever they marked is dropped
+void DaikinX10A::history_setup_() {
+  const size_t per_series = daikin_history_series::memory_needed(history_raw_bytes_, history_slots_);
+  history_memory_size_ = per_series * history_handles_.size();
+  if (history_memory_size_ == 0) return;
+
+#ifdef USE_ESP32
+  if (history_psram_) history_memory_ = static_cast<uint8_t *>(heap_caps_malloc(history_memory_size_, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+  if (history_psram_ && history_memory_ == nullptr) ESP_LOGW("ESPoeDaikin", "History: no PSRAM available, using RAM");
+#endif
+  if (history_memory_ == nullptr) history_memory_ = static_cast<uint8_t *>(std::malloc(history_memory_size_));
+  if (history_memory_ == nullptr) {
+    ESP_LOGE("ESPoeDaikin", "History: could not allocate %u bytes, history disabled", (unsigned)history_memory_size_);
+    history_handles_.clear();
+    history_memory_size_ = 0;
+    return;
+  }
+
+  history_.resize(history_handles_.size());
+  history_labels_.clear();
+  for (size_t i = 0; i < history_.size(); i++) {
+    history_[i].init(history_memory_ + i * per_series, history_raw_bytes_, history_slots_, history_resolution_, history_hold_ms_);
+    history_labels_.push_back(register_table_[history_handles_[i]].label);
+    this->queue_register_(history_handles_[i]);
+  }
+  history_dirty_ = 0;
+  ESP_LOGI("ESPoeDaikin", "History: %u registers, %u bytes (%u raw, %u x 1 min, %u x 15 min each)", (unsigned)history_.size(),
+           (unsigned)history_memory_size_, (unsigned)history_raw_bytes_, (unsigned)history_slots_[0], (unsigned)history_slots_[1]);
+
+  if (history_http_port_ != 0) this->history_listen_();
+}
+
+// A frame of the registry was decoded: its series take a sample with the next loop()
+void DaikinX10A::history_mark_(uint8_t registry_id) {
+  for (size_t i = 0; i < history_.size(); i++) {
+    if (register_table_[history_handles_[i]].registryID == registry_id) history_dirty_ |= 1UL << i;
+  }
+}
+
+// loop() only; get_register_float() decodes a Mode 0 register from its frame when needed
+void DaikinX10A::history_sample_() {
+  const uint32_t now = millis();
+  for (size_t i = 0; i < history_.size(); i++) {
+    if ((history_dirty_ & (1UL << i)) == 0) continue;
+    history_[i].add(now, this->get_register_float(history_handles_[i]));
+  }
+  history_dirty_ = 0;
+}
+//________________________________________________________________ history end
+
+//__________________________________________________________________________________________________________________________ history export begin
+// GET /history.csv or /history.bin on the history port; one client at a time, the next one waits in the listen backlog
+void DaikinX10A::history_listen_() {
+  struct sockaddr_storage addr;
+  const socklen_t addr_len = socket::set_sockaddr_any(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr), history_http_port_);
+  history_server_ = socket::socket_ip(SOCK_STREAM, 0);
+  const int enable = 1;
+  if (history_server_ == nullptr || addr_len == 0 ||
+      history_server_->setsockopt(SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0 ||
+      history_server_->bind(reinterpret_cast<struct sockaddr *>(&addr), addr_len) != 0 || history_server_->listen(1) != 0) {
+    ESP_LOGW("ESPoeDaikin", "History: could not listen on port %u (errno %d)", history_http_port_, errno);
+    history_server_.reset();
+    return;
+  }
+  history_server_->setblocking(false);
+  ESP_LOGI("ESPoeDaikin", "History export on http://<device>:%u/history.csv and /history.bin", history_http_port_);
+}
+
+// Pushes the history to a TCP listener instead, e.g. from an API service: nc -l 5556 > history.csv
+bool DaikinX10A::export_history(const std::string &host, uint16_t port, bool binary) {
+  if (history_client_ != nullptr || history_.empty()) return false;
+
+  struct sockaddr_storage addr;
+  const socklen_t addr_len = socket::set_sockaddr(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr), host, port);
+  history_client_ = socket::socket_ip(SOCK_STREAM, 0);
+  if (addr_len == 0 || history_client_ == nullptr) {
+    ESP_LOGW("ESPoeDaikin", "History: could not create a socket for %s:%u", host.c_str(), port);
+    history_client_.reset();
+    return false;
+  }
+  history_client_->setblocking(false);
+  if (history_client_->connect(reinterpret_cast<struct sockaddr *>(&addr), addr_len) != 0 && errno != EINPROGRESS) {
+    ESP_LOGW("ESPoeDaikin", "History: could not connect to %s:%u (errno %d)", host.c_str(), port, errno);
+    history_client_.reset();
+    return false;
+  }
+  this->history_begin_(binary);
+  return true;
+}
+
+void DaikinX10A::history_begin_(bool binary) {
+  const uint32_t now = millis();
+  for (auto &series : history_) series.tick(now);
+  history_export_.begin(history_.data(), history_labels_.data(), (uint8_t)history_.size(),
+                        binary ? daikin_history_export::Format::BINARY : daikin_history_export::Format::CSV, now);
+  history_sending_ = true;
+  history_active_ms_ = history_start_ms_ = now;
+  history_exported_ = 0;
+}
+
+void DaikinX10A::history_close_() {
+  if (history_sending_)
+    ESP_LOGD("ESPoeDaikin", "History: exported %u bytes in %u ms%s", (unsigned)history_exported_, (unsigned)(millis() - history_start_ms_),
+             history_export_.done() ? "" : ", client gone");
+  history_client_.reset();
+  history_sending_ = false;
+  history_request_len_ = 0;
+  history_buffer_len_ = history_buffer_sent_ = 0;
+}
+
+// Called from every loop() while there is a listener or a client; never blocks
+void DaikinX10A::history_serve_() {
+  const uint32_t now = millis();
+  if (history_client_ == nullptr) {
+    if (history_server_ == nullptr) return;
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    history_client_ = history_server_->accept(reinterpret_cast<struct sockaddr *>(&addr), &addr_len);
+    if (history_client_ == nullptr) return;
+    history_client_->setblocking(false);
+    history_active_ms_ = now;
+  }
+
+  if (!history_sending_ && !this->history_read_request_()) {
+    if (history_client_ != nullptr && now - history_active_ms_ > History_IdleTimeoutMs) this->history_close_();
+    return;
+  }
+
+  for (uint8_t chunk = 0; chunk < History_ChunksPerLoop; chunk++) {
+    if (history_buffer_sent_ == history_buffer_len_) {
+      history_buffer_sent_ = 0;
+      history_buffer_len_ = history_export_.fill(history_buffer_, sizeof(history_buffer_));
+      if (history_buffer_len_ == 0) {
+        this->history_close_();
+        return;
+      }
+    }
+    const ssize_t written = history_client_->write(history_buffer_ + history_buffer_sent_, history_buffer_len_ - history_buffer_sent_);
+    if (written > 0) {
+      history_buffer_sent_ += (size_t)written;
+      history_exported_ += (size_t)written;
+      history_active_ms_ = now;
+      continue;
+    }
+    // Still connecting or the send buffer is full: go on with a later loop(). Anything else means the client is gone
+    if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINPROGRESS && errno != ENOTCONN) {
+      this->history_close_();
+    } else if (now - history_active_ms_ > History_IdleTimeoutMs) {
+      this->history_close_();
+    }
+    return;
+  }
+}
+
+// "GET <path> HTTP/1.1" or "GET <path>?...": the path must be followed by a space or a query
+static bool history_request_is_(const char *request, const char *path) {
+  const size_t len = std::strlen(path);
+  return std::strncmp(request, "GET ", 4) == 0 && std::strncmp(request + 4, path, len) == 0 &&
+         (request[4 + len] == ' ' || request[4 + len] == '?');
+}
+
+// Collects the request line; true once the response (an export, or an error page) is ready to be sent. A client that hangs up or
+// fails before its request is complete is closed right away
+bool DaikinX10A::history_read_request_() {
+  const ssize_t got = history_client_->read(history_request_ + history_request_len_, sizeof(history_request_) - 1 - history_request_len_);
+  if (got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    this->history_close_();
+    return false;
+  }
+  if (got > 0) history_request_len_ += (size_t)got;
+  history_request_[history_request_len_] = '\0';
+  if (std::strchr(history_request_, '\n') == nullptr && history_request_len_ < sizeof(history_request_) - 1) return false;
+
+  const bool csv = history_request_is_(history_request_, "/history.csv");
+  const bool binary = history_request_is_(history_request_, "/history.bin");
+  this->history_begin_(binary);
+  history_buffer_sent_ = 0;
+  if (csv || binary) {
+    history_buffer_len_ = std::snprintf(reinterpret_cast<char *>(history_buffer_), sizeof(history_buffer_),
+                                        "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nConnection: close\r\n\r\n",
+                                        binary ? "application/octet-stream" : "text/csv");
+    return true;
+  }
+  history_buffer_len_ = std::snprintf(reinterpret_cast<char *>(history_buffer_), sizeof(history_buffer_),
+                                      "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\n"
+                                      "Not found, the history is at /history.csv and /history.bin\n");
+  history_export_ = daikin_history_export{};  // nothing after the page
+  return true;
+}
+//________________________________________________________________ history export end
+
+}  // namespace daikin_x10a
+}  // namespace esphome
+
+#endif  // USE_DAIKIN_X10A_HISTORY
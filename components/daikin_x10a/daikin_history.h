@@ -0,0 +1,467 @@
+// daikin_history.h
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// History of one register, kept in memory handed to init() once (daikin_history.cpp allocates one block for all series):
+//
+//   raw      every sample in a byte ring, delta encoded: varint (0.1 s steps since the previous sample << 1 | 1 when the sample has no
+//            value), then the zigzag varint of the change in resolution steps. 2-3 bytes a sample; the oldest make room for new ones
+//   minute   1-minute min/avg/max as int16 resolution steps, a ring of slots
+//   quarter  15-minute min/avg/max, the same
+//
+// Samples only arrive when a frame of the registry is decoded, and identical frames are not. A period without samples therefore repeats
+// the last value while that is at most hold_ms old; after that (the HP did not answer) the period stays empty
+class daikin_history_series {
+ public:
+  struct Slot {
+    int16_t min;
+    int16_t avg;  // EMPTY: no value in this period
+    int16_t max;
+  };
+  static constexpr int16_t EMPTY = INT16_MIN;
+  static constexpr uint8_t TIERS = 2;
+  static constexpr uint32_t TIER_PERIOD_MS[TIERS] = {60000, 900000};
+  static constexpr uint32_t TIME_STEP_MS = 100;  // resolution of the raw timestamps
+
+  // Bytes init() needs, a multiple of 4 so the blocks of several series can follow each other
+  static size_t memory_needed(uint32_t raw_bytes, const uint16_t slots[TIERS]) {
+    size_t bytes = raw_bytes;
+    for (uint8_t i = 0; i < TIERS; i++) bytes += (size_t)slots[i] * sizeof(Slot);
+    return (bytes + 3) & ~(size_t)3;
+  }
+
+  void init(uint8_t *memory, uint32_t raw_bytes, const uint16_t slots[TIERS], float resolution, uint32_t hold_ms) {
+    for (uint8_t i = 0; i < TIERS; i++) {
+      tiers_[i] = Tier{};
+      tiers_[i].slots = reinterpret_cast<Slot *>(memory);
+      tiers_[i].capacity = slots[i];
+      memory += (size_t)slots[i] * sizeof(Slot);
+    }
+    raw_ = memory;
+    raw_capacity_ = raw_bytes;
+    resolution_ = resolution;
+    hold_ms_ = hold_ms;
+    head_ = tail_ = samples_ = 0;
+    started_ = false;
+    has_value_ = false;
+  }
+
+  // value NAN: the register had no value (not available, not a number)
+  void add(uint32_t now_ms, float value) {
+    const bool has_value = !std::isnan(value);
+    const int32_t q = has_value ? quantize_(value) : last_q_;
+    if (!started_) {
+      started_ = true;
+      anchor_ms_ = last_ms_ = now_ms;
+      anchor_q_ = last_q_ = q;
+      for (uint8_t i = 0; i < TIERS; i++) tiers_[i].start_ms = now_ms - now_ms % TIER_PERIOD_MS[i];
+    }
+    this->tick(now_ms);
+
+    const uint32_t steps = (now_ms - last_ms_) / TIME_STEP_MS;
+    uint8_t entry[10];
+    uint8_t len = put_varint_(entry, (steps << 1) | (has_value ? 0 : 1));
+    if (has_value) len += put_varint_(entry + len, zigzag_(q - last_q_));
+    if (len <= raw_capacity_) {
+      while (raw_capacity_ - (head_ - tail_) < len) this->evict_();
+      for (uint8_t i = 0; i < len; i++) raw_[(head_ + i) % raw_capacity_] = entry[i];
+      head_ += len;
+      samples_++;
+    }
+    last_ms_ += steps * TIME_STEP_MS;  // the time as stored, so it never drifts from what an export reads back
+    last_q_ = q;
+    has_value_ = has_value;
+
+    if (!has_value) return;
+    const int16_t v = saturate_(q);
+    for (auto &tier : tiers_) {
+      if (tier.count == 0 || v < tier.min) tier.min = v;
+      if (tier.count == 0 || v > tier.max) tier.max = v;
+      tier.sum += v;
+      tier.count++;
+    }
+  }
+
+  // Closes the periods that have ended; add() does this itself, an export calls it first so the slots are up to date
+  void tick(uint32_t now_ms) {
+    if (!started_) return;
+    for (uint8_t i = 0; i < TIERS; i++) this->advance_(tiers_[i], TIER_PERIOD_MS[i], now_ms);
+  }
+
+  // Export side: cursors walk the samples and slots that were there when they were made. Samples that arrive later are not visited;
+  // when new samples evict the position a cursor was at, it continues with the oldest sample that is left
+  struct RawCursor {
+    uint32_t offset;   // next entry, as a running byte count
+    uint32_t end;
+    uint32_t time_ms;  // time and value steps of the entry before offset
+    int32_t q;
+    uint32_t emitted_ms;
+    bool resumed;      // evicted under the cursor: skip what was emitted before
+  };
+  RawCursor raw_begin() const { return RawCursor{tail_, head_, anchor_ms_, anchor_q_, anchor_ms_, false}; }
+
+  bool raw_next(RawCursor &c, uint32_t &time_ms, float &value) const {
+    for (;;) {
+      if ((int32_t)(c.offset - tail_) < 0) {
+        c.offset = tail_;
+        c.time_ms = anchor_ms_;
+        c.q = anchor_q_;
+        c.resumed = true;
+      }
+      if ((int32_t)(c.end - c.offset) <= 0) return false;
+      uint32_t steps;
+      int32_t dq;
+      bool has_value;
+      c.offset += this->read_entry_(c.offset, steps, has_value, dq);
+      c.time_ms += steps * TIME_STEP_MS;
+      c.q += dq;
+      if (c.resumed && (int32_t)(c.time_ms - c.emitted_ms) <= 0) continue;
+      c.resumed = false;
+      c.emitted_ms = c.time_ms;
+      time_ms = c.time_ms;
+      value = has_value ? c.q * resolution_ : NAN;
+      return true;
+    }
+  }
+
+  struct SlotCursor {
+    uint32_t index;  // period number since the first sample
+    uint32_t end;
+  };
+  SlotCursor slots_begin(uint8_t tier) const { return SlotCursor{tiers_[tier].closed - tiers_[tier].used, tiers_[tier].closed}; }
+
+  // Next period with a value; start_ms is its start
+  bool slot_next(uint8_t tier, SlotCursor &c, uint32_t &start_ms, float &min, float &avg, float &max) const {
+    const Tier &t = tiers_[tier];
+    const uint32_t oldest = t.closed - t.used;
+    if ((int32_t)(c.index - oldest) < 0) c.index = oldest;
+    while (c.index != c.end) {
+      const uint32_t back = t.closed - c.index;  // 1 = the newest slot
+      const Slot &slot = t.slots[(t.head + t.capacity - back) % t.capacity];
+      start_ms = t.start_ms - back * TIER_PERIOD_MS[tier];
+      c.index++;
+      if (slot.avg == EMPTY) continue;
+      min = slot.min * resolution_;
+      avg = slot.avg * resolution_;
+      max = slot.max * resolution_;
+      return true;
+    }
+    return false;
+  }
+
+  uint32_t raw_samples() const { return samples_; }
+  uint32_t raw_bytes_used() const { return head_ - tail_; }
+  uint32_t raw_span_ms() const { return samples_ == 0 ? 0 : last_ms_ - anchor_ms_; }
+  uint16_t slots_used(uint8_t tier) const { return tiers_[tier].used; }
+  // Digits after the decimal point that the resolution can show
+  uint8_t decimals() const {
+    uint8_t digits = 0;
+    for (float step = resolution_; step < 0.999f && digits < 6; step *= 10) digits++;
+    return digits;
+  }
+
+ protected:
+  struct Tier {
+    Slot *slots{nullptr};
+    uint16_t capacity{0};
+    uint16_t head{0};      // next slot written
+    uint16_t used{0};
+    uint32_t closed{0};    // periods closed since the first sample
+    uint32_t start_ms{0};  // start of the open period
+    int64_t sum{0};        // samples of the open period
+    uint32_t count{0};
+    int16_t min{0};
+    int16_t max{0};
+  };
+
+  void advance_(Tier &t, uint32_t period_ms, uint32_t now_ms) {
+    const uint32_t periods = (now_ms - t.start_ms) / period_ms;
+    if (periods == 0) return;
+    // After a gap longer than the ring only the newest periods are written
+    const uint32_t first = (t.capacity == 0 || periods <= t.capacity) ? 0 : periods - t.capacity;
+    for (uint32_t k = first; k < periods && t.capacity > 0; k++) {
+      Slot slot{EMPTY, EMPTY, EMPTY};
+      if (k == 0 && t.count > 0) {
+        slot = Slot{t.min, static_cast<int16_t>(std::lround((double)t.sum / t.count)), t.max};
+      } else if (has_value_ && t.start_ms + (k + 1) * period_ms - last_ms_ <= hold_ms_) {
+        const int16_t v = saturate_(last_q_);
+        slot = Slot{v, v, v};
+      }
+      t.slots[t.head] = slot;
+      t.head = (t.head + 1) % t.capacity;
+      if (t.used < t.capacity) t.used++;
+    }
+    t.closed += periods;
+    t.start_ms += periods * period_ms;
+    t.sum = 0;
+    t.count = 0;
+  }
+
+  void evict_() {
+    uint32_t steps;
+    int32_t dq;
+    bool has_value;
+    tail_ += this->read_entry_(tail_, steps, has_value, dq);
+    anchor_ms_ += steps * TIME_STEP_MS;
+    anchor_q_ += dq;
+    samples_--;
+  }
+
+  uint8_t read_entry_(uint32_t offset, uint32_t &steps, bool &has_value, int32_t &dq) const {
+    uint8_t len = 0;
+    const uint32_t header = this->get_varint_(offset, len);
+    steps = header >> 1;
+    has_value = (header & 1) == 0;
+    const uint32_t zz = has_value ? this->get_varint_(offset + len, len) : 0;
+    dq = (int32_t)(zz >> 1) ^ -(int32_t)(zz & 1);
+    return len;
+  }
+
+  uint32_t get_varint_(uint32_t offset, uint8_t &len) const {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < 5; i++) {
+      const uint8_t byte = raw_[(offset + i) % raw_capacity_];
+      value |= (uint32_t)(byte & 0x7F) << (7 * i);
+      if ((byte & 0x80) == 0) {
+        len += i + 1;
+        return value;
+      }
+    }
+    len += 5;
+    return value;
+  }
+
+  static uint8_t put_varint_(uint8_t *out, uint32_t value) {
+    uint8_t len = 0;
+    while (value >= 0x80) {
+      out[len++] = (uint8_t)(value | 0x80);
+      value >>= 7;
+    }
+    out[len++] = (uint8_t)value;
+    return len;
+  }
+  static uint32_t zigzag_(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+
+  static constexpr int32_t Q_LIMIT = 1 << 29;  // keeps every difference of two steps inside int32
+  int32_t quantize_(float value) const {
+    const double steps = std::nearbyint((double)value / resolution_);
+    return steps > Q_LIMIT ? Q_LIMIT : (steps < -Q_LIMIT ? -Q_LIMIT : (int32_t)steps);
+  }
+  static int16_t saturate_(int32_t q) { return q > INT16_MAX ? INT16_MAX : (q < -INT16_MAX ? -INT16_MAX : (int16_t)q); }
+
+  Tier tiers_[TIERS];
+  uint8_t *raw_{nullptr};
+  uint32_t raw_capacity_{0};
+  uint32_t head_{0};       // running byte counts; the ring position is the count modulo raw_capacity_
+  uint32_t tail_{0};
+  uint32_t samples_{0};
+  uint32_t anchor_ms_{0};  // time and value steps before the oldest entry
+  int32_t anchor_q_{0};
+  uint32_t last_ms_{0};    // time and value steps of the newest entry
+  int32_t last_q_{0};
+  float resolution_{0.1f};
+  uint32_t hold_ms_{0};
+  bool started_{false};
+  bool has_value_{false};  // the newest sample had a value
+};
+
+// Bulk export of all series, cut into chunks so it can be streamed to a socket from loop(). Ages count back from begin(); samples added
+// during the export are left for the next one.
+//
+// CSV, one row per sample or period:   register,tier,age_s,value,min,max      (tier raw, 1min or 15min; value is the average)
+// Binary, little endian:   'X' 'H' | version u8 | series count u8, then records
+//   LABEL   type 0 u8 | series u8 | decimals u8 (of the resolution) | length u8 | label
+//   RAW     type 1 u8 | series u8 | age_ms u32 | value f32 (NAN: no value)
+//   SLOT    type 2 (1 min) or 3 (15 min) u8 | series u8 | age_ms u32 of the period start | min f32 | avg f32 | max f32
+// tools/x10a_history.py turns the binary form into the same CSV
+class daikin_history_export {
+ public:
+  enum class Format : uint8_t { CSV, BINARY };
+  static constexpr uint8_t VERSION = 1;
+  static constexpr size_t MAX_ROW = 160;  // fill() needs at least this much room
+
+  void begin(const daikin_history_series *series, const char *const *labels, uint8_t count, Format format, uint32_t now_ms) {
+    series_ = series;
+    labels_ = labels;
+    count_ = count;
+    format_ = format;
+    now_ms_ = now_ms;
+    stage_ = Stage::HEADER;
+    index_ = 0;
+    pending_ = 0;
+  }
+
+  // Whole rows or records only; 0 once everything has been written
+  size_t fill(uint8_t *out, size_t capacity) {
+    size_t size = 0;
+    for (;;) {
+      if (pending_ == 0 && !this->next_row_()) return size;
+      if (size + pending_ > capacity) return size;
+      std::memcpy(out + size, row_, pending_);
+      size += pending_;
+      pending_ = 0;
+    }
+  }
+
+  bool done() const { return stage_ == Stage::DONE && pending_ == 0; }
+
+ protected:
+  enum class Stage : uint8_t { HEADER, LABELS, SERIES_BEGIN, RAW, SLOTS, DONE };
+
+  bool next_row_() {
+    for (;;) {
+      switch (stage_) {
+        case Stage::HEADER:
+          stage_ = format_ == Format::CSV ? Stage::SERIES_BEGIN : Stage::LABELS;
+          if (format_ == Format::CSV) {
+            pending_ = std::snprintf(row_, sizeof(row_), "register,tier,age_s,value,min,max\n");
+          } else {
+            row_[0] = 'X';
+            row_[1] = 'H';
+            row_[2] = VERSION;
+            row_[3] = count_;
+            pending_ = 4;
+          }
+          return true;
+        case Stage::LABELS: {
+          if (index_ == count_) {
+            index_ = 0;
+            stage_ = Stage::SERIES_BEGIN;
+            continue;
+          }
+          const size_t len = std::min<size_t>(std::strlen(labels_[index_]), MAX_ROW - 4);
+          row_[0] = 0;
+          row_[1] = index_;
+          row_[2] = series_[index_].decimals();
+          row_[3] = (char)len;
+          std::memcpy(row_ + 4, labels_[index_], len);
+          pending_ = 4 + len;
+          index_++;
+          return true;
+        }
+        case Stage::SERIES_BEGIN:
+          if (index_ == count_) {
+            stage_ = Stage::DONE;
+            continue;
+          }
+          raw_ = series_[index_].raw_begin();
+          stage_ = Stage::RAW;
+          continue;
+        case Stage::RAW: {
+          uint32_t time_ms;
+          float value;
+          if (series_[index_].raw_next(raw_, time_ms, value)) {
+            this->put_raw_(time_ms, value);
+            return true;
+          }
+          tier_ = 0;
+          slots_ = series_[index_].slots_begin(0);
+          stage_ = Stage::SLOTS;
+          continue;
+        }
+        case Stage::SLOTS: {
+          uint32_t start_ms;
+          float min, avg, max;
+          if (series_[index_].slot_next(tier_, slots_, start_ms, min, avg, max)) {
+            this->put_slot_(start_ms, min, avg, max);
+            return true;
+          }
+          if (++tier_ < daikin_history_series::TIERS) {
+            slots_ = series_[index_].slots_begin(tier_);
+          } else {
+            index_++;
+            stage_ = Stage::SERIES_BEGIN;
+          }
+          continue;
+        }
+        case Stage::DONE:
+          return false;
+      }
+    }
+  }
+
+  void put_raw_(uint32_t time_ms, float value) {
+    const uint32_t age_ms = now_ms_ - time_ms;
+    if (format_ == Format::BINARY) {
+      row_[0] = 1;
+      row_[1] = index_;
+      put_u32_(row_ + 2, age_ms);
+      put_f32_(row_ + 6, value);
+      pending_ = 10;
+      return;
+    }
+    pending_ = this->put_label_();
+    pending_ += std::snprintf(row_ + pending_, sizeof(row_) - pending_, ",raw,%u.%u,", (unsigned)(age_ms / 1000),
+                              (unsigned)(age_ms % 1000 / 100));
+    pending_ += this->put_number_(row_ + pending_, value);
+    pending_ += std::snprintf(row_ + pending_, sizeof(row_) - pending_, ",,\n");
+  }
+
+  void put_slot_(uint32_t start_ms, float min, float avg, float max) {
+    const uint32_t age_ms = now_ms_ - start_ms;
+    if (format_ == Format::BINARY) {
+      row_[0] = 2 + tier_;
+      row_[1] = index_;
+      put_u32_(row_ + 2, age_ms);
+      put_f32_(row_ + 6, min);
+      put_f32_(row_ + 10, avg);
+      put_f32_(row_ + 14, max);
+      pending_ = 18;
+      return;
+    }
+    pending_ = this->put_label_();
+    pending_ += std::snprintf(row_ + pending_, sizeof(row_) - pending_, ",%s,%u,", tier_ == 0 ? "1min" : "15min", (unsigned)(age_ms / 1000));
+    pending_ += this->put_number_(row_ + pending_, avg);
+    row_[pending_++] = ',';
+    pending_ += this->put_number_(row_ + pending_, min);
+    row_[pending_++] = ',';
+    pending_ += this->put_number_(row_ + pending_, max);
+    row_[pending_++] = '\n';
+  }
+
+  // Quoted only when it has to be (like Python's csv module), quotes doubled; cut short so a row always fits
+  size_t put_label_() {
+    const char *label = labels_[index_];
+    const bool quote = std::strpbrk(label, ",\"\r\n") != nullptr;
+    size_t len = 0;
+    if (quote) row_[len++] = '"';
+    for (const char *c = label; *c != '\0' && len < 64; c++) {
+      if (*c == '"') row_[len++] = '"';
+      row_[len++] = *c;
+    }
+    if (quote) row_[len++] = '"';
+    return len;
+  }
+
+  size_t put_number_(char *out, float value) {
+    if (std::isnan(value)) return 0;
+    return std::snprintf(out, 24, "%.*f", series_[index_].decimals(), value);
+  }
+
+  static void put_u32_(char *out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out[i] = (char)((v >> (8 * i)) & 0xFF);
+  }
+  static void put_f32_(char *out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_u32_(out, bits);
+  }
+
+  const daikin_history_series *series_{nullptr};
+  const char *const *labels_{nullptr};
+  uint8_t count_{0};
+  Format format_{Format::CSV};
+  uint32_t now_ms_{0};
+  Stage stage_{Stage::DONE};
+  uint8_t index_{0};
+  uint8_t tier_{0};
+  daikin_history_series::RawCursor raw_{};
+  daikin_history_series::SlotCursor slots_{};
+  char row_[MAX_ROW];
+  size_t pending_{0};  // bytes of row_ not copied out yet
+};
@@ -1,66 +1,86 @@
 // daikin_package.h
 #pragma once
 
-#include <vector>
-#include <string>
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
+#include <cstdio>
 
 class daikin_package {
  public:
   enum class Mode { SEND_REQUEST, RECEIVE };
 
+  // A frame is its length byte + 2 bytes long, so never more than 255 + 2
+  static constexpr size_t MAX_FRAME_SIZE = 255 + 2;
+  // "XX " per byte plus the terminator, see to_hex()
+  static constexpr size_t HEX_BUFFER_SIZE = MAX_FRAME_SIZE * 3 + 1;
+
   daikin_package() = default;
   explicit daikin_package(Mode m) : mode_(m) {}
 
   // --- Factory helpers ---
   static daikin_package MakeRequest(uint8_t reg_id) {
     daikin_package MyNewPackage(Mode::SEND_REQUEST);
-    MyNewPackage.packet_buffer = {0x03, 0x40, reg_id, 0x00};
-    MyNewPackage.packet_buffer[3] = crc_(MyNewPackage.packet_buffer.data(), 3);
+    MyNewPackage.push_back(0x03);
+    MyNewPackage.push_back(0x40);
+    MyNewPackage.push_back(reg_id);
+    MyNewPackage.push_back(MyNewPackage.crc_());
     return MyNewPackage;
   }
 
-  static daikin_package FromBytes(const std::vector<uint8_t>& bytes) {
+  static daikin_package FromBytes(const uint8_t *bytes, size_t len) {
     daikin_package MyNewPackage(Mode::RECEIVE);
-    MyNewPackage.packet_buffer = bytes;
+    for (size_t i = 0; i < len && MyNewPackage.push_back(bytes[i]); i++) {}
     return MyNewPackage;
   }
 
   // --- Buffer access ---
-  const std::vector<uint8_t>& buffer() const { return packet_buffer; }
-  std::vector<uint8_t>& buffer_mut() { return packet_buffer; }
-  void clear() { packet_buffer.clear(); }
+  const uint8_t *data() const { return packet_buffer.data(); }
+  uint8_t operator[](size_t i) const { return packet_buffer[i]; }
+  void clear() { size_ = 0; sum_ = 0; }
+
+  // Appends one byte and updates the running checksum; false when the frame is full
+  bool push_back(uint8_t b) {
+    if (size_ >= MAX_FRAME_SIZE) return false;
+    packet_buffer[size_++] = b;
+    sum_ += b;
+    return true;
+  }
 
-  bool empty() const { return packet_buffer.empty(); }
-  size_t size() const { return packet_buffer.size(); }
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
 
-  bool HasMinimalHeader() const { return packet_buffer.size() >= 3; }
+  bool HasMinimalHeader() const { return size_ >= 3; }
   size_t expected_size() const {
     if (!HasMinimalHeader()) return 0;
     return static_cast<size_t>(packet_buffer[2]) + 2;
   }
 
   bool is_error_frame() const {
-    return packet_buffer.size() >= 2 && packet_buffer[0] == 0x15 && packet_buffer[1] == 0xEA;
+    return size_ >= 2 && packet_buffer[0] == 0x15 && packet_buffer[1] == 0xEA;
   }
 
-  bool is_valid_protocol() const { return !packet_buffer.empty() && packet_buffer[0] == 0x40; }
+  bool is_valid_protocol() const { return size_ > 0 && packet_buffer[0] == 0x40; }
 
+  // The last byte is the checksum of all bytes before it; uses the sum kept by push_back()
   bool Valid_CRC() const {
-    if (packet_buffer.size() < 2) return false;
-    const int n = static_cast<int>(packet_buffer.size());
-    return crc_(packet_buffer.data(), n - 1) == packet_buffer[n - 1];
-  }
-
-  std::string ToHexString() const {
-    char b[4];
-    std::string out;
-    for (uint8_t c : packet_buffer) {
-      snprintf(b, sizeof(b), "%02X", c);
-      out += b;
-      out += ' ';
+    if (size_ < 2) return false;
+    const uint8_t last = packet_buffer[size_ - 1];
+    return static_cast<uint8_t>(~static_cast<uint8_t>(sum_ - last)) == last;
+  }
+
+  // Writes "XX XX ... " into out (at most out_len bytes including the terminator) and returns out
+  const char *to_hex(char *out, size_t out_len) const {
+    static const char digits[] = "0123456789ABCDEF";
+    if (out_len == 0) return out;
+    size_t pos = 0;
+    for (size_t i = 0; i < size_ && pos + 3 < out_len; i++) {
+      out[pos++] = digits[packet_buffer[i] >> 4];
+      out[pos++] = digits[packet_buffer[i] & 0x0F];
+      out[pos++] = ' ';
     }
+    out[pos] = '\0';
     return out;
   }
 
@@ -68,7 +88,7 @@ class daikin_package {
 
   // Protocol I: registry ID at byte position 1
   uint8_t registry_id() const {
-    return (packet_buffer.size() > 1) ? packet_buffer[1] : 0;
+    return (size_ > 1) ? packet_buffer[1] : 0;
   }
 
   // Protocol I: data starts at byte position 3 (after: 0x40, registry_id, length)
@@ -77,13 +97,206 @@ class daikin_package {
   }
 
  private:
-  std::vector<uint8_t> packet_buffer;
+  std::array<uint8_t, MAX_FRAME_SIZE> packet_buffer;
+  size_t size_{0};
+  uint8_t sum_{0};  // running byte sum of packet_buffer, the checksum is its complement
   Mode mode_{Mode::RECEIVE};
 
   // --- CRC ---
-  static uint8_t crc_(const uint8_t *src, int len) {
-    uint8_t b = 0;
-    for (int i = 0; i < len; i++) b += src[i];
-    return static_cast<uint8_t>(~b);
+  uint8_t crc_() const { return static_cast<uint8_t>(~sum_); }
+};
+
+// Fixed-capacity byte FIFO between the UART and the frame parser; N must be a power of two
+template<size_t N> class daikin_ring_buffer {
+  static_assert((N & (N - 1)) == 0, "daikin_ring_buffer size must be a power of two");
+
+ public:
+  bool push(uint8_t b) {
+    if (size() == N) return false;
+    buffer_[head_++ & (N - 1)] = b;
+    return true;
+  }
+
+  bool pop(uint8_t *b) {
+    if (empty()) return false;
+    *b = buffer_[tail_++ & (N - 1)];
+    return true;
+  }
+
+  // i-th byte from the oldest one, i < size()
+  uint8_t peek(size_t i) const { return buffer_[(tail_ + i) & (N - 1)]; }
+  void drop(size_t n) { tail_ += (n < size()) ? n : size(); }
+  void clear() { tail_ = head_; }
+
+  size_t size() const { return head_ - tail_; }
+  size_t free() const { return N - size(); }
+  bool empty() const { return head_ == tail_; }
+
+ private:
+  std::array<uint8_t, N> buffer_;
+  size_t head_{0};
+  size_t tail_{0};
+};
+
+// A value one thread writes and another reads, e.g. a counter of the UART task that loop() publishes: relaxed atomic loads and stores,
+// which cost what plain ones do on the ESP32. One writer only: ++, -- and += are a load and a store, not a read-modify-write. Unlike
+// std::atomic it can be copied, so it fits in structs kept in a std::vector
+template<typename T> class daikin_relaxed {
+ public:
+  constexpr daikin_relaxed(T value = T{}) : value_(value) {}
+  daikin_relaxed(const daikin_relaxed &other) : value_(other.load()) {}
+  daikin_relaxed &operator=(const daikin_relaxed &other) { return *this = other.load(); }
+  daikin_relaxed &operator=(T value) {
+    store(value);
+    return *this;
+  }
+
+  T load() const { return value_.load(std::memory_order_relaxed); }
+  void store(T value) { value_.store(value, std::memory_order_relaxed); }
+  operator T() const { return load(); }
+
+  T operator++() { return *this += 1; }
+  T operator--() { return *this -= 1; }
+  T operator++(int) { return (*this += 1) - 1; }
+  T operator--(int) { return (*this -= 1) + 1; }
+  T operator+=(T n) {
+    const T value = static_cast<T>(load() + n);
+    store(value);
+    return value;
+  }
+  T operator-=(T n) {
+    const T value = static_cast<T>(load() - n);
+    store(value);
+    return value;
+  }
+  T operator/=(T n) {
+    const T value = static_cast<T>(load() / n);
+    store(value);
+    return value;
+  }
+
+ private:
+  std::atomic<T> value_;
+};
+
+// Lock-free queue between exactly two threads: one only calls push(), the other only pop(). Each index is written by one side only, so
+// neither side ever waits on the other; N must be a power of two
+template<typename T, size_t N> class daikin_spsc_queue {
+  static_assert((N & (N - 1)) == 0, "daikin_spsc_queue size must be a power of two");
+
+ public:
+  // Producer side; false when the queue is full
+  bool push(const T &item) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == N) return false;
+    items_[head & (N - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side; false when the queue is empty
+  bool pop(T *item) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) return false;
+    *item = items_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
   }
+
+  // Snapshot only, the other side may change it right after
+  size_t size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+  bool empty() const { return size() == 0; }
+
+ private:
+  std::array<T, N> items_;
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+};
+
+// Cuts frames out of the UART byte stream. It looks for a header (0x40, or the 0x15 0xEA error frame), checks the candidate with its
+// length byte and checksum, and on a mismatch slides forward a single byte instead of discarding everything buffered, so it re-locks
+// on the next real frame right away. Frames are returned whatever their registry; the caller decides what to do with them
+template<size_t N> class daikin_stream_decoder {
+ public:
+  enum class Result { NEED_MORE, FRAME, ERROR_FRAME };
+
+  // 0x40, registry, length, checksum
+  static constexpr size_t MIN_FRAME_SIZE = 4;
+
+  // Returns how many of the bytes fitted
+  size_t feed(const uint8_t *bytes, size_t len) {
+    size_t n = 0;
+    while (n < len && ring_.push(bytes[n])) n++;
+    return n;
+  }
+
+  // Extracts the next complete, checksum-valid frame into out
+  Result next(daikin_package &out) {
+    while (ring_.size() >= 2) {
+      const uint8_t b0 = ring_.peek(0);
+      if (b0 == 0x15 && ring_.peek(1) == 0xEA) {
+        out.clear();
+        out.push_back(0x15);
+        out.push_back(0xEA);
+        ring_.drop(2);
+        return Result::ERROR_FRAME;
+      }
+      if (b0 != 0x40) {
+        skip_();
+        continue;
+      }
+      if (ring_.size() < 3) return Result::NEED_MORE;
+
+      const size_t total = static_cast<size_t>(ring_.peek(2)) + 2;
+      if (total < MIN_FRAME_SIZE) {
+        skip_();
+        continue;
+      }
+      if (ring_.size() < total) return Result::NEED_MORE;
+
+      uint8_t sum = 0;
+      for (size_t i = 0; i + 1 < total; i++) sum += ring_.peek(i);
+      if (static_cast<uint8_t>(~sum) != ring_.peek(total - 1)) {
+        crc_mismatches_++;
+        skip_();
+        continue;
+      }
+
+      out.clear();
+      for (size_t i = 0; i < total; i++) out.push_back(ring_.peek(i));
+      ring_.drop(total);
+      return Result::FRAME;
+    }
+    if (ring_.size() == 1 && ring_.peek(0) != 0x40 && ring_.peek(0) != 0x15) skip_();
+    return Result::NEED_MORE;
+  }
+
+  // Size announced by the frame header at the front of the buffer, 0 while there is none
+  size_t candidate_size() const {
+    if (ring_.size() < 3 || ring_.peek(0) != 0x40) return 0;
+    return static_cast<size_t>(ring_.peek(2)) + 2;
+  }
+  uint8_t candidate_registry() const { return ring_.size() >= 2 ? ring_.peek(1) : 0; }
+
+  // Gives up on the candidate at the front (e.g. a truncated frame) and rescans from the next byte
+  void resync() {
+    if (!ring_.empty()) skip_();
+  }
+
+  size_t buffered() const { return ring_.size(); }
+  size_t free() const { return ring_.free(); }
+  void clear() { ring_.clear(); }
+
+  uint32_t crc_mismatches() const { return crc_mismatches_; }
+  uint32_t skipped_bytes() const { return skipped_bytes_; }
+
+ private:
+  void skip_() {
+    ring_.drop(1);
+    skipped_bytes_++;
+  }
+
+  daikin_ring_buffer<N> ring_;
+  daikin_relaxed<uint32_t> crc_mismatches_{0};  // read by loop() while the UART task decodes
+  daikin_relaxed<uint32_t> skipped_bytes_{0};
 };
@@ -0,0 +1,124 @@
+#include "daikin_x10a.h"
+#include "esphome/core/log.h"
+
+#ifdef USE_DAIKIN_X10A_TELEMETRY
+
+#include <cerrno>
+
+namespace esphome {
+namespace daikin_x10a {
+
+static constexpr uint32_t Telemetry_RetryMs = 5000;  // wait between connect attempts after the listener could not be reached
+
+//__________________________________________________________________________________________________________________________ telemetry_record_ begin
+// Appends to the open batch; a full batch is sent first. Never blocks: what cannot be sent is counted in telemetry_dropped_
+void DaikinX10A::telemetry_record_(daikin_telemetry_buffer::Record type, const uint8_t *data, size_t len) {
+  if (telemetry_sending_) this->telemetry_flush_();
+  if (telemetry_sending_) {
+    telemetry_dropped_++;
+    return;
+  }
+
+  const uint32_t now_us = micros();
+  if (telemetry_.empty()) telemetry_batch_ms_ = millis();
+  if (telemetry_.append(type, now_us, data, len)) return;
+
+  this->telemetry_flush_();
+  if (telemetry_sending_ || !telemetry_.append(type, now_us, data, len)) {
+    telemetry_dropped_++;
+    return;
+  }
+  telemetry_batch_ms_ = millis();
+}
+
+void DaikinX10A::telemetry_value_(uint16_t handle, const RegisterValue &value) {
+  uint8_t payload[daikin_telemetry_buffer::VALUE_SIZE];
+  daikin_telemetry_buffer::encode_value(payload, handle, static_cast<uint8_t>(value.kind), value.raw, value.number);
+  this->telemetry_record_(daikin_telemetry_buffer::Record::VALUE, payload, sizeof(payload));
+}
+//________________________________________________________________ telemetry_record_ end
+
+//__________________________________________________________________________________________________________________________ telemetry_flush_ begin
+// Called with every poll: sends the open batch once it is telemetry_flush_ms_ old, and continues a TCP write that did not complete
+void DaikinX10A::telemetry_poll_() {
+  if (telemetry_.empty()) return;
+  if (telemetry_sending_ || millis() - telemetry_batch_ms_ >= telemetry_flush_ms_) this->telemetry_flush_();
+}
+
+void DaikinX10A::telemetry_flush_() {
+  if (telemetry_.empty()) return;
+  if (!this->telemetry_connect_()) {
+    this->telemetry_drop_();
+    return;
+  }
+  if (!telemetry_sending_) {
+    telemetry_.finish(telemetry_sequence_++);
+    telemetry_written_ = 0;
+    telemetry_sending_ = true;
+  }
+
+  if (!telemetry_tcp_) {
+    // A datagram that does not go out now is not retried: the batch counts as lost and the sequence number shows the gap
+    const ssize_t sent = telemetry_socket_->sendto(telemetry_.data(), telemetry_.size(), 0,
+                                                    reinterpret_cast<struct sockaddr *>(&telemetry_addr_), telemetry_addr_len_);
+    if (sent != (ssize_t)telemetry_.size()) telemetry_dropped_ += telemetry_.records();
+    telemetry_.clear();
+    telemetry_sending_ = false;
+    return;
+  }
+
+  const ssize_t written = telemetry_socket_->write(telemetry_.data() + telemetry_written_, telemetry_.size() - telemetry_written_);
+  if (written > 0) telemetry_written_ += (size_t)written;
+  if (telemetry_written_ == telemetry_.size()) {
+    telemetry_.clear();
+    telemetry_sending_ = false;
+    return;
+  }
+  // Still connecting or the send buffer is full: the rest goes out with a later poll. Anything else means the connection is gone
+  if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINPROGRESS && errno != ENOTCONN) {
+    ESP_LOGW("ESPoeDaikin", "Telemetry connection to %s:%u lost (errno %d)", telemetry_host_.c_str(), telemetry_port_, errno);
+    telemetry_socket_.reset();
+    telemetry_retry_ms_ = millis();
+    this->telemetry_drop_();
+  }
+}
+
+// Opens the socket on first use and again Telemetry_RetryMs after a failure. TCP connects without blocking
+bool DaikinX10A::telemetry_connect_() {
+  if (telemetry_socket_ != nullptr) return true;
+  if (telemetry_retry_ms_ != 0 && millis() - telemetry_retry_ms_ < Telemetry_RetryMs) return false;
+
+  telemetry_addr_len_ = socket::set_sockaddr(reinterpret_cast<struct sockaddr *>(&telemetry_addr_), sizeof(telemetry_addr_),
+                                             telemetry_host_, telemetry_port_);
+  telemetry_socket_ = socket::socket_ip(telemetry_tcp_ ? SOCK_STREAM : SOCK_DGRAM, 0);
+  if (telemetry_addr_len_ == 0 || telemetry_socket_ == nullptr) {
+    ESP_LOGW("ESPoeDaikin", "Could not create the telemetry socket for %s:%u", telemetry_host_.c_str(), telemetry_port_);
+    telemetry_socket_.reset();
+    telemetry_retry_ms_ = millis();
+    return false;
+  }
+  telemetry_socket_->setblocking(false);
+  if (telemetry_tcp_ &&
+      telemetry_socket_->connect(reinterpret_cast<struct sockaddr *>(&telemetry_addr_), telemetry_addr_len_) != 0 &&
+      errno != EINPROGRESS) {
+    ESP_LOGW("ESPoeDaikin", "Could not connect to telemetry listener %s:%u (errno %d)", telemetry_host_.c_str(), telemetry_port_, errno);
+    telemetry_socket_.reset();
+    telemetry_retry_ms_ = millis();
+    return false;
+  }
+  telemetry_retry_ms_ = 0;
+  ESP_LOGI("ESPoeDaikin", "Telemetry stream to %s %s:%u", telemetry_tcp_ ? "tcp" : "udp", telemetry_host_.c_str(), telemetry_port_);
+  return true;
+}
+
+void DaikinX10A::telemetry_drop_() {
+  telemetry_dropped_ += telemetry_.records();
+  telemetry_.clear();
+  telemetry_sending_ = false;
+}
+//________________________________________________________________ telemetry_flush_ end
+
+}  // namespace daikin_x10a
+}  // namespace esphome
+
+#endif  // USE_DAIKIN_X10A_TELEMETRY
@@ -0,0 +1,81 @@
+// daikin_telemetry.h
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+// One batch of the telemetry stream, built in a fixed buffer and sent as a single UDP datagram or TCP write. All fields little endian:
+//
+//   batch header (10 bytes)  'X' 'T' | version u8 | record count u8 | records length u16 | batch sequence u32
+//   record (7 + n bytes)     type u8 | payload length u16 | timestamp u32 (micros(), wraps every ~71 min) | payload
+//
+// Record payloads: FRAME and REQUEST carry the frame bytes as on the wire; VALUE carries register handle u16 | RegisterValue::Kind u8 |
+// raw u8 | number f32. The sequence lets a listener count lost UDP batches; tools/x10a_telemetry.py turns the stream into CSV
+class daikin_telemetry_buffer {
+ public:
+  enum class Record : uint8_t { FRAME = 1, REQUEST = 2, VALUE = 3 };
+
+  static constexpr size_t CAPACITY = 1400;  // stays below the ethernet MTU, so a batch is never fragmented
+  static constexpr size_t HEADER_SIZE = 10;
+  static constexpr size_t RECORD_HEADER_SIZE = 7;
+  static constexpr size_t VALUE_SIZE = 8;
+  static constexpr uint8_t VERSION = 1;
+
+  // false when the record does not fit anymore (or the batch already holds 255 records); the batch is unchanged then
+  bool append(Record type, uint32_t timestamp_us, const uint8_t *payload, size_t len) {
+    if (records_ == 255 || size_ + RECORD_HEADER_SIZE + len > CAPACITY) return false;
+    buffer_[size_++] = static_cast<uint8_t>(type);
+    put_u16_(len);
+    put_u32_(timestamp_us);
+    std::memcpy(&buffer_[size_], payload, len);
+    size_ += len;
+    records_++;
+    return true;
+  }
+
+  // Payload of a VALUE record, VALUE_SIZE bytes
+  static void encode_value(uint8_t *out, uint16_t handle, uint8_t kind, uint8_t raw, float number) {
+    uint32_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    out[0] = handle & 0xFF;
+    out[1] = handle >> 8;
+    out[2] = kind;
+    out[3] = raw;
+    for (int i = 0; i < 4; i++) out[4 + i] = (bits >> (8 * i)) & 0xFF;
+  }
+
+  // Writes the batch header; data()/size() are then ready to send
+  void finish(uint32_t sequence) {
+    const size_t records_length = size_ - HEADER_SIZE;
+    buffer_[0] = 'X';
+    buffer_[1] = 'T';
+    buffer_[2] = VERSION;
+    buffer_[3] = records_;
+    buffer_[4] = records_length & 0xFF;
+    buffer_[5] = records_length >> 8;
+    for (int i = 0; i < 4; i++) buffer_[6 + i] = (sequence >> (8 * i)) & 0xFF;
+  }
+
+  const uint8_t *data() const { return buffer_.data(); }
+  size_t size() const { return size_; }
+  uint8_t records() const { return records_; }
+  bool empty() const { return records_ == 0; }
+  void clear() {
+    size_ = HEADER_SIZE;
+    records_ = 0;
+  }
+
+ private:
+  void put_u16_(size_t v) {
+    buffer_[size_++] = v & 0xFF;
+    buffer_[size_++] = (v >> 8) & 0xFF;
+  }
+  void put_u32_(uint32_t v) {
+    for (int i = 0; i < 4; i++) buffer_[size_++] = (v >> (8 * i)) & 0xFF;
+  }
+
+  std::array<uint8_t, CAPACITY> buffer_;
+  size_t size_{HEADER_SIZE};
+  uint8_t records_{0};
+};
@@ -0,0 +1,130 @@
+#include "daikin_x10a.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+#ifdef USE_DAIKIN_X10A_WARM_START
+
+#include <cstddef>
+
+namespace esphome {
+namespace daikin_x10a {
+
+static constexpr uint8_t WarmStart_Version = 1;
+static constexpr uint32_t WarmStart_QuietMs = 500;     // line silence after which the UART counts as ready for the first sweep
+static constexpr uint32_t WarmStart_ShutdownMs = 500;  // longest on_shutdown() waits for the UART task to hand over frames
+
+uint16_t DaikinX10A::warm_start_crc_(const WarmStartRecord &record) {
+  return crc16(reinterpret_cast<const uint8_t *>(&record), offsetof(WarmStartRecord, crc));
+}
+
+//__________________________________________________________________________________________________________________________ warm_start_restore_ begin
+// Runs from setup(), after compile_registers_(): every registry with a valid saved frame is decoded and published right away. The
+// registry cache holds the frame but is not valid, so the first frame read from the HP is always decoded and published again
+void DaikinX10A::warm_start_restore_() {
+  // Keyed by instance: every heat pump has its own records
+  const uint32_t key = fnv1_hash(std::string("daikin_x10a_warm_start_") + instance_name_);
+  warm_prefs_.clear();
+  warm_prefs_.reserve(registry_cache_.size());
+  uint16_t restored = 0;
+
+  for (unsigned registry_id = 0; registry_id < registry_spans_.size(); registry_id++) {
+    const RegistrySpan &span = registry_spans_[registry_id];
+    if (span.cache == NO_CACHE) continue;
+    warm_prefs_.push_back(global_preferences->make_preference<WarmStartRecord>(key + registry_id, true));
+
+    if (!warm_prefs_.back().load(&warm_record_)) continue;
+    if (warm_record_.version != WarmStart_Version || warm_record_.registry_id != registry_id ||
+        warm_record_.length > sizeof(warm_record_.frame) || warm_record_.crc != warm_start_crc_(warm_record_))
+      continue;
+    daikin_package pkg = daikin_package::FromBytes(warm_record_.frame, warm_record_.length);
+    if (pkg.size() < 6 || !pkg.is_valid_protocol() || !pkg.Valid_CRC() || pkg.registry_id() != registry_id) continue;
+
+    RegistryCache &cache = registry_cache_[span.cache];
+    cache.frame.assign(pkg.data(), pkg.data() + pkg.size());  // for decode_on_demand_(); valid stays false
+    cache.generation++;
+    cache.stale = true;
+    this->decode_registry_(pkg, span, true);
+#ifdef USE_DAIKIN_X10A_DERIVED
+    this->mark_derived_(registry_id, true);
+#endif
+    restored++;
+  }
+  warm_record_ = WarmStartRecord{};
+  warm_stale_count_ = restored;
+  warm_stale_published_ = restored;
+  if (stale_registries_sensor_ != nullptr) stale_registries_sensor_->publish_state(restored);
+  ESP_LOGI("ESPoeDaikin", "Warm start: restored %u of %u registries, stale until read from the HP", (unsigned)restored,
+           (unsigned)registry_cache_.size());
+}
+
+// Before the first sweep: drops whatever is left on the line from before the reboot; true once it has been quiet for WarmStart_QuietMs
+bool DaikinX10A::boot_line_quiet_() {
+  const uint32_t now = millis();
+  uint8_t byte;
+  while (this->available() > 0 && this->read_byte(&byte)) boot_quiet_ms_ = now;
+  return now - boot_quiet_ms_ >= WarmStart_QuietMs;
+}
+//________________________________________________________________ warm_start_restore_ end
+
+//__________________________________________________________________________________________________________________________ warm_start_save_ begin
+// Poller side (loop() or the UART task): copies the registry's frame into warm_record_ when it changed since the last write,
+// otherwise leaves warm_record_ empty
+void DaikinX10A::warm_start_fill_(uint16_t cache_index) {
+  RegistryCache &cache = registry_cache_[cache_index];
+  warm_record_ = WarmStartRecord{};
+  if (!cache.valid || !cache.dirty || cache.frame.size() > sizeof(warm_record_.frame)) return;
+
+  warm_record_.version = WarmStart_Version;
+  warm_record_.registry_id = cache.frame[1];
+  warm_record_.length = static_cast<uint16_t>(cache.frame.size());
+  std::memcpy(warm_record_.frame, cache.frame.data(), cache.frame.size());
+  warm_record_.crc = warm_start_crc_(warm_record_);
+  cache.dirty = false;
+}
+
+// loop() side: hands the filled record to the preferences, which commit it to flash with their own flash_write_interval
+void DaikinX10A::warm_start_write_(uint16_t cache_index) {
+  if (warm_record_.length == 0) return;
+  if (warm_prefs_[cache_index].save(&warm_record_)) warm_saved_++;
+}
+
+// One registry per call while the UART task runs (it copies the frame between two polls), all of them in one go otherwise
+void DaikinX10A::warm_start_save_step_() {
+  if (warm_fill_pending_) {
+    if (warm_fill_request_.load(std::memory_order_acquire) != 0) return;
+    warm_fill_pending_ = false;
+    this->warm_start_write_(warm_save_index_++);
+  }
+  while (warm_save_index_ < registry_cache_.size()) {
+    if (task_running_) {
+      warm_fill_pending_ = true;
+      warm_fill_request_.store(warm_save_index_ + 1, std::memory_order_release);
+      return;
+    }
+    this->warm_start_fill_(warm_save_index_);
+    this->warm_start_write_(warm_save_index_++);
+  }
+  warm_saving_ = false;
+  if (warm_saved_ > 0) ESP_LOGD("ESPoeDaikin", "Warm start: saved %u changed registries", (unsigned)warm_saved_);
+}
+
+// OTA and clean reboots: write what changed since the last interval and commit it, rather than wait for the next flash_write_interval
+void DaikinX10A::on_shutdown() {
+  if (!warm_saving_) {
+    warm_saving_ = true;
+    warm_save_index_ = 0;
+    warm_saved_ = 0;
+  }
+  const uint32_t start = millis();
+  while (warm_saving_ && millis() - start < WarmStart_ShutdownMs) {
+    this->warm_start_save_step_();
+    if (warm_saving_) delay(1);
+  }
+  global_preferences->sync();
+}
+//________________________________________________________________ warm_start_save_ end
+
+}  // namespace daikin_x10a
+}  // namespace esphome
+
+#endif  // USE_DAIKIN_X10A_WARM_START
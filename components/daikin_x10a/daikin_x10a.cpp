@@ -6,281 +6,1057 @@
 
 #include <vector>
 #include <string>
-#include <set>
-#include <cstdlib>  // for atof
 #include <cmath>    // for NAN, std::isnan
+#include <cstring>
+#include <cctype>
+#include <cstdio>
+#include <algorithm>
 
 namespace esphome {
 namespace daikin_x10a {
 
 DaikinX10A::~DaikinX10A() = default;
 
-static constexpr uint32_t Serial_TimeoutInMilliseconds = 300;
+static constexpr uint32_t Serial_TimeoutInMilliseconds = 300;     // first-byte allowance until a registry's latency has been measured
+static constexpr uint32_t Serial_MinResponseAllowanceUs = 50000;  // lower bound of the measured first-byte allowance
+static constexpr uint32_t Serial_InterByteMarginUs = 20000;       // slack for gaps in the HP's transmission
+static constexpr size_t Serial_MaxBytesPerLoop = 64;  // bounds the time a single loop() spends draining the UART
+static constexpr uint8_t Probe_Attempts = 2;          // requests in a row a registry may leave unanswered before it is declared dead
+// Bytes. The task decodes, publishes to telemetry and derived metrics and logs: in debug mode a frame's hex (HEX_BUFFER_SIZE bytes on
+// the stack of send_request_() and finish_request_()) goes through ESP_LOG*'s vsnprintf, which takes about 1.5 KB of its own
+static constexpr uint32_t UartTask_StackSize = 4096 + daikin_package::HEX_BUFFER_SIZE + 1536;
+static constexpr uint32_t UartTask_Priority = 5;      // above loop() (1), the task sleeps a tick whenever it waits for the HP
+
+//__________________________________________________________________________________________________________________________ setup begin
+void DaikinX10A::setup() {
+  this->compile_registers_();
+#ifdef USE_DAIKIN_X10A_DERIVED
+  this->compile_derived_();
+#endif
+  setup_ms_ = millis();
+
+  // Receive deadlines are derived from the character time: start bit + data bits + parity + stop bits
+  const uint32_t baud = this->parent_->get_baud_rate();
+  const uint32_t bits = 1 + this->parent_->get_data_bits() + this->parent_->get_stop_bits() +
+                        (this->parent_->get_parity() != uart::UART_CONFIG_PARITY_NONE ? 1 : 0);
+  if (baud > 0) byte_time_us_ = (bits * 1000000UL + baud - 1) / baud;
+
+#ifdef USE_DAIKIN_X10A_DIAGNOSTICS
+  diagnostics_ms_ = setup_ms_;
+  this->set_interval("diagnostics", diagnostics_interval_ms_, [this]() { this->publish_diagnostics_(); });
+#endif
+
+#ifdef USE_DAIKIN_X10A_WARM_START
+  boot_quiet_ms_ = setup_ms_;
+  this->warm_start_restore_();
+  this->set_interval("warm_start", warm_write_interval_ms_, [this]() {
+    if (warm_saving_) return;
+    warm_saving_ = true;
+    warm_save_index_ = 0;
+    warm_saved_ = 0;
+  });
+#endif
+#ifdef USE_DAIKIN_X10A_HISTORY
+  this->history_setup_();
+#endif
+}
+//________________________________________________________________ setup end
 
 //__________________________________________________________________________________________________________________________ loop begin
 void DaikinX10A::loop() {
-  static uint32_t start = 0;
-  static bool initialDelayDone = false;
-
-  if (!initialDelayDone) {
-    if (millis() >= 15000) {
-      start = millis();
-      initialDelayDone = true;
-    }
-    return;
+  if (!polling_started_) {
+#ifdef USE_DAIKIN_X10A_WARM_START
+    // The restored values are already published: start as soon as the line is quiet, boot_delay_ms_ only caps the wait
+    if (!this->boot_line_quiet_() && millis() - setup_ms_ < boot_delay_ms_) return;
+#else
+    if (millis() - setup_ms_ < boot_delay_ms_) return;
+#endif
+    polling_started_ = true;
+    this->FetchRegisters();
+    if (uart_task_) this->start_uart_task_();
   }
 
-  if (millis() - start >= REGISTER_SCAN_INTERVAL_MS) {
-    start = millis();
-    this->FetchRegisters();
+#ifdef USE_DAIKIN_X10A_DIAGNOSTICS
+  const uint32_t loop_start_us = micros();
+#endif
+  if (task_running_) {
+    this->drain_updates_();
+  } else {
+    this->poll_uart_();
+#ifdef USE_DAIKIN_X10A_TELEMETRY
+    this->telemetry_poll_();
+#endif
   }
+#ifdef USE_DAIKIN_X10A_DERIVED
+  if (derived_dirty_ != 0 || derived_samples_.load(std::memory_order_relaxed) != 0 ||
+      derived_changed_.load(std::memory_order_relaxed) != 0)
+    this->evaluate_derived_();
+#endif
+#ifdef USE_DAIKIN_X10A_HISTORY
+  if (history_dirty_ != 0) this->history_sample_();
+  if (history_server_ != nullptr || history_client_ != nullptr) this->history_serve_();
+#endif
+#ifdef USE_DAIKIN_X10A_WARM_START
+  if (warm_saving_) this->warm_start_save_step_();
+  const uint16_t stale = warm_stale_count_;
+  if (stale_registries_sensor_ != nullptr && stale != warm_stale_published_) {
+    warm_stale_published_ = stale;
+    stale_registries_sensor_->publish_state(stale);
+  }
+#endif
+#ifdef USE_DAIKIN_X10A_DIAGNOSTICS
+  const uint16_t probe = probe_generation_;
+  if (registry_probe_sensor_ != nullptr && probe_pending_ == 0 && probe != probe_published_) {
+    probe_published_ = probe;
+    this->publish_probe_results_();
+  }
+  loop_time_max_us_ = std::max(loop_time_max_us_, micros() - loop_start_us);
+#endif
 }
 //________________________________________________________________ loop end
 
 //__________________________________________________________________________________________________________________________ FetchRegisters begin
-// FetchRegisters() is called every REGISTER_SCAN_INTERVAL_MS milliseconds, and loops over all registers with Mode==1 (read) to fetch their values from the HP via UART
+// FetchRegisters() makes every entry of poll_schedule_ (every registryID that has a register with Mode>=1 (read)) due now. poll_uart_()
+// then sends the requests one at a time, earliest deadline first, without blocking loop() while waiting for the HP
 void DaikinX10A::FetchRegisters() {
-  std::set<uint8_t> fetched_registries;  // Track which registryIDs we've already requested in this scan cycle
-
-  for (const auto& selectedRegister : registers_) {  //____________________________________ loop over all registers
-    if (selectedRegister.Mode >= 1) {
-      // Skip if we've already fetched this registryID in this scan cycle
-      if (fetched_registries.count(selectedRegister.registryID) > 0) {
-        continue;
-      }
-
-      // Mark this registryID as fetched
-      fetched_registries.insert(selectedRegister.registryID);
+  // The UART task owns the schedule; it picks the request up before its next poll
+  if (task_running_) {
+    fetch_requested_.store(true);
+    return;
+  }
+  this->make_all_due_();
+}
 
-      auto MyDaikinRequestPackage = daikin_package::MakeRequest(selectedRegister.registryID);
+// Dead registries keep their re-probe time
+void DaikinX10A::make_all_due_() {
+  const uint32_t now = millis();
+  for (auto &entry : poll_schedule_) {
+    if (entry.dead) continue;
+    entry.next_due_ms = now;
+    entry.done = false;
+  }
+}
+//________________________________________________________________ FetchRegisters end
 
-      if (debug_mode_) ESP_LOGI("ESPoeDaikin", "TX (%u): %s", (unsigned)MyDaikinRequestPackage.size(), MyDaikinRequestPackage.ToHexString().c_str());
+//__________________________________________________________________________________________________________________________ scheduler begin
+void DaikinX10A::set_registry_schedule(uint8_t registry_id, uint32_t interval_ms, uint8_t priority) {
+  PollEntry entry;
+  entry.registry_id = registry_id;
+  entry.interval_ms = interval_ms;
+  entry.priority = priority;
+  schedule_config_.push_back(entry);
+}
 
-      this->flush();  // Clear the serial buffer before sending
-      for (uint8_t requestByte : MyDaikinRequestPackage.buffer()) this->write(requestByte);
+// Earliest deadline first among the entries that are due; priority breaks ties
+DaikinX10A::PollEntry *DaikinX10A::next_due_entry_(uint32_t now) {
+  PollEntry *best = nullptr;
+  for (auto &entry : poll_schedule_) {
+    if (entry.done || (int32_t)(now - entry.next_due_ms) < 0) continue;
+    if (best == nullptr) { best = &entry; continue; }
+    const int32_t earlier = (int32_t)(best->next_due_ms - entry.next_due_ms);
+    if (earlier > 0 || (earlier == 0 && entry.priority > best->priority)) best = &entry;
+  }
+  return best;
+}
 
-      daikin_package MyDaikinPackage(daikin_package::Mode::RECEIVE);
+// Identical frames double the backoff (up to max_backoff_), a changed frame resets it; failed requests keep it
+void DaikinX10A::reschedule_(PollEntry &entry, bool received, bool changed) {
+  this->probe_result_(entry, received);
+  if (entry.dead) {
+    entry.next_due_ms = request_start_ms_ + reprobe_interval_ms_;
+    return;
+  }
+  // First miss of a registry that never answered: asked again at the end of this sweep, so the probe is over with the first sweep
+  if (!received && !entry.answered && entry.misses == 1) {
+    entry.next_due_ms = request_start_ms_;
+    return;
+  }
+  if (received && entry.interval_ms == POLL_ONCE) {
+    entry.done = true;
+    return;
+  }
+  if (received) entry.backoff = changed ? 1 : std::min<uint8_t>(entry.backoff * 2, max_backoff_);
 
-      const uint32_t FetchRegistersStartMilliseconds = millis();
-      size_t IncommingPackageSize = 3;
-      uint8_t target_registry = selectedRegister.registryID;
-      
-      // Retry loop: keep reading until we get the CORRECT registry response or timeout
-      while (millis() - FetchRegistersStartMilliseconds < Serial_TimeoutInMilliseconds) {
-        if (!this->available()) continue;
-        
-        uint8_t incomingByte;
-        this->read_byte(&incomingByte);
+  const uint32_t interval = (entry.interval_ms != POLL_ONCE) ? entry.interval_ms : scan_interval_ms_;
+  entry.next_due_ms = request_start_ms_ + interval * entry.backoff;
+}
 
-        // Skip if not protocol marker (0x40)
-        if (MyDaikinPackage.empty() && incomingByte != 0x40) continue;
+DaikinX10A::PollEntry *DaikinX10A::entry_for_(uint8_t registry_id) {
+  for (auto &entry : poll_schedule_) {
+    if (entry.registry_id == registry_id) return &entry;
+  }
+  return nullptr;
+}
+//________________________________________________________________ scheduler end
+
+//__________________________________________________________________________________________________________________________ registry probe begin
+// Not every model answers every registry: one that never answered is declared dead after Probe_Attempts misses in a row, but only
+// once some other registry did answer (a silent bus says nothing about the registry). A registry that answered before is never
+// dropped, its timeouts are just counted
+void DaikinX10A::probe_result_(PollEntry &entry, bool received) {
+  const bool known = entry.answered || entry.dead;
+  if (received) {
+    entry.misses = 0;
+    if (!entry.answered) probe_answering_++;
+    entry.answered = true;
+    if (entry.dead) {
+      entry.dead = false;
+      probe_dead_--;
+      probe_generation_++;
+      ESP_LOGI("ESPoeDaikin", "Registry 0x%02X answers now, back on the schedule", entry.registry_id);
+    }
+  } else {
+    if (entry.misses < UINT8_MAX) entry.misses++;
+    if (!entry.answered && !entry.dead && entry.misses >= Probe_Attempts && probe_answering_ > 0) {
+      entry.dead = true;
+      probe_dead_++;
+      probe_generation_++;
+      ESP_LOGW("ESPoeDaikin", "Registry 0x%02X does not answer, dropped from the schedule; asked again every %u min", entry.registry_id,
+               (unsigned)(reprobe_interval_ms_ / 60000));
+    }
+  }
+  if (!known && (entry.answered || entry.dead) && --probe_pending_ == 0) this->log_probe_results_();
+}
 
-        MyDaikinPackage.buffer_mut().push_back(incomingByte);
+// First answer of the registry, or one of another size than before: its registers must lie within the frame
+void DaikinX10A::check_frame_shape_(PollEntry &entry, const daikin_package &pkg) {
+  if (entry.frame_size == pkg.size()) return;
+  entry.frame_size = static_cast<uint16_t>(pkg.size());
+  entry.short_frame = false;
+  const RegistrySpan &span = registry_spans_[entry.registry_id];
+  for (uint16_t i = span.first; i < span.first + span.count; i++) {
+    const DecodeStep &step = decode_plan_[i];
+    if (step.end <= pkg.size()) continue;
+    const RegisterDef &def = register_table_[step.register_index];
+    ESP_LOGW("ESPoeDaikin", "Registry 0x%02X has %u data bytes, register '%s' (offset %u, %u bytes) lies past its end",
+             entry.registry_id, (unsigned)(pkg.size() - pkg.data_offset() - 1), def.label, def.offset, def.dataSize);
+    entry.short_frame = true;
+  }
+  probe_generation_++;
+}
 
-        // Once we have 2 bytes, check if it's the right registry
-        if (MyDaikinPackage.size() == 2) {
-          uint8_t received_registry = MyDaikinPackage.buffer()[1];
-          if (received_registry != target_registry) {
-            // Wrong registry - discard this packet and wait for the right one
-            if (debug_mode_) ESP_LOGI("ESPoeDaikin", "  Received registry 0x%02X (expected 0x%02X), discarding...", received_registry, target_registry);
-            MyDaikinPackage.clear();
-            continue;
-          }
+void DaikinX10A::log_probe_results_() {
+  probe_generation_++;
+  ESP_LOGI("ESPoeDaikin", "Registry probe: %u of %u registries answer", (unsigned)probe_answering_, (unsigned)poll_schedule_.size());
+  for (const auto &entry : poll_schedule_) {
+    if (entry.dead) {
+      ESP_LOGI("ESPoeDaikin", "  0x%02X: no answer", entry.registry_id);
+    } else {
+      ESP_LOGI("ESPoeDaikin", "  0x%02X: %u bytes, latency %.1f ms%s", entry.registry_id, (unsigned)entry.frame_size,
+               entry.latency_us / 1000.0f, entry.short_frame ? ", registers past the end" : "");
+    }
+  }
+}
+//________________________________________________________________ registry probe end
+
+//__________________________________________________________________________________________________________________________ poll_uart_ begin
+// Advances the request/response state machine. Called from every loop(); returns as soon as a request is in flight and the UART has no
+// more bytes. A completed frame is followed by the next due request in the same call, so the bus does not idle until the next loop()
+void DaikinX10A::poll_uart_() {
+  for (;;) {
+    switch (poll_state_) {
+      case PollState::IDLE: {
+        const uint32_t now = millis();
+        active_entry_ = this->next_due_entry_(now);
+        if (active_entry_ == nullptr) {
+          if (sweep_active_) last_sweep_ms_ = now - sweep_start_ms_;
+          sweep_active_ = false;
+          return;
         }
+        if (!sweep_active_) sweep_start_ms_ = now;
+        sweep_active_ = true;
+        poll_state_ = PollState::SEND;
+        break;
+      }
 
-        // Once we have 3 bytes, we know the full length
-        if (MyDaikinPackage.HasMinimalHeader()) {
-          const size_t expectedSize = MyDaikinPackage.expected_size();
-          if (expectedSize > 0) IncommingPackageSize = expectedSize;
+      case PollState::SEND:
+        this->send_request_(active_entry_->registry_id);
+        poll_state_ = PollState::AWAIT_HEADER;
+        return;
+
+      case PollState::AWAIT_HEADER:
+      case PollState::AWAIT_BODY: {
+        this->receive_bytes_();
+        if (poll_state_ != PollState::AWAIT_HEADER && poll_state_ != PollState::AWAIT_BODY) break;
+        const uint32_t now_us = micros();
+        if ((int32_t)(now_us - deadline_us_) < 0) return;
+
+        // Deadline passed with bytes still buffered: the candidate was a stray 0x40 or a truncated frame. Slide past it and rescan
+        if (rx_decoder_.buffered() > 0 && (int32_t)(now_us - hard_deadline_us_) < 0) {
+          rx_decoder_.resync();
+          poll_state_ = PollState::AWAIT_HEADER;
+          deadline_us_ = now_us + Serial_InterByteMarginUs;
+          break;
         }
+        poll_state_ = PollState::TIMEOUT;
+        break;
+      }
 
-        // Early error detection
-        if (MyDaikinPackage.is_error_frame()) {
-          if (debug_mode_) ESP_LOGI("ESPoeDaikin", "HP returned error frame: %s", MyDaikinPackage.ToHexString().c_str());
-          return;
+      case PollState::TIMEOUT:
+        this->finish_request_();
+        break;
+    }
+  }
+}
+//________________________________________________________________ poll_uart_ end
+
+//__________________________________________________________________________________________________________________________ send_request_ begin
+void DaikinX10A::send_request_(uint8_t registry_id) {
+  auto MyDaikinRequestPackage = daikin_package::MakeRequest(registry_id);
+
+  if (debug_mode_) {
+    char hex[daikin_package::HEX_BUFFER_SIZE];
+    ESP_LOGI("ESPoeDaikin", "TX (%u): %s", (unsigned)MyDaikinRequestPackage.size(), MyDaikinRequestPackage.to_hex(hex, sizeof(hex)));
+  }
+
+  // Bytes still buffered (e.g. a response that arrived after its deadline) stay in rx_decoder_: it decodes them as whatever registry they are
+  this->write_array(MyDaikinRequestPackage.data(), MyDaikinRequestPackage.size());
+#ifdef USE_DAIKIN_X10A_TELEMETRY
+  this->telemetry_record_(daikin_telemetry_buffer::Record::REQUEST, MyDaikinRequestPackage.data(), MyDaikinRequestPackage.size());
+#endif
+
+  rx_package_.clear();
+  request_start_ms_ = millis();
+  request_sent_us_ = micros() + (uint32_t)MyDaikinRequestPackage.size() * byte_time_us_;
+  deadline_us_ = request_sent_us_ + this->response_allowance_us_(*active_entry_) + 3 * byte_time_us_;
+  // With the registry's frame size known from an earlier answer a resync gives up once that frame could have arrived
+  const size_t frame_size = active_entry_->frame_size != 0 ? active_entry_->frame_size : daikin_package::MAX_FRAME_SIZE;
+  hard_deadline_us_ = deadline_us_ + frame_size * byte_time_us_ + Serial_InterByteMarginUs;
+}
+
+// Time the HP may take to start answering: three times its measured latency, within [50ms, Serial_TimeoutInMilliseconds]
+uint32_t DaikinX10A::response_allowance_us_(const PollEntry &entry) const {
+  const uint32_t max_us = Serial_TimeoutInMilliseconds * 1000UL;
+  if (entry.latency_us == 0) return max_us;
+  return std::min(max_us, std::max(Serial_MinResponseAllowanceUs, 3 * entry.latency_us));
+}
+//________________________________________________________________ send_request_ end
+
+//__________________________________________________________________________________________________________________________ receive_bytes_ begin
+// Moves whatever the UART has buffered (at most Serial_MaxBytesPerLoop bytes) into rx_decoder_ with one read, then takes complete frames
+// out of it. Neither step allocates: both buffers have a fixed size
+void DaikinX10A::receive_bytes_() {
+  PollEntry &entry = *active_entry_;
+
+  uint8_t chunk[Serial_MaxBytesPerLoop];
+  const int available = this->available();
+  size_t count = available > 0 ? std::min<size_t>((size_t)available, sizeof(chunk)) : 0;
+  count = std::min(count, rx_decoder_.free());
+  if (count > 0 && this->read_array(chunk, count)) {
+    rx_decoder_.feed(chunk, count);
+    bytes_received_ += count;
+  }
+
+  for (;;) {
+    switch (rx_decoder_.next(rx_package_)) {
+      case daikin_stream_decoder<512>::Result::NEED_MORE:
+        // Once our header is in, we know how many bytes are still to come and with it when the last one is due
+        if (poll_state_ == PollState::AWAIT_HEADER && rx_decoder_.candidate_registry() == entry.registry_id) {
+          const size_t expectedSize = rx_decoder_.candidate_size();
+          if (expectedSize == 0) return;
+          const size_t buffered = rx_decoder_.buffered();
+          const uint32_t remaining = expectedSize > buffered ? (uint32_t)(expectedSize - buffered) : 0;
+          deadline_us_ = micros() + remaining * byte_time_us_ + Serial_InterByteMarginUs;
+          poll_state_ = PollState::AWAIT_BODY;
         }
+        return;
+
+      case daikin_stream_decoder<512>::Result::ERROR_FRAME:
+        // The HP rejected this request; only this registry is skipped, the others are still requested
+        if (debug_mode_) ESP_LOGI("ESPoeDaikin", "HP returned error frame for registry 0x%02X", entry.registry_id);
+        error_frames_++;
+        rx_package_.clear();
+        this->reschedule_(entry, false, false);
+        active_entry_ = nullptr;
+        poll_state_ = PollState::IDLE;
+        return;
+
+      case daikin_stream_decoder<512>::Result::FRAME:
+        if (rx_package_.registry_id() != entry.registry_id) {
+          this->accept_other_frame_();
+          continue;
+        }
+        {
+          // Round trip up to the CRC byte; the first-byte latency is what remains after the frame's own time on the wire
+          const uint32_t rtt = micros() - request_sent_us_;
+          const uint32_t wire = (uint32_t)rx_package_.size() * byte_time_us_;
+          const uint32_t latency = rtt > wire ? rtt - wire : 1;
+          entry.rtt_us = rtt;
+          entry.latency_us = (entry.latency_us == 0) ? latency : (entry.latency_us * 7 + latency) / 8;
+#ifdef USE_DAIKIN_X10A_DIAGNOSTICS
+          record_round_trip_(entry.round_trips, rtt);
+#endif
+        }
+        this->finish_request_();
+        return;
+    }
+  }
+}
 
-        // Check if we have complete packet
-        if (MyDaikinPackage.size() >= IncommingPackageSize) break;
-      }
+// A valid frame for another registry than the one requested (late answer, interleaved traffic): decode it rather than throw it away,
+// and count it as a poll of that registry if it is on the schedule
+void DaikinX10A::accept_other_frame_() {
+  const uint8_t registry_id = rx_package_.registry_id();
+  wrong_registry_frames_++;
+  if (debug_mode_) ESP_LOGI("ESPoeDaikin", "  Received registry 0x%02X while waiting for 0x%02X, decoding it", registry_id, active_entry_->registry_id);
+
+  const bool changed = this->process_frame_(rx_package_);
+  PollEntry *other = this->entry_for_(registry_id);
+  if (other != nullptr && other != active_entry_) this->reschedule_(*other, true, changed);
+  rx_package_.clear();
+}
+//________________________________________________________________ receive_bytes_ end
+
+//__________________________________________________________________________________________________________________________ finish_request_ begin
+// Called once per request, either with a complete packet or after its receive deadline; reschedules the registry
+void DaikinX10A::finish_request_() {
+  PollEntry &entry = *active_entry_;
+  active_entry_ = nullptr;
+  poll_state_ = PollState::IDLE;
+
+  // rx_decoder_ only hands out checksum-valid frames, so an empty package means nothing usable arrived in time
+  if (rx_package_.empty()) {
+    if (debug_mode_) ESP_LOGI("ESPoeDaikin", "No valid response for registry 0x%02X (timeout, %u CRC mismatches so far)",
+                              entry.registry_id, (unsigned)rx_decoder_.crc_mismatches());
+    timeouts_++;
+    this->reschedule_(entry, false, false);
+    return;
+  }
 
-      if (MyDaikinPackage.empty()) {
-        if (debug_mode_) ESP_LOGI("ESPoeDaikin", "No valid response for registry 0x%02X (timeout)", target_registry);
-        continue;
-      }
+  if (debug_mode_) {
+    char hex[daikin_package::HEX_BUFFER_SIZE];
+    ESP_LOGI("ESPoeDaikin", "MyDaikinPackage (%u, rtt %uus, latency %uus): %s", (unsigned)rx_package_.size(),
+             (unsigned)entry.rtt_us, (unsigned)entry.latency_us, rx_package_.to_hex(hex, sizeof(hex)));
+  }
+  last_requested_registry_ = entry.registry_id;
+  this->check_frame_shape_(entry, rx_package_);
+  const bool changed = this->process_frame_(rx_package_);
+  this->reschedule_(entry, true, changed);
+}
+//________________________________________________________________ finish_request_ end
+
+//__________________________________________________________________________________________________________________________ uart task begin
+#ifdef USE_ESP32
+TaskHandle_t DaikinX10A::uart_task_handle_{nullptr};
+std::array<DaikinX10A *, DaikinX10A::MAX_TASK_INSTANCES> DaikinX10A::task_instances_{};
+std::atomic<uint8_t> DaikinX10A::task_instance_count_{0};
+#endif
+
+// Called from loop() once polling starts. The first instance creates the task, later ones join it; the task only sees an instance
+// once it is complete, task_instance_count_ publishes it
+void DaikinX10A::start_uart_task_() {
+#ifdef USE_ESP32
+  const uint8_t index = task_instance_count_.load(std::memory_order_relaxed);
+  if (index < MAX_TASK_INSTANCES) {
+    task_instances_[index] = this;
+    task_running_ = true;
+    // loop() runs on the calling core; the transfer engine gets the other one when there is one
+    const BaseType_t core = (portNUM_PROCESSORS > 1) ? (xPortGetCoreID() == 0 ? 1 : 0) : tskNO_AFFINITY;
+    if (uart_task_handle_ != nullptr ||
+        xTaskCreatePinnedToCore(&DaikinX10A::uart_task_main_, "daikin_x10a", UartTask_StackSize, nullptr, UartTask_Priority,
+                                &uart_task_handle_, core) == pdPASS) {
+      task_instance_count_.store(index + 1, std::memory_order_release);
+      ESP_LOGI("ESPoeDaikin", "%s polls on the UART task (core %d), instance %u of the task", instance_name_, (int)core,
+               (unsigned)index + 1);
+      return;
+    }
+    task_running_ = false;
+  }
+#endif
+  ESP_LOGW("ESPoeDaikin", "%s could not start the UART task, polling from loop()", instance_name_);
+}
 
-      if (!MyDaikinPackage.Valid_CRC()) {
-        if (debug_mode_) ESP_LOGI("ESPoeDaikin", "CRC mismatch (%u): %s", (unsigned)MyDaikinPackage.size(), MyDaikinPackage.ToHexString().c_str());
-        continue;
-      }
+#ifdef USE_ESP32
+void DaikinX10A::uart_task_main_(void *) {
+  for (;;) {
+    // Round robin: every poll step is non-blocking, so one heat pump waiting for its answer never holds up another
+    const uint8_t count = task_instance_count_.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < count; i++) task_instances_[i]->task_step_();
+    vTaskDelay(1);
+  }
+}
 
-      if (debug_mode_) ESP_LOGI("ESPoeDaikin", "MyDaikinPackage (%u): %s", (unsigned)MyDaikinPackage.size(), MyDaikinPackage.ToHexString().c_str());
-      last_requested_registry_ = selectedRegister.registryID;
-      this->process_frame_(MyDaikinPackage);
-    } // if mode==1
+void DaikinX10A::task_step_() {
+  this->serve_task_requests_();
+  this->poll_uart_();
+#ifdef USE_DAIKIN_X10A_TELEMETRY
+  this->telemetry_poll_();
+#endif
+}
+#endif
 
-  } //____________________________________ end for loop loop over all registers
-  
+// Runs on the UART task before every poll step: what loop() asked for of the state the task owns
+void DaikinX10A::serve_task_requests_() {
+  if (fetch_requested_.exchange(false)) this->make_all_due_();
+  if (queued_changed_.exchange(false)) {
+    for (auto &cache : registry_cache_) cache.refresh = true;
+  }
+#ifdef USE_DAIKIN_X10A_WARM_START
+  // loop() asks for one registry at a time; registry_cache_ is only consistent here, between two polls
+  const uint16_t fill = warm_fill_request_.load(std::memory_order_acquire);
+  if (fill != 0) {
+    this->warm_start_fill_(fill - 1);
+    warm_fill_request_.store(0, std::memory_order_release);
+  }
+#endif
 }
-//________________________________________________________________ FetchRegisters end
+
+// Called from loop() only. The first time something reads a register while the task runs, the task decodes the next frame of every
+// registry once more, identical or not, so the value arrives without waiting for the registry to change
+void DaikinX10A::queue_register_(RegisterHandle handle) {
+  if (handle >= register_steps_.size() || register_steps_[handle] == NO_STEP) return;
+  DecodeStep &step = decode_plan_[register_steps_[handle]];
+  if (step.queued) return;
+  step.queued = true;
+  if (task_running_) queued_changed_.store(true);
+}
+
+// Runs on the UART task. Decodes the registers loop() reads into a scratch update, a text into the update itself, so register_states_
+// are never written from here. Never waits for loop(): a value that does not fit is counted and dropped, and false makes
+// process_frame_() decode the next frame of the registry again
+bool DaikinX10A::queue_registry_values_(const daikin_package &pkg, const RegistrySpan &span, bool force) {
+  const uint8_t *frame = pkg.data();
+  const size_t frame_size = pkg.size();
+  bool telemetry = false;
+#ifdef USE_DAIKIN_X10A_TELEMETRY
+  telemetry = telemetry_values_;
+#endif
+
+  bool complete = true;
+  RegisterUpdate update{};
+  update.force = force;
+  for (uint16_t i = span.first; i < span.first + span.count; i++) {
+    const DecodeStep &step = decode_plan_[i];
+    const bool queued = step.queued || debug_mode_;
+    if (step.end > frame_size || (!queued && !telemetry)) continue;
+
+    RegisterState scratch;
+    scratch.text = update.text;
+    step.convert(register_table_[step.register_index], scratch, frame + step.start);
+    if (scratch.value.kind == RegisterValue::Kind::NONE) continue;
+
+#ifdef USE_DAIKIN_X10A_TELEMETRY
+    if (telemetry) this->telemetry_value_(step.register_index, scratch.value);
+#endif
+    if (!queued) continue;
+    update.step_index = i;
+    update.value = scratch.value;
+    if (!updates_.push(update)) {
+      updates_dropped_++;
+      complete = false;
+    }
+  }
+  return complete;
+}
+
+// Runs in loop(): applies what the UART task decoded and publishes it, with the same change detection as the single-threaded path
+void DaikinX10A::drain_updates_() {
+  RegisterUpdate update;
+  while (updates_.pop(&update)) {
+    const DecodeStep &step = decode_plan_[update.step_index];
+    const RegisterDef &def = register_table_[step.register_index];
+    RegisterState &state = register_states_[step.register_index];
+    state.value = update.value;
+    if (update.value.kind == RegisterValue::Kind::TEXT) std::memcpy(state.text, update.text, std::strlen(update.text) + 1);
+#ifdef USE_DAIKIN_X10A_DERIVED
+    this->mark_derived_(def.registryID, true);
+#endif
+#ifdef USE_DAIKIN_X10A_HISTORY
+    this->history_mark_(def.registryID);
+#endif
+    if (debug_mode_) {
+      char text[32];
+      format_value_(def, state, text, sizeof(text));
+      ESP_LOGI("ESPoeDaikin", "0x%02X | %s = %s", def.registryID, def.label, text);
+    }
+    if (def.Mode == 1) publish_register_(step, state, update.force);
+  }
+}
+//________________________________________________________________ uart task end
+
+//__________________________________________________________________________________________________________________________ replay_hex begin
+// Every two-digit hex token is one byte, anything else (log prefixes, lengths, timings) is skipped. Uses its own decoder, so a replay
+// never mixes with a request that is in flight
+int DaikinX10A::replay_hex(const std::string &hex) {
+  if (task_running_) {
+    ESP_LOGW("ESPoeDaikin", "replay_hex() is not available while the UART task is running");
+    return 0;
+  }
+  daikin_stream_decoder<512> decoder;
+  daikin_package frame(daikin_package::Mode::RECEIVE);
+  int frames = 0;
+
+  auto nibble = [](char c) -> int {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+  };
+  auto drain = [&]() {
+    for (;;) {
+      auto result = decoder.next(frame);
+      if (result == daikin_stream_decoder<512>::Result::NEED_MORE) return;
+      if (result != daikin_stream_decoder<512>::Result::FRAME) continue;
+      this->process_frame_(frame);
+      frames++;
+    }
+  };
+
+  size_t i = 0;
+  while (i < hex.size()) {
+    while (i < hex.size() && std::isspace((unsigned char)hex[i])) i++;
+    const size_t start = i;
+    while (i < hex.size() && !std::isspace((unsigned char)hex[i])) i++;
+    if (i - start != 2) continue;
+    const int hi = nibble(hex[start]), lo = nibble(hex[start + 1]);
+    if (hi < 0 || lo < 0) continue;
+
+    const uint8_t byte = (uint8_t)((hi << 4) | lo);
+    if (decoder.feed(&byte, 1) == 0) {
+      drain();
+      decoder.feed(&byte, 1);
+    }
+  }
+  drain();
+  // End of the capture acts like a receive deadline: whatever candidate is still incomplete was not a real frame
+  while (decoder.buffered() > 0) {
+    decoder.resync();
+    drain();
+  }
+
+  ESP_LOGI("ESPoeDaikin", "Replayed %d frames (%u CRC mismatches)", frames, (unsigned)decoder.crc_mismatches());
+  return frames;
+}
+//________________________________________________________________ replay_hex end
 
 //__________________________________________________________________________________________________________________________ process_frame_ begin
-void DaikinX10A::process_frame_(daikin_package &pkg) {
-  if (!pkg.is_valid_protocol() || !pkg.Valid_CRC() || pkg.is_error_frame()) return;
+// Returns false when the frame was rejected or byte-identical to the previous frame of its registry
+bool DaikinX10A::process_frame_(daikin_package &pkg) {
+  if (!pkg.is_valid_protocol() || !pkg.Valid_CRC() || pkg.is_error_frame()) return false;
 
-  const auto &buffer = pkg.buffer();
-  if (buffer.size() < 6) return;
+  if (pkg.size() < 6) return false;
+#ifdef USE_DAIKIN_X10A_TELEMETRY
+  this->telemetry_record_(daikin_telemetry_buffer::Record::FRAME, pkg.data(), pkg.size());
+#endif
 
   // Registry ID is at byte 1
-  uint8_t registry_id = buffer[1];
+  uint8_t registry_id = pkg.registry_id();
 
   if (debug_mode_) ESP_LOGI("ESPoeDaikin", "Decode registry_id=%d (0x%02X), protocol_header=3_bytes (0x40, regID, length), data_starts_at_byte_3", (int)registry_id, registry_id);
 
-  convert_registry_values_(pkg, registry_id);
+  const RegistrySpan &span = registry_spans_[registry_id];
+  if (span.cache == NO_CACHE) return false;
+
+  // Skip decode and publish entirely when the HP sent exactly the same bytes as last time, unless the heartbeat is due
+  RegistryCache &cache = registry_cache_[span.cache];
+#ifdef USE_DAIKIN_X10A_WARM_START
+  if (cache.stale) {
+    cache.stale = false;
+    warm_stale_count_--;
+  }
+#endif
+  const uint32_t now = millis();
+  const bool heartbeat = !cache.valid || (publish_max_age_ms_ != 0 && now - cache.last_publish_ms >= publish_max_age_ms_);
+  const bool identical = cache.valid && cache.frame.size() == pkg.size() &&
+                         std::memcmp(cache.frame.data(), pkg.data(), pkg.size()) == 0;
+#ifdef USE_DAIKIN_X10A_DERIVED
+  this->mark_derived_(registry_id, !identical);  // identical frames too: every poll is a sample for the integrals
+#endif
+  if (identical && !heartbeat && !cache.refresh) {
+    frames_skipped_++;
+    if (debug_mode_) ESP_LOGI("ESPoeDaikin", "Registry 0x%02X unchanged, skipping decode", registry_id);
+    return false;
+  }
+  cache.frame.assign(pkg.data(), pkg.data() + pkg.size());  // reuses its capacity once the registry's frame size is known
+  cache.generation++;
+  cache.valid = true;
+  if (heartbeat) cache.last_publish_ms = now;
+#ifdef USE_DAIKIN_X10A_WARM_START
+  if (!identical) cache.dirty = true;
+#endif
+
+  if (task_running_) {
+    // register_states_ belong to loop() in this mode: hand the values over, loop() logs and publishes them
+    cache.refresh = !this->queue_registry_values_(pkg, span, heartbeat);
+    return !identical;
+  }
+  this->decode_registry_(pkg, span, heartbeat);
+  return !identical;
+}
 
-  // log alle regels die bij deze registry horen (en non-empty asString hebben)
+// Decodes the eager registers of the registry into register_states_ and publishes the Mode==1 ones; returns the number of values
+// decoded. The Mode 0 registers wait in registry_cache_ until something reads them, unless the debug log or telemetry wants every value.
+// Also used for the frames restored at boot
+int DaikinX10A::decode_registry_(const daikin_package &pkg, const RegistrySpan &span, bool force) {
+  const uint8_t registry_id = pkg.registry_id();
+  const bool all = this->decode_all_();
+  convert_registry_values_(pkg, span, all);
+#ifdef USE_DAIKIN_X10A_HISTORY
+  this->history_mark_(registry_id);
+#endif
+
+  // log alle regels die bij deze registry horen (en een waarde hebben)
   int count = 0;
-  for (auto &registerEntry : registers_) {
-    if ((uint8_t)registerEntry.registryID != registry_id) continue;
-    if (registerEntry.asString[0] == '\0') continue;
-    if (debug_mode_) ESP_LOGI("ESPoeDaikin", "0x%02X | %s = %s", registry_id, registerEntry.label, registerEntry.asString);
-
-    // AUTO-UPDATE DYNAMIC SENSORS for mode=1 registers
-    // Try text sensor first, then numeric sensor (based on convid, the right one will exist)
-    if (registerEntry.Mode == 1) {
-      if (!update_text_sensor(registerEntry.label, std::string(registerEntry.asString))) {
-        float value = std::atof(registerEntry.asString);
-        update_sensor(registerEntry.label, value);
-      }
+  const uint16_t end = span.first + (all ? span.count : span.eager);
+  for (uint16_t i = span.first; i < end; i++) {
+    const DecodeStep &step = decode_plan_[i];
+    const RegisterDef &def = register_table_[step.register_index];
+    RegisterState &state = register_states_[step.register_index];
+    if (state.value.kind == RegisterValue::Kind::NONE) continue;
+    if (debug_mode_) {
+      char text[32];
+      format_value_(def, state, text, sizeof(text));
+      ESP_LOGI("ESPoeDaikin", "0x%02X | %s = %s", registry_id, def.label, text);
     }
 
+    // AUTO-UPDATE DYNAMIC SENSORS for mode=1 registers (bound to their sensor in compile_registers_())
+    if (def.Mode == 1) publish_register_(step, state, force);
+
+#ifdef USE_DAIKIN_X10A_TELEMETRY
+    if (telemetry_values_) this->telemetry_value_(step.register_index, state.value);
+#endif
     count++;
   }
 
   if (debug_mode_) ESP_LOGI("ESPoeDaikin", "Decoded %d values for registry 0x%02X", count, registry_id);
+  return count;
+}
+
+// Also with the UART task: decode_on_demand_() cannot reach registry_cache_ then, so a frame restored at boot is decoded in full. The
+// task itself hands over only what queue_register_() asked for
+bool DaikinX10A::decode_all_() const {
+  if (uart_task_) return true;
+#ifdef USE_DAIKIN_X10A_TELEMETRY
+  if (telemetry_values_) return true;
+#endif
+  return debug_mode_;
+}
+
+// Mode 0 registers are decoded from the last frame of their registry the first time they are read after that frame arrived. With the
+// UART task registry_cache_ belongs to the task: a register that is read arrives decoded through updates_ instead, from the next frame
+void DaikinX10A::decode_on_demand_(RegisterHandle handle) {
+  if (task_running_) {
+    this->queue_register_(handle);
+    return;
+  }
+  if (handle >= register_steps_.size() || register_steps_[handle] == NO_STEP) return;
+  const uint16_t index = register_steps_[handle];
+  const RegisterDef &def = register_table_[handle];
+  const RegistrySpan &span = registry_spans_[def.registryID];
+  if (index < span.first + span.eager) return;
+
+  const RegistryCache &cache = registry_cache_[span.cache];
+  RegisterState &state = register_states_[handle];
+  if (state.decoded_at == cache.generation) return;
+  state.decoded_at = cache.generation;
+  const DecodeStep &step = decode_plan_[index];
+  if (step.end <= cache.frame.size()) step.convert(def, state, cache.frame.data() + step.start);
 }
 //________________________________________________________________ process_frame_ end
 
-//__________________________________________________________________________________________________________________________ add_register begin
-void DaikinX10A::add_register(int mode, int convid, int offset, int registryID,
-                             int dataSize, int dataType, const char* label) {
-  registers_.emplace_back(mode, convid, offset, registryID, dataSize, dataType, label);
+//__________________________________________________________________________________________________________________________ publish_register_ begin
+// Numeric sensors get the decoded float as-is; text is only rendered for text sensors. Unchanged values are only sent when forced (heartbeat)
+void DaikinX10A::publish_register_(const DecodeStep &step, RegisterState &state, bool force) {
+  if (step.text_sensor == nullptr && step.sensor == nullptr) return;
+  const RegisterDef &def = register_table_[step.register_index];
+  if (!force && !value_changed_(def, state)) {
+    publishes_suppressed_++;
+    return;
+  }
+  state.published = state.value;
+  if (state.value.kind == RegisterValue::Kind::TEXT) std::memcpy(state.text + REGISTER_TEXT_SIZE, state.text, REGISTER_TEXT_SIZE);
+
+  if (step.text_sensor != nullptr) {
+    char text[32];
+    format_value_(def, state, text, sizeof(text));
+    step.text_sensor->publish_state(text);
+    ESP_LOGV("ESPoeDaikin", "Updated text sensor '%s' = %s", def.label, text);
+  } else {
+    const float value = (state.value.kind == RegisterValue::Kind::NUMBER) ? state.value.number : NAN;
+    step.sensor->publish_state(value);
+    ESP_LOGV("ESPoeDaikin", "Updated sensor '%s' = %.1f", def.label, value);
+  }
 }
-//________________________________________________________________ add_register end
 
-//__________________________________________________________________________________________________________________________ get_register_value begin
-std::string DaikinX10A::get_register_value(const std::string& label) const {
-  for (const auto &reg : registers_) {
-    if (reg.label && reg.label == label && reg.asString[0] != '\0') {
-      return std::string(reg.asString);
+// A number has changed once it moved more than the absolute deadband or the relative deadband (of the last published value), whichever
+// is larger. Lookup tables and texts are compared by what the sensor shows: a bit flag shares its byte with other flags, a text its
+// frame with other registers
+bool DaikinX10A::value_changed_(const RegisterDef &def, const RegisterState &state) const {
+  const RegisterValue &now = state.value;
+  const RegisterValue &last = state.published;
+  if (now.kind != last.kind) return true;
+
+  switch (now.kind) {
+    case RegisterValue::Kind::NUMBER: {
+      if (std::isnan(now.number) || std::isnan(last.number)) return std::isnan(now.number) != std::isnan(last.number);
+      const float threshold = std::max(publish_deadband_, publish_deadband_fraction_ * std::fabs(last.number));
+      return std::fabs(now.number - last.number) > threshold;
+    }
+    case RegisterValue::Kind::ENUM: {
+      if (now.raw == last.raw) return false;
+      RegisterState before = state;
+      before.value = last;
+      char text_now[32], text_before[32];
+      format_value_(def, state, text_now, sizeof(text_now));
+      format_value_(def, before, text_before, sizeof(text_before));
+      return std::strcmp(text_now, text_before) != 0;
     }
+    case RegisterValue::Kind::TEXT:
+      return std::strcmp(state.text, state.text + REGISTER_TEXT_SIZE) != 0;
+    default:
+      return false;
   }
-  return "";  // Return empty string if register not found or value is empty
 }
-//________________________________________________________________ get_register_value end
+//________________________________________________________________ publish_register_ end
+
+//__________________________________________________________________________________________________________________________ compile_registers_ begin
+// Cuts the register table into one decode_plan_ slice per registryID and fixes the poll list. Runs once; after this no frame scans the
+// full register table. The table comes sorted by registryID from __init__.py, so every registry is already one contiguous run of rows
+void DaikinX10A::compile_registers_() {
+  decode_plan_.clear();
+  poll_schedule_.clear();
+  registry_spans_.fill(RegistrySpan{});
+
+  register_states_.assign(register_count_, RegisterState{});
+  size_t text_registers = 0;
+  for (uint16_t i = 0; i < register_count_; i++) {
+    if (register_table_[i].convid == 100) text_registers++;
+  }
+  register_text_.assign(text_registers * 2 * REGISTER_TEXT_SIZE, '\0');
+  decode_plan_.reserve(register_count_);
+  register_steps_.assign(register_count_, NO_STEP);
+
+  const unsigned data_offset = daikin_package(daikin_package::Mode::RECEIVE).data_offset();
+  std::array<bool, 256> polled{};
+  size_t next_text = 0;
+  for (uint16_t i = 0; i < register_count_; i++) {
+    const RegisterDef &reg = register_table_[i];
+    const uint8_t registry_id = reg.registryID;
+
+    if (reg.Mode >= 1 && !polled[registry_id]) {
+      polled[registry_id] = true;
+      PollEntry entry;
+      entry.registry_id = registry_id;
+      entry.interval_ms = scan_interval_ms_;
+      for (const auto &config : schedule_config_) {
+        if (config.registry_id != registry_id) continue;
+        entry.interval_ms = config.interval_ms;
+        entry.priority = config.priority;
+      }
+      poll_schedule_.push_back(entry);
+    }
+
+    if (reg.convid == 100) {
+      register_states_[i].text = &register_text_[next_text];
+      next_text += 2 * REGISTER_TEXT_SIZE;
+    }
+
+    ConvertFn convert = select_converter_(reg);
+    if (convert == nullptr) continue;
+
+    RegistrySpan &span = registry_spans_[registry_id];
+    if (span.count == 0) span.first = static_cast<uint16_t>(decode_plan_.size());
+    span.count++;
+
+    DecodeStep step;
+    step.register_index = i;
+    step.start = static_cast<uint16_t>(data_offset + reg.offset);
+    step.end = static_cast<uint16_t>(step.start + reg.dataSize);
+    step.convert = convert;
+    step.sensor = nullptr;
+    step.text_sensor = nullptr;
+    step.queued = false;
+    register_steps_[i] = static_cast<uint16_t>(decode_plan_.size());
+    decode_plan_.push_back(step);
+  }
+
+  // Mode==1 steps first in every registry, in table order: only those are decoded with every frame
+  size_t eager = 0;
+  for (auto &span : registry_spans_) {
+    if (span.count == 0) continue;
+    const auto first = decode_plan_.begin() + span.first;
+    const auto middle = std::stable_partition(first, first + span.count, [this](const DecodeStep &step) {
+      return register_table_[step.register_index].Mode == 1;
+    });
+    span.eager = static_cast<uint16_t>(middle - first);
+    for (uint16_t i = span.first; i < span.first + span.count; i++) register_steps_[decode_plan_[i].register_index] = i;
+  }
+
+  probe_pending_ = static_cast<uint16_t>(poll_schedule_.size());
+  probe_answering_ = probe_dead_ = 0;
+
+  for (const auto &binding : sensor_bindings_) this->attach_binding_(binding);
+  sensor_bindings_.clear();
+  sensor_bindings_.shrink_to_fit();
+
+  registry_cache_.clear();
+  for (auto &span : registry_spans_) {
+    if (span.count == 0) continue;
+    span.cache = static_cast<uint16_t>(registry_cache_.size());
+    registry_cache_.emplace_back();
+    eager += span.eager;
+  }
 
-//__________________________________________________________________________________________________________________________ register_dynamic_sensor begin
-void DaikinX10A::register_dynamic_sensor(const std::string& label, sensor::Sensor *sens) {
-  dynamic_sensors_[label] = sens;
-  ESP_LOGI("ESPoeDaikin", "Registered dynamic sensor: %s", label.c_str());
+  ESP_LOGI("ESPoeDaikin", "Compiled %u registers into %u decode steps (%u decoded with every frame), polling %u registries",
+           (unsigned)register_count_, (unsigned)decode_plan_.size(), (unsigned)eager, (unsigned)poll_schedule_.size());
 }
-//________________________________________________________________ register_dynamic_sensor end
 
-//__________________________________________________________________________________________________________________________ update_sensor begin
-void DaikinX10A::update_sensor(const std::string& label, float value) {
-  auto it = dynamic_sensors_.find(label);
-  if (it != dynamic_sensors_.end() && it->second != nullptr) {
-    it->second->publish_state(value);
-    ESP_LOGV("ESPoeDaikin", "Updated sensor '%s' = %.1f", label.c_str(), value);
+//________________________________________________________________ compile_registers_ end
+
+//__________________________________________________________________________________________________________________________ register handles begin
+// Linear scan of the table; meant to run once per label, after which everything goes by handle
+DaikinX10A::RegisterHandle DaikinX10A::find_register(const char *label) const {
+  if (label == nullptr) return NO_REGISTER;
+  for (uint16_t i = 0; i < register_count_; i++) {
+    if (register_table_[i].label != nullptr && std::strcmp(register_table_[i].label, label) == 0) return i;
   }
+  ESP_LOGW("ESPoeDaikin", "No register labelled '%s'", label);
+  return NO_REGISTER;
 }
-//________________________________________________________________ update_sensor end
 
-void DaikinX10A::register_dynamic_text_sensor(const std::string& label, text_sensor::TextSensor *sens) {
-  dynamic_text_sensors_[label] = sens;
-  ESP_LOGI("ESPoeDaikin", "Registered dynamic text sensor: %s", label.c_str());
+float DaikinX10A::get_register_float(RegisterHandle handle) {
+  if (handle >= register_states_.size()) return NAN;
+  this->decode_on_demand_(handle);
+  const RegisterValue &value = register_states_[handle].value;
+  return (value.kind == RegisterValue::Kind::NUMBER) ? value.number : NAN;
 }
 
-bool DaikinX10A::update_text_sensor(const std::string& label, const std::string& value) {
-  auto it = dynamic_text_sensors_.find(label);
-  if (it != dynamic_text_sensors_.end() && it->second != nullptr) {
-    it->second->publish_state(value);
-    ESP_LOGV("ESPoeDaikin", "Updated text sensor '%s' = %s", label.c_str(), value.c_str());
-    return true;
+const char *DaikinX10A::get_register_text(RegisterHandle handle) {
+  if (handle >= register_states_.size()) return "";
+  this->decode_on_demand_(handle);
+  format_value_(register_table_[handle], register_states_[handle], text_buffer_, sizeof(text_buffer_));
+  return text_buffer_;
+}
+//________________________________________________________________ register handles end
+
+//__________________________________________________________________________________________________________________________ get_register_value begin
+std::string DaikinX10A::get_register_value(const std::string& label) {
+  for (uint16_t i = 0; i < register_states_.size(); i++) {
+    const RegisterDef &reg = register_table_[i];
+    if (!reg.label || reg.label != label) continue;
+    this->decode_on_demand_(i);
+    const RegisterState &state = register_states_[i];
+    if (state.value.kind != RegisterValue::Kind::NONE) {
+      char text[32];
+      format_value_(reg, state, text, sizeof(text));
+      return std::string(text);
+    }
   }
-  return false;
+  return "";  // Return empty string if register not found or value is empty
 }
+//________________________________________________________________ get_register_value end
 
-//__________________________________________________________________________________________________________________________ convert_registry_values_ begin
-void DaikinX10A::convert_registry_values_(const daikin_package &pkg, uint8_t reg_id) {
-  unsigned offset = pkg.data_offset();
+//__________________________________________________________________________________________________________________________ bind_sensor begin
+void DaikinX10A::bind_sensor(RegisterHandle handle, sensor::Sensor *sens) {
+  if (handle >= register_count_) return;
+  this->attach_binding_(SensorBinding{handle, sens, nullptr});
+  ESP_LOGI("ESPoeDaikin", "Registered dynamic sensor: %s", register_table_[handle].label);
+}
 
-  if (debug_mode_) ESP_LOGI("ESPoeDaikin", "convert_registry_values: registry_id = %d (hex: 0x%02X), data_offset = %u", (int)reg_id, reg_id, offset);
-  for (auto &reg : registers_) {
-    if (static_cast<uint8_t>(reg.registryID) != reg_id) continue;
+void DaikinX10A::bind_text_sensor(RegisterHandle handle, text_sensor::TextSensor *sens) {
+  if (handle >= register_count_) return;
+  this->attach_binding_(SensorBinding{handle, nullptr, sens});
+  ESP_LOGI("ESPoeDaikin", "Registered dynamic text sensor: %s", register_table_[handle].label);
+}
+
+// Before setup() there is no decode plan yet, the binding waits in sensor_bindings_
+void DaikinX10A::attach_binding_(const SensorBinding &binding) {
+  if (register_steps_.empty()) {
+    sensor_bindings_.push_back(binding);
+    return;
+  }
+  const uint16_t step = register_steps_[binding.handle];
+  if (step == NO_STEP) return;
+  decode_plan_[step].sensor = binding.sensor;
+  decode_plan_[step].text_sensor = binding.text_sensor;
+  if (binding.sensor != nullptr || binding.text_sensor != nullptr) this->queue_register_(binding.handle);
+}
+//________________________________________________________________ bind_sensor end
+
+//__________________________________________________________________________________________________________________________ update_sensor begin
+void DaikinX10A::update_sensor(RegisterHandle handle, float value) {
+  if (handle >= register_steps_.size() || register_steps_[handle] == NO_STEP) return;
+  sensor::Sensor *sens = decode_plan_[register_steps_[handle]].sensor;
+  if (sens == nullptr) return;
+  sens->publish_state(value);
+  ESP_LOGV("ESPoeDaikin", "Updated sensor '%s' = %.1f", register_table_[handle].label, value);
+}
 
-    const unsigned int idx  = static_cast<unsigned int>(reg.offset) + offset;
-    const unsigned int need = idx + static_cast<unsigned int>(reg.dataSize);
-    if (need > pkg.size()) continue;
+bool DaikinX10A::update_text_sensor(RegisterHandle handle, const char *value) {
+  if (handle >= register_steps_.size() || register_steps_[handle] == NO_STEP) return false;
+  text_sensor::TextSensor *sens = decode_plan_[register_steps_[handle]].text_sensor;
+  if (sens == nullptr) return false;
+  sens->publish_state(value);
+  ESP_LOGV("ESPoeDaikin", "Updated text sensor '%s' = %s", register_table_[handle].label, value);
+  return true;
+}
+//________________________________________________________________ update_sensor end
 
-    const uint8_t *input = &pkg.buffer()[idx];
+//__________________________________________________________________________________________________________________________ convert_registry_values_ begin
+// Converts the eager steps of the registry, or all of them; stamps every converted register with the frame's generation
+void DaikinX10A::convert_registry_values_(const daikin_package &pkg, const RegistrySpan &span, bool all) {
+  const uint8_t *frame = pkg.data();
+  const size_t frame_size = pkg.size();
+  const uint32_t generation = registry_cache_[span.cache].generation;
+
+  if (debug_mode_) ESP_LOGI("ESPoeDaikin", "convert_registry_values: registry_id = %d (hex: 0x%02X), data_offset = %u", (int)pkg.registry_id(), pkg.registry_id(), pkg.data_offset());
+  const uint16_t end = span.first + (all ? span.count : span.eager);
+  for (uint16_t i = span.first; i < end; i++) {
+    const DecodeStep &step = decode_plan_[i];
+    if (step.end > frame_size) continue;
+
+    const RegisterDef &reg = register_table_[step.register_index];
     if (debug_mode_) ESP_LOGI("ESPoeDaikin", "  Processing %s: offset=%d, idx=%u, byte_at_idx=0x%02X",
-             reg.label, reg.offset, idx, pkg.buffer()[idx]);
-    convert_one_(reg, input);
+             reg.label, (int)reg.offset, (unsigned)step.start, frame[step.start]);
+    RegisterState &state = register_states_[step.register_index];
+    step.convert(reg, state, frame + step.start);
+    state.decoded_at = generation;
   }
 }
 //________________________________________________________________ convert_registry_values_ end
 
 //__________________________________________________________________________________________________________________________ numeric helpers begin
-unsigned short DaikinX10A::getUnsignedValue_(const uint8_t *data, int dataSize, int cnvflg) {
-  if (dataSize == 1) return (unsigned short)data[0];
-  if (cnvflg == 0) return (unsigned short)((data[1] << 8) | data[0]);
-  return (unsigned short)((data[0] << 8) | data[1]);
+// 1 or 2 data bytes; cnvflg 0 is little endian, 1 big endian. A 1-byte value is never sign-extended, not even for the signed convids
+template<bool Signed, bool BigEndian, uint8_t Width> int32_t DaikinX10A::read_raw_(const uint8_t *data) {
+  if (Width == 1) return data[0];
+  const uint16_t num = BigEndian ? (uint16_t)((data[0] << 8) | data[1]) : (uint16_t)((data[1] << 8) | data[0]);
+  return Signed ? (int32_t)(int16_t)num : (int32_t)num;
 }
 
-short DaikinX10A::getSignedValue_(const uint8_t *data, int datasize, int cnvflg) {
-  unsigned short num = getUnsignedValue_(data, datasize, cnvflg);
-  short result = (short)num;
-  if ((num & 0x8000) != 0) {
-    num = (unsigned short)~num;
-    num += 1;
-    result = (short)((int)num * -1);
+template<DaikinX10A::Scale S> double DaikinX10A::scale_(double data) {
+  switch (S) {
+    case Scale::DIV256: return data / 256.0;
+    case Scale::TENTH:  return data * 0.1;
+    default:            return data;
   }
-  return result;
 }
 
-double DaikinX10A::convertPress2Temp_(double data) { // R32
-  double num  = -2.6989493795556E-07 * data * data * data * data * data * data;
-  double num2 =  4.26383417104661E-05 * data * data * data * data * data;
-  double num3 = -0.00262978346547749 * data * data * data * data;
-  double num4 =  0.0805858127503585  * data * data * data;
-  double num5 = -1.31924457284073    * data * data;
-  double num6 =  13.4157368435437    * data;
-  double num7 = -51.1813342993155;
-  return num + num2 + num3 + num4 + num5 + num6 + num7;
+double DaikinX10A::convertPress2Temp_(double data) { // R32, sixth-order polynomial in Horner form
+  return ((((((-2.6989493795556E-07 * data + 4.26383417104661E-05) * data - 0.00262978346547749) * data
+            + 0.0805858127503585) * data - 1.31924457284073) * data + 13.4157368435437) * data - 51.1813342993155);
 }
 //________________________________________________________________ numeric helpers end
 
 //__________________________________________________________________________________________________________________________ table converters begin
-void DaikinX10A::convertTable200_(const uint8_t *data, char *ret) {
-  strcpy(ret, (data[0] == 0) ? "OFF" : "ON");
+const char *DaikinX10A::convertTable200_(uint8_t raw) {
+  return (raw == 0) ? "OFF" : "ON";
 }
 
-void DaikinX10A::convertTable203_(const uint8_t *data, char *ret) {
-  switch (data[0]) {
-    case 0: strcpy(ret, "Normal"); break;
-    case 1: strcpy(ret, "Error"); break;
-    case 2: strcpy(ret, "Warning"); break;
-    case 3: strcpy(ret, "Caution"); break;
-    default: strcpy(ret, "-"); break;
+const char *DaikinX10A::convertTable203_(uint8_t raw) {
+  switch (raw) {
+    case 0: return "Normal";
+    case 1: return "Error";
+    case 2: return "Warning";
+    case 3: return "Caution";
+    default: return "-";
   }
 }
 
-void DaikinX10A::convertTable204_(const uint8_t *data, char *ret) {
+void DaikinX10A::convertTable204_(uint8_t raw, char *ret) {
   const char array[]  = " ACEHFJLPU987654";
   const char array2[] = "0123456789AHCJEF";
-  int n1 = (data[0] >> 4) & 15;
-  int n2 = (int)(data[0] & 15);
+  int n1 = (raw >> 4) & 15;
+  int n2 = (int)(raw & 15);
   ret[0] = array[n1];
   ret[1] = array2[n2];
   ret[2] = 0;
@@ -292,133 +1068,191 @@ double DaikinX10A::convertTable312_(const uint8_t *data) {
   return dbl;
 }
 
-void DaikinX10A::convertTable315_(const uint8_t *data, char *ret) {
-  uint8_t b = (data[0] & 0xF0) >> 4;
+const char *DaikinX10A::convertTable315_(uint8_t raw) {
+  uint8_t b = (raw & 0xF0) >> 4;
   switch (b) {
-    case 0: strcpy(ret, "Stop"); break;
-    case 1: strcpy(ret, "Heating"); break;
-    case 2: strcpy(ret, "Cooling"); break;
-    case 4: strcpy(ret, "DHW"); break;
-    case 5: strcpy(ret, "Heating + DHW"); break;
-    case 6: strcpy(ret, "Cooling + DHW"); break;
-    default: strcpy(ret, "-"); break;
+    case 0: return "Stop";
+    case 1: return "Heating";
+    case 2: return "Cooling";
+    case 4: return "DHW";
+    case 5: return "Heating + DHW";
+    case 6: return "Cooling + DHW";
+    default: return "-";
   }
 }
 
-void DaikinX10A::convertTable316_(const uint8_t *data, char *ret) {
-  uint8_t b = (data[0] & 0xF0) >> 4;
+const char *DaikinX10A::convertTable316_(uint8_t raw) {
+  uint8_t b = (raw & 0xF0) >> 4;
   switch (b) {
-    case 0: strcpy(ret, "H/P only"); break;
-    case 1: strcpy(ret, "Hybrid"); break;
-    case 2: strcpy(ret, "Boiler only"); break;
-    default: strcpy(ret, "Unknown"); break;
+    case 0: return "H/P only";
+    case 1: return "Hybrid";
+    case 2: return "Boiler only";
+    default: return "Unknown";
   }
 }
 
-void DaikinX10A::convertTable217_(const uint8_t *data, char *ret) {
-  const char* r217[] = {
+const char *DaikinX10A::convertTable217_(uint8_t raw) {
+  static const char *const r217[] = {
     "Fan Only","Heating","Cooling","Auto","Ventilation","Auto Cool","Auto Heat","Dry","Aux.",
     "Cooling Storage","Heating Storage",
     "UseStrdThrm(cl)1","UseStrdThrm(cl)2","UseStrdThrm(cl)3","UseStrdThrm(cl)4",
     "UseStrdThrm(ht)1","UseStrdThrm(ht)2","UseStrdThrm(ht)3","UseStrdThrm(ht)4"
   };
-  int idx = (int)data[0];
-  if (idx >= 0 && idx < (int)(sizeof(r217) / sizeof(r217[0]))) strcpy(ret, r217[idx]);
-  else strcpy(ret, "-");
+  if (raw < sizeof(r217) / sizeof(r217[0])) return r217[raw];
+  return "-";
 }
 
-void DaikinX10A::convertTable300_(const uint8_t *data, int tableID, char *ret) {
+const char *DaikinX10A::convertTable300_(uint8_t raw, int tableID) {
   uint8_t mask = (uint8_t)(1U << (tableID % 10));
-  strcpy(ret, ((data[0] & mask) != 0) ? "ON" : "OFF");
+  return ((raw & mask) != 0) ? "ON" : "OFF";
 }
 //________________________________________________________________ table converters end
 
-//__________________________________________________________________________________________________________________________ convert_one_ begin
-void DaikinX10A::convert_one_(Register &def, const uint8_t *data) {
-  def.asString[0] = '\0';
+//__________________________________________________________________________________________________________________________ converters begin
+// One converter per signedness, width, byte order, scale and post-processing step, picked by select_converter_() when the decode plan is
+// compiled. Decoding a register is then a single indirect call. No text is produced here, see format_value_()
+template<bool Signed, bool BigEndian, uint8_t Width, DaikinX10A::Scale S, DaikinX10A::Post P>
+void DaikinX10A::convert_number_(const RegisterDef &, RegisterState &state, const uint8_t *data) {
+  double dblData = scale_<S>((double)read_raw_<Signed, BigEndian, Width>(data));
+  if (P == Post::NOT_AVAILABLE && dblData == -3276.8) {
+    state.value.kind = RegisterValue::Kind::NOT_AVAILABLE;
+    state.value.number = NAN;
+    return;
+  }
+  if (P == Post::R32) dblData = convertPress2Temp_(dblData);
+  state.value.kind = RegisterValue::Kind::NUMBER;
+  state.value.number = (float)dblData;
+}
 
-  const int convId = def.convid;
-  const int num = def.dataSize;
-  double dblData = NAN;
+// Lookup tables keep the raw byte, the text is looked up by format_value_()
+void DaikinX10A::convert_enum_(const RegisterDef &, RegisterState &state, const uint8_t *data) {
+  state.value.kind = RegisterValue::Kind::ENUM;
+  state.value.number = NAN;
+  state.value.raw = data[0];
+}
 
-  switch (convId) {
-    case 0x00:
-      return;
+void DaikinX10A::convert_text_(const RegisterDef &def, RegisterState &state, const uint8_t *data) {
+  state.value.number = NAN;
+  if (state.text == nullptr) {
+    state.value.kind = RegisterValue::Kind::NONE;
+    return;
+  }
+  const size_t len = (size_t)def.dataSize < REGISTER_TEXT_SIZE ? (size_t)def.dataSize : REGISTER_TEXT_SIZE - 1;
+  state.text[0] = '\0';
+  strncat(state.text, (const char*)data, len);
+  state.value.kind = RegisterValue::Kind::TEXT;
+}
 
-    case 100:
-      strncat(def.asString, (const char*)data, (size_t)num);
-      return;
+void DaikinX10A::convert_table312_(const RegisterDef &, RegisterState &state, const uint8_t *data) {
+  state.value.kind = RegisterValue::Kind::NUMBER;
+  state.value.number = (float)convertTable312_(data);
+}
 
-    // signed
-    case 101: dblData = (double)getSignedValue_(data, num, 0); break;
-    case 102: dblData = (double)getSignedValue_(data, num, 1); break;
-    case 103: dblData = (double)getSignedValue_(data, num, 0) / 256.0; break;
-    case 104: dblData = (double)getSignedValue_(data, num, 1) / 256.0; break;
-    case 105:
-      dblData = (double)getSignedValue_(data, num, 0) * 0.1;
-      ESP_LOGV("ESPoeDaikin", "    convid 105: bytes[0]=0x%02X bytes[1]=0x%02X → %g°C", data[0], (num > 1 ? data[1] : 0), dblData);
-      break;
-    case 106: dblData = (double)getSignedValue_(data, num, 1) * 0.1; break;
+void DaikinX10A::convert_unsupported_(const RegisterDef &, RegisterState &state, const uint8_t *) {
+  state.value.kind = RegisterValue::Kind::UNSUPPORTED;
+  state.value.number = NAN;
+}
 
-    case 107:
-      dblData = (double)getSignedValue_(data, num, 0) * 0.1;
-      if (dblData == -3276.8) { strcpy(def.asString, "---"); return; }
-      break;
+template<bool Signed, bool BigEndian, DaikinX10A::Scale S, DaikinX10A::Post P>
+DaikinX10A::ConvertFn DaikinX10A::number_converter_(uint8_t dataSize) {
+  if (dataSize == 1) return &DaikinX10A::convert_number_<Signed, BigEndian, 1, S, P>;
+  return &DaikinX10A::convert_number_<Signed, BigEndian, 2, S, P>;
+}
 
-    case 108:
-      dblData = (double)getSignedValue_(data, num, 1) * 0.1;
-      if (dblData == -3276.8) { strcpy(def.asString, "---"); return; }
-      break;
+// convid 0x00 never produces a value, so those rows are left out of the decode plan
+DaikinX10A::ConvertFn DaikinX10A::select_converter_(const RegisterDef &def) {
+  const uint8_t size = def.dataSize;
+  switch (def.convid) {
+    case 0x00: return nullptr;
+    case 100:  return &DaikinX10A::convert_text_;
+
+    // signed
+    case 101: return number_converter_<true, false, Scale::ONE, Post::NONE>(size);
+    case 102: return number_converter_<true, true, Scale::ONE, Post::NONE>(size);
+    case 103: return number_converter_<true, false, Scale::DIV256, Post::NONE>(size);
+    case 104: return number_converter_<true, true, Scale::DIV256, Post::NONE>(size);
+    case 105: return number_converter_<true, false, Scale::TENTH, Post::NONE>(size);
+    case 106: return number_converter_<true, true, Scale::TENTH, Post::NONE>(size);
+    case 107: return number_converter_<true, false, Scale::TENTH, Post::NOT_AVAILABLE>(size);
+    case 108: return number_converter_<true, true, Scale::TENTH, Post::NOT_AVAILABLE>(size);
 
     // unsigned
-    case 151: dblData = (double)getUnsignedValue_(data, num, 0); break;
-    case 152: dblData = (double)getUnsignedValue_(data, num, 1); break;
-    case 153: dblData = (double)getUnsignedValue_(data, num, 0) / 256.0; break;
-    case 154: dblData = (double)getUnsignedValue_(data, num, 1) / 256.0; break;
-    case 155: dblData = (double)getUnsignedValue_(data, num, 0) * 0.1; break;
-    case 156: dblData = (double)getUnsignedValue_(data, num, 1) * 0.1; break;
+    case 151: return number_converter_<false, false, Scale::ONE, Post::NONE>(size);
+    case 152: return number_converter_<false, true, Scale::ONE, Post::NONE>(size);
+    case 153: return number_converter_<false, false, Scale::DIV256, Post::NONE>(size);
+    case 154: return number_converter_<false, true, Scale::DIV256, Post::NONE>(size);
+    case 155: return number_converter_<false, false, Scale::TENTH, Post::NONE>(size);
+    case 156: return number_converter_<false, true, Scale::TENTH, Post::NONE>(size);
 
     // tables
-    case 200: convertTable200_(data, def.asString); return;
-    case 203: convertTable203_(data, def.asString); return;
-    case 204: convertTable204_(data, def.asString); return;
-    case 201:
-    case 217: convertTable217_(data, def.asString); return;
-
+    case 200: case 201: case 203: case 204: case 211: case 217:
     case 300: case 301: case 302: case 303: case 304: case 305: case 306: case 307:
-      convertTable300_(data, def.convid, def.asString);
-      return;
+    case 315: case 316:
+      return &DaikinX10A::convert_enum_;
 
-    case 312:
-      dblData = convertTable312_(data);
-      break;
+    case 312: return &DaikinX10A::convert_table312_;
 
-    case 315: convertTable315_(data, def.asString); return;
-    case 316: convertTable316_(data, def.asString); return;
+    // pressure -> temp
+    case 401: return number_converter_<true, false, Scale::ONE, Post::R32>(size);
+    case 402: return number_converter_<true, true, Scale::ONE, Post::R32>(size);
+    case 403: return number_converter_<true, false, Scale::DIV256, Post::R32>(size);
+    case 404: return number_converter_<true, true, Scale::DIV256, Post::R32>(size);
+    case 405: return number_converter_<true, false, Scale::TENTH, Post::R32>(size);
+    case 406: return number_converter_<true, true, Scale::TENTH, Post::R32>(size);
+
+    default: return &DaikinX10A::convert_unsupported_;
+  }
+}
+//________________________________________________________________ converters end
 
-    case 211:
-      if (data[0] == 0) { strcpy(def.asString, "OFF"); return; }
-      dblData = (double)data[0];
-      break;
+//__________________________________________________________________________________________________________________________ format_value_ begin
+// Renders state.value as text, for text sensors, get_register_value() and the debug log only
+void DaikinX10A::format_value_(const RegisterDef &def, const RegisterState &state, char *out, size_t out_len) {
+  const RegisterValue &value = state.value;
+  const char *text = nullptr;
 
-    // pressure -> temp
-    case 401: dblData = convertPress2Temp_((double)getSignedValue_(data, num, 0)); break;
-    case 402: dblData = convertPress2Temp_((double)getSignedValue_(data, num, 1)); break;
-    case 403: dblData = convertPress2Temp_((double)getSignedValue_(data, num, 0) / 256.0); break;
-    case 404: dblData = convertPress2Temp_((double)getSignedValue_(data, num, 1) / 256.0); break;
-    case 405: dblData = convertPress2Temp_((double)getSignedValue_(data, num, 0) * 0.1); break;
-    case 406: dblData = convertPress2Temp_((double)getSignedValue_(data, num, 1) * 0.1); break;
+  switch (value.kind) {
+    case RegisterValue::Kind::NONE:          text = ""; break;
+    case RegisterValue::Kind::TEXT:          text = state.text; break;
+    case RegisterValue::Kind::NOT_AVAILABLE: text = "---"; break;
 
-    default:
-      snprintf(def.asString, sizeof(def.asString), "Conv %d NA", convId);
+    case RegisterValue::Kind::NUMBER:
+      snprintf(out, out_len, "%g", (double)value.number);
       return;
-  }
 
-  if (!std::isnan(dblData)) {
-    snprintf(def.asString, sizeof(def.asString), "%g", dblData);
+    case RegisterValue::Kind::UNSUPPORTED:
+      snprintf(out, out_len, "Conv %d NA", def.convid);
+      return;
+
+    case RegisterValue::Kind::ENUM:
+      switch (def.convid) {
+        case 200: text = convertTable200_(value.raw); break;
+        case 203: text = convertTable203_(value.raw); break;
+        case 201:
+        case 217: text = convertTable217_(value.raw); break;
+        case 315: text = convertTable315_(value.raw); break;
+        case 316: text = convertTable316_(value.raw); break;
+        case 300: case 301: case 302: case 303: case 304: case 305: case 306: case 307:
+          text = convertTable300_(value.raw, def.convid);
+          break;
+        case 204: {
+          char code[3];
+          convertTable204_(value.raw, code);
+          snprintf(out, out_len, "%s", code);
+          return;
+        }
+        case 211:
+          if (value.raw == 0) { text = "OFF"; break; }
+          snprintf(out, out_len, "%u", (unsigned)value.raw);
+          return;
+        default: text = "-"; break;
+      }
+      break;
   }
+
+  snprintf(out, out_len, "%s", text);
 }
-//________________________________________________________________ convert_one_ end
+//________________________________________________________________ format_value_ end
 
 }  // namespace daikin_x10a
 }  // namespace esphome
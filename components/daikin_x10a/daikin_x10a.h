@@ -1,4 +1,5 @@
 #pragma once
+#include "esphome/core/defines.h"
 #include "esphome/core/component.h"
 #include "esphome/core/application.h"      // App
 #include "esphome/core/entity_base.h"      // EntityCategory
@@ -7,10 +8,28 @@
 #include "esphome/components/text_sensor/text_sensor.h"
 #include <vector>
 #include <string>
-#include <map>
+#include <array>
+#include <atomic>
+#include "daikin_derived.h"
+#include "daikin_history.h"
 #include "daikin_package.h"
+#include "daikin_telemetry.h"
 #include "register_definitions.h"
 
+#if defined(USE_DAIKIN_X10A_TELEMETRY) || defined(USE_DAIKIN_X10A_HISTORY)
+#include "esphome/components/socket/socket.h"
+#include <memory>
+#endif
+
+#if defined(USE_DAIKIN_X10A_WARM_START) || defined(USE_DAIKIN_X10A_DERIVED)
+#include "esphome/core/preferences.h"
+#endif
+
+#ifdef USE_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
 namespace esphome {
 namespace daikin_x10a {
 
@@ -18,55 +37,526 @@ class DaikinX10A : public uart::UARTDevice, public Component {
  public:
   explicit DaikinX10A(uart::UARTComponent *parent) : uart::UARTDevice(parent) {}
   virtual ~DaikinX10A();
+    void setup() override;
     void loop() override;
+    // Makes every polled registry due now; the requests themselves are sent and received by poll_uart_() from loop()
     void FetchRegisters();
-    void add_register(int mode, int convid, int offset, int registryID, int dataSize, int dataType, const char* label);
+    // Register table generated by __init__.py (constexpr, in flash); must stay valid for the lifetime of the component
+    void set_register_table(const RegisterDef *table, uint16_t count) { register_table_ = table; register_count_ = count; }
+
+    // Register handles: the index of a row in the register table. __init__.py binds the generated sensors by handle; a lambda resolves
+    // its label once, e.g. static const auto h = id(daikin_comp).find_register("Leaving water temp"); and then reads by handle
+    using RegisterHandle = uint16_t;
+    static constexpr RegisterHandle NO_REGISTER = 0xFFFF;
+    // The getters decode a Mode 0 register from the last frame of its registry on first use
+    RegisterHandle find_register(const char *label) const;
+    float get_register_float(RegisterHandle handle);        // NAN unless the register holds a number
+    const char *get_register_text(RegisterHandle handle);   // "" while it has no value; valid until the next call
+
+    // Get register value by label name (scans the table and allocates; prefer the handle getters in lambdas that run often)
+    std::string get_register_value(const std::string& label);
+
+    // Sensors bound to a register, published from the decode plan
+    void bind_sensor(RegisterHandle handle, sensor::Sensor *sens);
+    void bind_text_sensor(RegisterHandle handle, text_sensor::TextSensor *sens);
+    void update_sensor(RegisterHandle handle, float value);
+    bool update_text_sensor(RegisterHandle handle, const char *value);
+
+    // Label based variants of the above, resolved with find_register() on every call
+    void register_dynamic_sensor(const std::string& label, sensor::Sensor *sens) { bind_sensor(find_register(label.c_str()), sens); }
+    void update_sensor(const std::string& label, float value) { update_sensor(find_register(label.c_str()), value); }
+    void register_dynamic_text_sensor(const std::string& label, text_sensor::TextSensor *sens) {
+      bind_text_sensor(find_register(label.c_str()), sens);
+    }
+    bool update_text_sensor(const std::string& label, const std::string& value) {
+      return update_text_sensor(find_register(label.c_str()), value.c_str());
+    }
+
+    // Poll scheduling: every registry has its own interval (POLL_ONCE = read once after boot) and priority
+    static constexpr uint32_t POLL_ONCE = 0;
+    void set_scan_interval(uint32_t interval_ms) { scan_interval_ms_ = interval_ms; }
+    void set_boot_delay(uint32_t delay_ms) { boot_delay_ms_ = delay_ms; }
+    void set_adaptive_backoff(uint8_t max_factor) { max_backoff_ = max_factor < 1 ? 1 : max_factor; }
+    void set_registry_schedule(uint8_t registry_id, uint32_t interval_ms, uint8_t priority);
+    // The first sweep after boot is the probe: a registry that never answered (timeout or error frame) twice in a row, while others
+    // did, leaves the schedule and is only asked again every reprobe_interval_ms. The probe also learns every registry's frame size
+    void set_reprobe_interval(uint32_t interval_ms) { reprobe_interval_ms_ = interval_ms; }
+    uint16_t get_dead_registries() const { return probe_dead_; }
+
+    // Change detection: publish only when a value moves past the deadband, or every max_age as a heartbeat
+    void set_publish_deadband(float deadband) { publish_deadband_ = deadband; }
+    void set_publish_deadband_percent(float fraction) { publish_deadband_fraction_ = fraction; }
+    void set_publish_max_age(uint32_t max_age_ms) { publish_max_age_ms_ = max_age_ms; }
+    uint32_t get_frames_skipped() const { return frames_skipped_; }
+    uint32_t get_publishes_suppressed() const { return publishes_suppressed_; }
+
+    // Feeds a captured debug log ("40 61 14 ... B1", as printed by to_hex()) through the frame decoder as if it came from the UART;
+    // returns the number of frames decoded. Usable from a lambda or an API service to replay a capture on the device
+    int replay_hex(const std::string &hex);
 
-    // Get register value by label name (for template sensors)
-    std::string get_register_value(const std::string& label) const;
+    // On-device decoder benchmark (daikin_benchmark.cpp); false when the decode time of all registries exceeds the baseline by >20%,
+    // or when it cannot run (UART task). Runs to completion in the calling loop(): polling is suspended until it returns
+    bool run_decode_benchmark();
+    void set_benchmark_baseline(uint32_t baseline_ns) { benchmark_baseline_ns_ = baseline_ns; }
 
-    // Dynamic sensor management
-    void register_dynamic_sensor(const std::string& label, sensor::Sensor *sens);
-    void update_sensor(const std::string& label, float value);
+    // Runs the poller and decoder on a FreeRTOS task, pinned to the core loop() does not run on (ESP32 only); loop() then only
+    // publishes the values the task hands over through updates_. All instances with uart_task share one task that polls them in turn,
+    // so every heat pump has a request in flight on its own UART at the same time. Only registers something reads are handed over: bound
+    // sensors, derived and history inputs, and registers read with get_register_*() (from the next frame of their registry on)
+    static constexpr uint8_t MAX_TASK_INSTANCES = 4;
+    void set_uart_task(bool enabled) { uart_task_ = enabled; }
+    uint32_t get_updates_dropped() const { return updates_dropped_; }
 
-    // Dynamic text sensor management
-    void register_dynamic_text_sensor(const std::string& label, text_sensor::TextSensor *sens);
-    bool update_text_sensor(const std::string& label, const std::string& value);
+    // Bus counters, always kept; the diagnostics block of the YAML publishes them as sensors
+    uint32_t get_timeouts() const { return timeouts_; }
+    uint32_t get_crc_mismatches() const { return rx_decoder_.crc_mismatches(); }
+    uint32_t get_error_frames() const { return error_frames_; }
+    uint32_t get_wrong_registry_frames() const { return wrong_registry_frames_; }
+    uint32_t get_bytes_received() const { return bytes_received_; }
+    uint32_t get_last_sweep_ms() const { return last_sweep_ms_; }
+
+#ifdef USE_DAIKIN_X10A_DIAGNOSTICS
+    // Diagnostic sensors (daikin_diagnostics.cpp), published every interval_ms
+    void set_diagnostics_interval(uint32_t interval_ms) { diagnostics_interval_ms_ = interval_ms; }
+    void set_round_trip_min_sensor(sensor::Sensor *sens) { round_trip_min_sensor_ = sens; }
+    void set_round_trip_p50_sensor(sensor::Sensor *sens) { round_trip_p50_sensor_ = sens; }
+    void set_round_trip_p99_sensor(sensor::Sensor *sens) { round_trip_p99_sensor_ = sens; }
+    void set_round_trip_max_sensor(sensor::Sensor *sens) { round_trip_max_sensor_ = sens; }
+    void set_timeouts_sensor(sensor::Sensor *sens) { timeouts_sensor_ = sens; }
+    void set_crc_mismatches_sensor(sensor::Sensor *sens) { crc_mismatches_sensor_ = sens; }
+    void set_error_frames_sensor(sensor::Sensor *sens) { error_frames_sensor_ = sens; }
+    void set_wrong_registry_frames_sensor(sensor::Sensor *sens) { wrong_registry_frames_sensor_ = sens; }
+    void set_sweep_duration_sensor(sensor::Sensor *sens) { sweep_duration_sensor_ = sens; }
+    void set_loop_time_max_sensor(sensor::Sensor *sens) { loop_time_max_sensor_ = sens; }
+    void set_bytes_per_second_sensor(sensor::Sensor *sens) { bytes_per_second_sensor_ = sens; }
+    // Outcome of the registry probe, published once it is complete and again whenever a registry dies, revives or changes size
+    void set_registry_probe_sensor(text_sensor::TextSensor *sens) { registry_probe_sensor_ = sens; }
+#endif
+
+#ifdef USE_DAIKIN_X10A_TELEMETRY
+    // Binary telemetry stream (daikin_telemetry.h for the format, daikin_telemetry.cpp): every request and frame, and optionally every
+    // decoded value, batched per datagram/write to a UDP or TCP listener
+    void set_telemetry_target(const std::string &host, uint16_t port, bool tcp) {
+      telemetry_host_ = host;
+      telemetry_port_ = port;
+      telemetry_tcp_ = tcp;
+    }
+    void set_telemetry_values(bool enabled) { telemetry_values_ = enabled; }
+    void set_telemetry_flush_interval(uint32_t interval_ms) { telemetry_flush_ms_ = interval_ms; }
+    uint32_t get_telemetry_dropped() const { return telemetry_dropped_; }
+#endif
+
+#ifdef USE_DAIKIN_X10A_WARM_START
+    // Warm start (daikin_warm_start.cpp): the last frame of every registry is kept in flash and published again at boot, before
+    // the first sweep. Changed frames are written at most every write_interval_ms, and on a clean shutdown
+    void set_warm_start_write_interval(uint32_t interval_ms) { warm_write_interval_ms_ = interval_ms; }
+    void set_stale_registries_sensor(sensor::Sensor *sens) { stale_registries_sensor_ = sens; }
+    uint16_t get_stale_registries() const { return warm_stale_count_; }  // restored registries not read from the HP yet
+    void on_shutdown() override;
+#endif
+
+#ifdef USE_DAIKIN_X10A_DERIVED
+    // Derived metrics (daikin_derived.h), generated by __init__.py in dependency order; evaluated in loop(), a formula when an input
+    // register changed, an integral with every frame of its input registries
+    void set_derived_metrics(const DerivedOp *ops, const DerivedDef *defs, uint8_t count);
+    void bind_derived_sensor(uint8_t index, sensor::Sensor *sens);
+    float get_derived_value(uint8_t index) const;
+#endif
+
+#ifdef USE_DAIKIN_X10A_HISTORY
+    // History (daikin_history.h) of up to HISTORY_MAX_SERIES registers, allocated once in setup(), in PSRAM when asked. Exported over
+    // HTTP (GET /history.csv or /history.bin on the history port) or pushed to a TCP listener, e.g. from an API service
+    static constexpr uint8_t HISTORY_MAX_SERIES = 32;
+    void set_history_storage(uint32_t raw_bytes, uint16_t minute_slots, uint16_t quarter_slots, float resolution, uint32_t hold_ms,
+                             bool psram);
+    void add_history_register(RegisterHandle handle);
+    void set_history_http_port(uint16_t port) { history_http_port_ = port; }
+    bool export_history(const std::string &host, uint16_t port, bool binary);  // false while an export is running
+    size_t get_history_memory() const { return history_memory_size_; }
+#endif
+
+    // Component id; several daikin_x10a blocks (one per heat pump, each on its own UART) keep their flash records apart with it
+    void set_instance_name(const char *name) { instance_name_ = name; }
+    const char *get_instance_name() const { return instance_name_; }
 
     // Debug mode
     void set_debug_mode(bool enabled) { debug_mode_ = enabled; }
     bool get_debug_mode() const { return debug_mode_; }
 
  protected:
-  bool debug_mode_{false};
-  std::vector<uint8_t> buffer_;
+  daikin_relaxed<bool> debug_mode_{false};  // set from loop() (a button, a lambda), read by the UART task
+  const char *instance_name_{"daikin_x10a"};
+  uint32_t benchmark_baseline_ns_{0};
   uint8_t last_requested_registry_{0};
-  std::vector<Register> registers_;
+  const RegisterDef *register_table_{nullptr};
+  uint16_t register_count_{0};
+  std::vector<RegisterState> register_states_;  // parallel to register_table_, sized once in compile_registers_()
+  std::vector<char> register_text_;             // text buffers of the convid 100 registers, each followed by its last published text
+  std::vector<uint16_t> register_steps_;        // register handle -> index into decode_plan_, NO_STEP for convid 0x00
+  static constexpr uint16_t NO_STEP = 0xFFFF;
+  char text_buffer_[32];                        // backs get_register_text()
+
+  // Decode plan, compiled once in setup() from the register table so a frame only touches its own registers
+  using ConvertFn = void (*)(const RegisterDef &def, RegisterState &state, const uint8_t *data);
+  struct DecodeStep {
+    uint16_t register_index;  // index into register_table_ and register_states_
+    uint16_t start;           // byte position of the value in the frame (data_offset + offset)
+    uint16_t end;             // frame must hold at least this many bytes (start + dataSize)
+    ConvertFn convert;
+    sensor::Sensor *sensor;                 // bound in compile_registers_() for Mode==1 registers, else nullptr
+    text_sensor::TextSensor *text_sensor;
+    daikin_relaxed<bool> queued;            // UART task: something in loop() reads the register, hand its values over
+  };
+  struct RegistrySpan {
+    uint16_t first{0};        // first DecodeStep of this registry in decode_plan_
+    uint16_t count{0};
+    uint16_t eager{0};        // the first eager steps (Mode==1) are decoded with every frame, the rest on demand
+    uint16_t cache{NO_CACHE}; // index into registry_cache_
+  };
+  static constexpr uint16_t NO_CACHE = 0xFFFF;
+
+  // Last accepted frame per decoded registry: a byte-identical frame is not decoded or published again
+  struct RegistryCache {
+    std::vector<uint8_t> frame;
+    uint32_t last_publish_ms{0};  // last time every sensor of the registry was published (heartbeat)
+    uint32_t generation{0};       // bumped with every new frame; RegisterState::decoded_at below it means the value is out of date
+    bool valid{false};
+    bool refresh{false};          // UART task: decode and queue the next frame even when it is identical
+#ifdef USE_DAIKIN_X10A_WARM_START
+    bool dirty{false};  // frame changed since it was last written to flash
+    bool stale{false};  // values restored at boot, registry not read from the HP yet
+#endif
+  };
+  std::vector<RegistryCache> registry_cache_;
+  std::vector<DecodeStep> decode_plan_;            // grouped by registryID, in table order
+  std::array<RegistrySpan, 256> registry_spans_{};  // registryID -> slice of decode_plan_
+
+#ifdef USE_DAIKIN_X10A_DIAGNOSTICS
+  // Round trips of one registry in buckets of RoundTrip_BucketBoundsUs (daikin_diagnostics.cpp). Once count reaches
+  // RoundTrip_DecayCount every bucket is halved, so p50/p99 follow the recent round trips; min and max are since boot
+  static constexpr size_t ROUND_TRIP_BUCKETS = 16;
+  // count is the poller's own; the rest is read by publish_diagnostics_() in loop()
+  struct RoundTripStats {
+    std::array<daikin_relaxed<uint16_t>, ROUND_TRIP_BUCKETS> buckets{};
+    uint16_t count{0};
+    daikin_relaxed<uint32_t> min_us{UINT32_MAX};
+    daikin_relaxed<uint32_t> max_us{0};
+  };
+#endif
+
+  // Poll schedule: one entry per registryID with at least one Mode>=1 register, served earliest-deadline-first
+  struct PollEntry {
+    uint8_t registry_id;
+    uint8_t priority{0};      // breaks ties between entries that are due at the same time, higher first
+    uint8_t backoff{1};       // adaptive multiplier on interval_ms, grows while the registry keeps returning identical frames
+    bool done{false};         // POLL_ONCE entry that has been read
+    uint32_t interval_ms{REGISTER_SCAN_INTERVAL_MS};
+    uint32_t next_due_ms{0};
+    uint32_t latency_us{0};   // smoothed time from end of request to first response byte, 0 = not measured yet
+    uint32_t rtt_us{0};       // last complete round trip, request sent to CRC byte received
+    uint16_t frame_size{0};   // size of the last answer, 0 until the first one; bounds the receive deadline
+    uint8_t misses{0};        // requests in a row without an answer (timeout or error frame)
+    bool answered{false};     // answered at least once since boot
+    // Read by publish_probe_results_() in loop()
+    daikin_relaxed<bool> dead{false};         // never answered: off the schedule, asked again every reprobe_interval_ms_
+    daikin_relaxed<bool> short_frame{false};  // the frame ends before some register of the registry
+#ifdef USE_DAIKIN_X10A_DIAGNOSTICS
+    RoundTripStats round_trips;
+#endif
+  };
+  std::vector<PollEntry> poll_schedule_;
+  std::vector<PollEntry> schedule_config_;  // set_registry_schedule() overrides, applied by compile_registers_()
+  uint32_t scan_interval_ms_{REGISTER_SCAN_INTERVAL_MS};
+  uint32_t boot_delay_ms_{15000};
+  uint32_t setup_ms_{0};
+  uint8_t max_backoff_{4};
+  bool polling_started_{false};
 
-  // Map of label -> sensor for dynamic sensors
-  std::map<std::string, sensor::Sensor*> dynamic_sensors_;
-  std::map<std::string, text_sensor::TextSensor*> dynamic_text_sensors_;
+  // Registry probe; written by the poller only, loop() reads the counters
+  uint32_t reprobe_interval_ms_{3600000};
+  daikin_relaxed<uint16_t> probe_pending_{0};     // entries that neither answered nor were declared dead yet
+  daikin_relaxed<uint16_t> probe_answering_{0};   // entries that answered at least once
+  daikin_relaxed<uint16_t> probe_dead_{0};
+  daikin_relaxed<uint16_t> probe_generation_{0};  // bumped whenever the outcome of the probe changes
 
-  void process_frame_(daikin_package &pkg);
+  PollEntry *next_due_entry_(uint32_t now);
+  void reschedule_(PollEntry &entry, bool received, bool changed);
+  PollEntry *entry_for_(uint8_t registry_id);
+  void probe_result_(PollEntry &entry, bool received);
+  void check_frame_shape_(PollEntry &entry, const daikin_package &pkg);
+  void log_probe_results_();
+
+  void compile_registers_();
+  static ConvertFn select_converter_(const RegisterDef &def);
+  bool decode_all_() const;
+  void decode_on_demand_(RegisterHandle handle);
+
+  // bind_*() calls made before setup(), attached to their DecodeStep by compile_registers_()
+  struct SensorBinding {
+    RegisterHandle handle;
+    sensor::Sensor *sensor;
+    text_sensor::TextSensor *text_sensor;
+  };
+  std::vector<SensorBinding> sensor_bindings_;
+  void attach_binding_(const SensorBinding &binding);
+
+  // Non-blocking UART poller: one request in flight, response bytes consumed incrementally from loop()
+  enum class PollState : uint8_t { IDLE, SEND, AWAIT_HEADER, AWAIT_BODY, TIMEOUT };
+  PollState poll_state_{PollState::IDLE};
+  PollEntry *active_entry_{nullptr};       // registry of the request in flight
+  uint32_t request_start_ms_{0};
+  uint32_t request_sent_us_{0};            // request fully on the wire (estimated from byte_time_us_)
+  uint32_t deadline_us_{0};                // current receive deadline: header first, then the announced frame length
+  uint32_t byte_time_us_{1146};            // one UART character, 11 bits at 9600 8E1 until setup() reads the real config
+  daikin_package rx_package_{daikin_package::Mode::RECEIVE};
+  daikin_stream_decoder<512> rx_decoder_;  // bytes read from the UART in bulk, cut into frames
+  uint32_t hard_deadline_us_{0};           // latest point at which a request gives up, even while still resyncing
+
+  void poll_uart_();
+  void send_request_(uint8_t registry_id);
+  uint32_t response_allowance_us_(const PollEntry &entry) const;
+  void receive_bytes_();
+  void finish_request_();
+  void accept_other_frame_();
+
+  // Bus counters; written by the poller only (loop() or the UART task), read by loop()
+  daikin_relaxed<uint32_t> timeouts_{0};
+  daikin_relaxed<uint32_t> error_frames_{0};
+  daikin_relaxed<uint32_t> wrong_registry_frames_{0};
+  daikin_relaxed<uint32_t> bytes_received_{0};
+  uint32_t sweep_start_ms_{0};
+  daikin_relaxed<uint32_t> last_sweep_ms_{0};  // last time from the first request after an idle bus until no registry was due anymore
+  bool sweep_active_{false};
+
+#ifdef USE_DAIKIN_X10A_DIAGNOSTICS
+  uint32_t diagnostics_interval_ms_{60000};
+  uint32_t loop_time_max_us_{0};  // longest loop() since the last publish, loop() only
+  uint32_t diagnostics_bytes_{0};
+  uint32_t diagnostics_ms_{0};
+  sensor::Sensor *round_trip_min_sensor_{nullptr};
+  sensor::Sensor *round_trip_p50_sensor_{nullptr};
+  sensor::Sensor *round_trip_p99_sensor_{nullptr};
+  sensor::Sensor *round_trip_max_sensor_{nullptr};
+  sensor::Sensor *timeouts_sensor_{nullptr};
+  sensor::Sensor *crc_mismatches_sensor_{nullptr};
+  sensor::Sensor *error_frames_sensor_{nullptr};
+  sensor::Sensor *wrong_registry_frames_sensor_{nullptr};
+  sensor::Sensor *sweep_duration_sensor_{nullptr};
+  sensor::Sensor *loop_time_max_sensor_{nullptr};
+  sensor::Sensor *bytes_per_second_sensor_{nullptr};
+  text_sensor::TextSensor *registry_probe_sensor_{nullptr};
+  uint16_t probe_published_{0};
+
+  static void record_round_trip_(RoundTripStats &stats, uint32_t rtt_us);
+  static uint32_t round_trip_percentile_(const std::array<uint32_t, ROUND_TRIP_BUCKETS> &buckets, uint32_t count,
+                                         uint32_t per_mille, uint32_t max_us);
+  void publish_diagnostics_();
+  void publish_probe_results_();
+#endif
+
+  bool process_frame_(daikin_package &pkg);
+  int decode_registry_(const daikin_package &pkg, const RegistrySpan &span, bool force);
+  void make_all_due_();
+
+  // UART task: decoded values travel to loop() as (decode step, value) pairs, a convid 100 register with its text; only loop() writes
+  // register_states_ in this mode
+  struct RegisterUpdate {
+    uint16_t step_index;  // index into decode_plan_
+    bool force;           // heartbeat, publish even when unchanged
+    RegisterValue value;
+    char text[REGISTER_TEXT_SIZE];  // value.kind == TEXT only
+  };
+  bool uart_task_{false};
+  bool task_running_{false};
+  std::atomic<bool> fetch_requested_{false};  // FetchRegisters() while the task owns poll_schedule_
+  std::atomic<bool> queued_changed_{false};   // a register became DecodeStep::queued; the task decodes every registry's next frame
+  daikin_relaxed<uint32_t> updates_dropped_{0};  // values the task could not hand over because loop() fell behind
+  daikin_spsc_queue<RegisterUpdate, 128> updates_;
+#ifdef USE_ESP32
+  // Shared by every instance: the task walks the instances that joined it, one poll step each, then sleeps a tick
+  static TaskHandle_t uart_task_handle_;
+  static std::array<DaikinX10A *, MAX_TASK_INSTANCES> task_instances_;
+  static std::atomic<uint8_t> task_instance_count_;
+  static void uart_task_main_(void *arg);
+  void task_step_();
+#endif
+  void start_uart_task_();
+  void serve_task_requests_();
+  void queue_register_(RegisterHandle handle);
+  bool queue_registry_values_(const daikin_package &pkg, const RegistrySpan &span, bool force);
+  void drain_updates_();
+
+#ifdef USE_DAIKIN_X10A_TELEMETRY
+  // Written by the poller only (loop() or the UART task), like the bus counters
+  daikin_telemetry_buffer telemetry_;
+  std::unique_ptr<socket::Socket> telemetry_socket_;
+  struct sockaddr_storage telemetry_addr_;
+  socklen_t telemetry_addr_len_{0};
+  std::string telemetry_host_;
+  uint16_t telemetry_port_{0};
+  bool telemetry_tcp_{false};
+  bool telemetry_values_{false};
+  bool telemetry_sending_{false};    // batch finished, (part of it) not written yet; TCP only
+  size_t telemetry_written_{0};
+  uint32_t telemetry_flush_ms_{100};
+  uint32_t telemetry_batch_ms_{0};   // first record of the open batch
+  uint32_t telemetry_retry_ms_{0};   // last failed connect
+  uint32_t telemetry_sequence_{0};
+  daikin_relaxed<uint32_t> telemetry_dropped_{0};  // records lost because the batch could not be sent in time
+
+  void telemetry_record_(daikin_telemetry_buffer::Record type, const uint8_t *data, size_t len);
+  void telemetry_value_(uint16_t handle, const RegisterValue &value);
+  void telemetry_poll_();
+  void telemetry_flush_();
+  bool telemetry_connect_();
+  void telemetry_drop_();
+#endif
+
+#ifdef USE_DAIKIN_X10A_WARM_START
+  // Flash image of one registry's last frame, one preference per registry
+  struct WarmStartRecord {
+    uint8_t version;
+    uint8_t registry_id;
+    uint16_t length;  // bytes of frame in use
+    uint8_t frame[daikin_package::MAX_FRAME_SIZE];
+    uint16_t crc;     // crc16 of everything before it
+  };
+  std::vector<ESPPreferenceObject> warm_prefs_;  // parallel to registry_cache_
+  WarmStartRecord warm_record_{};                 // one registry on its way from registry_cache_ to flash
+  uint32_t warm_write_interval_ms_{900000};
+  uint32_t boot_quiet_ms_{0};                     // last byte seen on the UART before polling started
+  daikin_relaxed<uint16_t> warm_stale_count_{0};  // written by the poller, read by loop()
+  uint16_t warm_stale_published_{0xFFFF};
+  uint16_t warm_save_index_{0};                   // next registry_cache_ entry to write
+  uint16_t warm_saved_{0};
+  bool warm_saving_{false};
+  bool warm_fill_pending_{false};
+  std::atomic<uint16_t> warm_fill_request_{0};    // registry_cache_ index + 1 the UART task copies into warm_record_, 0 once done
+  sensor::Sensor *stale_registries_sensor_{nullptr};
+
+  static uint16_t warm_start_crc_(const WarmStartRecord &record);
+  void warm_start_restore_();
+  void warm_start_fill_(uint16_t cache_index);
+  void warm_start_write_(uint16_t cache_index);
+  void warm_start_save_step_();
+  bool boot_line_quiet_();
+#endif
+
+#ifdef USE_DAIKIN_X10A_DERIVED
+  // loop() only, but for derived_samples_ and derived_changed_: the poller marks every frame, loop() evaluates
+  struct DerivedState {
+    float value{NAN};
+    float last_sample{NAN};   // integral: previous sample of the source
+    uint32_t last_ms{0};
+    double total{0};          // integral in unit-hours
+    double saved_total{0};    // integral: total last handed to pref
+    ESPPreferenceObject pref;
+    uint32_t dependents{0};   // formulas using this metric, re-evaluated when it changes
+    uint32_t integrals{0};    // integrals of this metric, sampled whenever it is evaluated
+    sensor::Sensor *sensor{nullptr};
+  };
+  struct DerivedTrigger {
+    uint8_t registry_id;
+    uint32_t metrics;         // formulas with an input register in this registry
+    uint32_t integrals;       // integrals downstream of those, sampled with every frame of the registry
+  };
+  struct DerivedInput {
+    RegisterHandle handle;
+    uint32_t metrics;         // formulas reading the register
+    float last{NAN};          // value they were last evaluated with
+  };
+  const DerivedOp *derived_ops_{nullptr};
+  const DerivedDef *derived_defs_{nullptr};
+  std::vector<DerivedState> derived_states_;
+  std::vector<DerivedTrigger> derived_triggers_;
+  std::vector<DerivedInput> derived_inputs_;
+  uint32_t derived_dirty_{0};
+  std::atomic<uint32_t> derived_samples_{0};  // integrals whose input registry delivered a frame, identical or not
+  std::atomic<uint32_t> derived_changed_{0};  // formulas whose input registry delivered a frame that differs from the last one
+
+  void compile_derived_();
+  void mark_derived_(uint8_t registry_id, bool changed);
+  void evaluate_derived_();
+  void save_derived_();
+  float run_formula_(const DerivedDef &def);
+#endif
+
+#ifdef USE_DAIKIN_X10A_HISTORY
+  // loop() only, like the derived metrics
+  std::vector<daikin_history_series> history_;  // parallel to history_handles_
+  std::vector<RegisterHandle> history_handles_;
+  std::vector<const char *> history_labels_;
+  uint8_t *history_memory_{nullptr};            // one block for all series, never freed
+  size_t history_memory_size_{0};
+  uint32_t history_raw_bytes_{4096};
+  uint16_t history_slots_[daikin_history_series::TIERS]{360, 672};
+  float history_resolution_{0.1f};
+  uint32_t history_hold_ms_{900000};
+  bool history_psram_{false};
+  uint32_t history_dirty_{0};                   // series whose registry delivered a frame since the last sample
+
+  // Export: one client at a time, HTTP (accepted from history_server_) or pushed by export_history()
+  uint16_t history_http_port_{0};
+  std::unique_ptr<socket::Socket> history_server_;
+  std::unique_ptr<socket::Socket> history_client_;
+  daikin_history_export history_export_;
+  bool history_sending_{false};                 // request answered, export under way
+  char history_request_[128];
+  size_t history_request_len_{0};
+  uint8_t history_buffer_[1024];
+  size_t history_buffer_len_{0};
+  size_t history_buffer_sent_{0};
+  size_t history_exported_{0};
+  uint32_t history_start_ms_{0};
+  uint32_t history_active_ms_{0};               // last progress of the client
+
+  void history_setup_();
+  void history_mark_(uint8_t registry_id);
+  void history_sample_();
+  void history_listen_();
+  void history_begin_(bool binary);
+  void history_serve_();
+  bool history_read_request_();
+  void history_close_();
+#endif
 
   // Conversion logic (moved from daikin_package)
-  void convert_registry_values_(const daikin_package &pkg, uint8_t reg_id);
-  static void convert_one_(Register &def, const uint8_t *data);
+  void convert_registry_values_(const daikin_package &pkg, const RegistrySpan &span, bool all);
+  static void format_value_(const RegisterDef &def, const RegisterState &state, char *out, size_t out_len);
+  void publish_register_(const DecodeStep &step, RegisterState &state, bool force);
+  bool value_changed_(const RegisterDef &def, const RegisterState &state) const;
+
+  float publish_deadband_{0.0f};
+  float publish_deadband_fraction_{0.0f};
+  uint32_t publish_max_age_ms_{0};
+  daikin_relaxed<uint32_t> frames_skipped_{0};  // written by the poller
+  uint32_t publishes_suppressed_{0};
+
+  // Converters, specialised per convid family and selected once by select_converter_()
+  enum class Scale : uint8_t { ONE, DIV256, TENTH };
+  enum class Post : uint8_t { NONE, NOT_AVAILABLE, R32 };  // NOT_AVAILABLE: -3276.8 means no sensor; R32: pressure -> temperature
+  template<bool Signed, bool BigEndian, uint8_t Width, Scale S, Post P>
+  static void convert_number_(const RegisterDef &def, RegisterState &state, const uint8_t *data);
+  template<bool Signed, bool BigEndian, Scale S, Post P> static ConvertFn number_converter_(uint8_t dataSize);
+  static void convert_enum_(const RegisterDef &def, RegisterState &state, const uint8_t *data);
+  static void convert_text_(const RegisterDef &def, RegisterState &state, const uint8_t *data);
+  static void convert_table312_(const RegisterDef &def, RegisterState &state, const uint8_t *data);
+  static void convert_unsupported_(const RegisterDef &def, RegisterState &state, const uint8_t *data);
 
   // Numeric helpers
-  static unsigned short getUnsignedValue_(const uint8_t *data, int dataSize, int cnvflg);
-  static short getSignedValue_(const uint8_t *data, int datasize, int cnvflg);
+  template<bool Signed, bool BigEndian, uint8_t Width> static int32_t read_raw_(const uint8_t *data);
+  template<Scale S> static double scale_(double data);
   static double convertPress2Temp_(double data);
 
-  // Table converters
-  static void convertTable200_(const uint8_t *data, char *ret);
-  static void convertTable203_(const uint8_t *data, char *ret);
-  static void convertTable204_(const uint8_t *data, char *ret);
+  // Table converters (text tables take the raw table byte stored in RegisterValue::raw)
+  static const char *convertTable200_(uint8_t raw);
+  static const char *convertTable203_(uint8_t raw);
+  static void convertTable204_(uint8_t raw, char *ret);
   static double convertTable312_(const uint8_t *data);
-  static void convertTable315_(const uint8_t *data, char *ret);
-  static void convertTable316_(const uint8_t *data, char *ret);
-  static void convertTable217_(const uint8_t *data, char *ret);
-  static void convertTable300_(const uint8_t *data, int tableID, char *ret);
+  static const char *convertTable315_(uint8_t raw);
+  static const char *convertTable316_(uint8_t raw);
+  static const char *convertTable217_(uint8_t raw);
+  static const char *convertTable300_(uint8_t raw, int tableID);
 };
 
 }  // namespace daikin_x10a
@@ -1,27 +1,40 @@
 #pragma once
 #include <vector>
 #include <cstdint>
+#include <cmath>
+#include <cstddef>
 
 inline constexpr uint32_t REGISTER_SCAN_INTERVAL_MS = 30000;
 
-class Register {
-    public:
-        int Mode;
-        int convid;
-        int offset;
-        int registryID;
-        int dataSize;
-        int dataType;
-        const char* label;
-        char asString[30];
+// Decoded value of one register. Numeric convids yield NUMBER; lookup tables yield ENUM (the raw table byte, only turned
+// into text when a text sensor or the debug log needs it); convid 100 yields TEXT, which is kept in RegisterState::text
+struct RegisterValue {
+    enum class Kind : uint8_t { NONE, NUMBER, ENUM, TEXT, NOT_AVAILABLE, UNSUPPORTED };
+    Kind kind{Kind::NONE};
+    uint8_t raw{0};
+    float number{NAN};
+};
 
-    Register(int Mode_, int convid_, int offset_, int registryID_,
-             int dataSize_, int dataType_, const char* label_)
-        : Mode(Mode_), convid(convid_), offset(offset_),
-          registryID(registryID_), dataSize(dataSize_),
-          dataType(dataType_), label(label_) {
-        asString[0] = '\0';
-    }
+// One row of the register table. __init__.py generates the whole table as a constexpr array (sorted by registryID, then offset),
+// so it lives in flash; only RegisterState is kept in RAM
+struct RegisterDef {
+    const char* label;
+    uint16_t convid;
+    uint8_t registryID;
+    uint8_t offset;
+    uint8_t dataSize;
+    int8_t dataType;
+    uint8_t Mode;  // 0 = decoded on demand, 1 = decoded with every frame and published; the X10A protocol has no write request,
+                   // so there is no write mode
 };
 
+// Size of the buffer a convid 100 register decodes its text into
+inline constexpr size_t REGISTER_TEXT_SIZE = 30;
 
+// Mutable part of a register, one per RegisterDef
+struct RegisterState {
+    RegisterValue value;
+    RegisterValue published;  // last value sent to the sensor, for change detection
+    char* text{nullptr};      // REGISTER_TEXT_SIZE bytes for convid 100 registers only, nullptr otherwise; the published text follows
+    uint32_t decoded_at{0};   // frame generation of its registry that value was decoded from
+};
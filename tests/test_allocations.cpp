@@ -0,0 +1,197 @@
+// Zero allocations on the receive path: once every registry has answered once (its frame cache is sized then), polling, receiving,
+// resynchronising and decoding frames does not touch the heap, whatever the heat pump sends. Counted with an operator new hook, like
+// tools/x10a_soak does
+
+#include "x10a_test.h"
+#include "x10a_rig.h"
+
+#include <cstdlib>
+#include <new>
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+//__________________________________________________________________________________________________________________________ heap begin
+static bool counting = false;
+static uint64_t allocations = 0;
+
+static void *test_alloc(size_t size) {
+  if (counting) allocations++;
+  void *ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new(size_t size) { return test_alloc(size); }
+void *operator new[](size_t size) { return test_alloc(size); }
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+
+struct Uncounted {
+  bool was{counting};
+  Uncounted() { counting = false; }
+  ~Uncounted() { counting = was; }
+};
+
+// The heat pump is test equipment: what it allocates to queue its answers is not the component's
+class HeatPump : public SimulatedHeatPump {
+ public:
+  using SimulatedHeatPump::SimulatedHeatPump;
+  void write_array(const uint8_t *data, size_t len) override {
+    Uncounted uncounted;
+    SimulatedHeatPump::write_array(data, len);
+  }
+  int available() override {
+    Uncounted uncounted;
+    return SimulatedHeatPump::available();
+  }
+  bool read_array(uint8_t *data, size_t len) override {
+    Uncounted uncounted;
+    return SimulatedHeatPump::read_array(data, len);
+  }
+};
+
+// Allocations made during duration_us of loop() passes. The temperatures move every second, so most frames are new; the texts stay
+// short, since a text past std::string's inline capacity allocates in TextSensor::publish_state(), on ESPHome as much as here
+static uint64_t allocations_while_running(DaikinX10A &component, HeatPump &hp, uint64_t duration_us) {
+  const uint64_t before = allocations;
+  for (uint64_t t = 0; t < duration_us; t += US_PER_S) {
+    counting = true;
+    host_run({&component}, US_PER_S, US_PER_MS);
+    counting = false;
+    hp.payload(0x10)[1]++;
+    hp.payload(0x20)[0]--;
+  }
+  return allocations - before;
+}
+//________________________________________________________________ heap end
+
+struct Rig : BasicHostRig<HeatPump> {
+  sensor::Sensor lwt, flow, iwt;
+  text_sensor::TextSensor mode, error;
+
+  Rig() {
+    table.add("Operation Mode", 0x10, 0, 217, 1);
+    table.add("Leaving water temp. before BUH (R1T)", 0x10, 1, 105, 2);
+    table.add("Flow sensor (l/min)", 0x10, 3, 152, 2);
+    table.add("Hidden", 0x10, 5, 105, 2, 0);  // decoded on demand only
+    table.add("Inlet water temp.(R4T)", 0x20, 0, 105, 2);
+    table.add("Error code", 0x20, 2, 204, 1);
+    hp.set_payload(0x10, {0x01, 0x63, 0x01, 0x00, 0x2A, 0x10, 0x00});
+    hp.set_payload(0x20, {0x2C, 0x01, 0x00});
+    attach(1000);
+    component.set_publish_max_age(5000);
+    component.bind_text_sensor(0, &mode);
+    component.bind_sensor(1, &lwt);
+    component.bind_sensor(2, &flow);
+    component.bind_sensor(4, &iwt);
+    component.bind_text_sensor(5, &error);
+  }
+  // Boot and the first sweep, which size the frame caches
+  void boot() {
+    component.setup();
+    run(2 * US_PER_S, US_PER_MS);
+  }
+};
+
+//__________________________________________________________________________________________________________________________ receive path begin
+static void polling_does_not_allocate() {
+  Rig rig;
+  rig.boot();
+  const uint64_t requests = rig.hp.requests();
+  CHECK_EQ(allocations_while_running(rig.component, rig.hp, 60 * US_PER_S), 0u);
+  CHECK(rig.hp.requests() > requests + 60);
+  CHECK(rig.lwt.publishes > 1u);
+}
+
+static void faults_do_not_allocate() {
+  Rig rig;
+  rig.boot();
+  rig.hp.faults = FaultRates{50000, 50000, 50000, 50000, 50000, 50000, 50000};
+  CHECK_EQ(allocations_while_running(rig.component, rig.hp, 120 * US_PER_S), 0u);
+  CHECK(rig.component.get_crc_mismatches() > 0u);
+  CHECK(rig.component.get_timeouts() > 0u);
+  CHECK(rig.component.get_error_frames() > 0u);
+  CHECK(rig.component.get_wrong_registry_frames() > 0u);
+}
+
+// A byte stream that is mostly garbage, with frames of both registries in it. The poller only reads while a request is in flight, so
+// the registries are polled back to back
+static void garbage_on_the_line_does_not_allocate() {
+  Rig rig;
+  rig.attach(50, 1);
+  rig.boot();
+  Random random(7);
+  std::vector<uint8_t> line;
+  for (int i = 0; i < 2000; i++) {
+    if (random.below(20) == 0) {
+      const uint8_t registry_id = random.below(2) ? 0x10 : 0x20;
+      const auto frame = SimulatedHeatPump::make_frame(registry_id, rig.hp.payload(registry_id));
+      line.insert(line.end(), frame.begin(), frame.end());
+    } else {
+      line.push_back((uint8_t)(random.below(3) == 0 ? 0x40 : random.below(256)));
+    }
+  }
+  rig.hp.inject(line, host_clock_us.load());
+  const uint32_t received = rig.component.get_bytes_received();
+  CHECK_EQ(allocations_while_running(rig.component, rig.hp, 60 * US_PER_S), 0u);
+  CHECK(rig.component.get_bytes_received() - received >= line.size());
+}
+
+static void decoding_on_demand_does_not_allocate() {
+  Rig rig;
+  rig.boot();
+  const auto hidden = rig.component.find_register("Hidden");
+  counting = true;
+  const uint64_t before = allocations;
+  for (int i = 0; i < 100; i++) {
+    (void) rig.component.get_register_float(hidden);
+    (void) rig.component.get_register_text(hidden);
+  }
+  counting = false;
+  CHECK_EQ(allocations - before, 0u);
+  CHECK_NEAR(rig.component.get_register_float(hidden), 1.6, 1e-4);
+}
+//________________________________________________________________ receive path end
+
+//__________________________________________________________________________________________________________________________ frames begin
+static void frames_and_stream_decoder_do_not_allocate() {
+  std::vector<uint8_t> bytes = SimulatedHeatPump::make_frame(0x61, std::vector<uint8_t>(200, 0x5A));
+  bytes.insert(bytes.begin(), {0x40, 0x99, 0x15});
+  daikin_stream_decoder<512> decoder;
+  daikin_package frame(daikin_package::Mode::RECEIVE);
+  char hex[daikin_package::HEX_BUFFER_SIZE];
+  int frames = 0;
+
+  counting = true;
+  const uint64_t before = allocations;
+  for (int i = 0; i < 100; i++) {
+    decoder.feed(bytes.data(), bytes.size());
+    for (;;) {
+      const auto result = decoder.next(frame);
+      if (result == daikin_stream_decoder<512>::Result::NEED_MORE) break;
+      if (result == daikin_stream_decoder<512>::Result::FRAME) {
+        frames++;
+        frame.to_hex(hex, sizeof(hex));
+      }
+    }
+    decoder.resync();
+    auto request = daikin_package::MakeRequest(0x61);
+    (void) request;
+  }
+  counting = false;
+  CHECK_EQ(allocations - before, 0u);
+  CHECK_EQ(frames, 100);
+}
+//________________________________________________________________ frames end
+
+int main() {
+  RUN_TEST(polling_does_not_allocate);
+  RUN_TEST(faults_do_not_allocate);
+  RUN_TEST(garbage_on_the_line_does_not_allocate);
+  RUN_TEST(decoding_on_demand_does_not_allocate);
+  RUN_TEST(frames_and_stream_decoder_do_not_allocate);
+  return x10a_test_exit();
+}
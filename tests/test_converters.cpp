@@ -0,0 +1,109 @@
+// The converters picked by select_converter_() against the runtime convid switch they replaced (tests/legacy/convert_one_ff16d36.h):
+// for every convid, both widths and all 65536 two-byte inputs, the decoded value is bit for bit the same, and so is its text
+
+#include "x10a_test.h"
+#include "daikin_x10a.h"
+#include "legacy/convert_one_ff16d36.h"
+
+#include <cstring>
+#include <string>
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+// select_converter_() and format_value_() are protected
+class Converters : public DaikinX10A {
+ public:
+  using DaikinX10A::ConvertFn;
+  using DaikinX10A::format_value_;
+  using DaikinX10A::select_converter_;
+};
+
+// Every convid the old switch had a case for, and a few it did not
+static const uint16_t Convids[] = {100, 101, 102, 103, 104, 105, 106, 107, 108, 151, 152, 153, 154, 155, 156, 200, 201, 203, 204, 211,
+                                   217, 300, 301, 302, 303, 304, 305, 306, 307, 312, 315, 316, 401, 402, 403, 404, 405, 406,
+                                   1, 99, 109, 150, 202, 308, 400, 407, 999};
+
+static bool same_float(float a, float b) {
+  if (std::isnan(a) && std::isnan(b)) return true;  // no converter produces a NaN other than NAN
+  return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+// Mismatches of one convid and width over all inputs, the first few reported
+static unsigned compare_convid(uint16_t convid, uint8_t data_size) {
+  const RegisterDef def{"test", convid, 0x10, 0, data_size, -1, 1};
+  const Converters::ConvertFn convert = Converters::select_converter_(def);
+  if (convert == nullptr) {
+    std::printf("convid %u: no converter\n", (unsigned)convid);
+    return 1;
+  }
+  char text_new[REGISTER_TEXT_SIZE], text_old[REGISTER_TEXT_SIZE];
+  char out_new[40], out_old[40];
+  uint8_t data[REGISTER_TEXT_SIZE] = {};
+  unsigned mismatches = 0;
+  for (uint32_t input = 0; input < 0x10000; input++) {
+    data[0] = (uint8_t)input;
+    data[1] = (uint8_t)(input >> 8);
+    RegisterState state_new, state_old;
+    state_new.text = text_new;
+    state_old.text = text_old;
+    convert(def, state_new, data);
+    legacy::convert_one_(def, state_old, data);
+    Converters::format_value_(def, state_new, out_new, sizeof(out_new));
+    legacy::format_value_(def, state_old, out_old, sizeof(out_old));
+
+    const RegisterValue &a = state_new.value, &b = state_old.value;
+    if (a.kind == b.kind && a.raw == b.raw && same_float(a.number, b.number) && std::strcmp(out_new, out_old) == 0) continue;
+    if (mismatches++ < 5) {
+      std::printf("convid %u, size %u, input 0x%04X: kind %d/%d raw %u/%u number %.9g/%.9g text \"%s\"/\"%s\"\n", (unsigned)convid,
+                  (unsigned)data_size, (unsigned)input, (int)a.kind, (int)b.kind, (unsigned)a.raw, (unsigned)b.raw, (double)a.number,
+                  (double)b.number, out_new, out_old);
+    }
+  }
+  return mismatches;
+}
+
+//__________________________________________________________________________________________________________________________ converters begin
+static void every_convid_matches_the_old_switch() {
+  for (uint16_t convid : Convids) {
+    for (uint8_t data_size : {1, 2}) CHECK_EQ(compare_convid(convid, data_size), 0u);
+  }
+}
+
+// Texts are cut at the buffer, wherever the row ends
+static void texts_match_the_old_switch() {
+  for (size_t data_size : {(size_t)3, (size_t)8, (size_t)20, REGISTER_TEXT_SIZE - 1, REGISTER_TEXT_SIZE, (size_t)40}) {
+    CHECK_EQ(compare_convid(100, (uint8_t)data_size), 0u);
+  }
+}
+
+// A text register without its buffer decodes to nothing, as before
+static void text_without_a_buffer() {
+  const RegisterDef def{"test", 100, 0x21, 0, 8, -1, 1};
+  const uint8_t data[8] = {'I', 'D', '6', '6', 'F', '2', 0, 0};
+  RegisterState state_new, state_old;
+  Converters::select_converter_(def)(def, state_new, data);
+  legacy::convert_one_(def, state_old, data);
+  CHECK(state_new.value.kind == RegisterValue::Kind::NONE);
+  CHECK(state_old.value.kind == RegisterValue::Kind::NONE);
+  CHECK(std::isnan(state_new.value.number));
+}
+
+// convid 0x00 never produced a value; it has no converter and is left out of the decode plan
+static void convid_zero_has_no_converter() {
+  const RegisterDef def{"test", 0x00, 0x10, 0, 2, -1, 1};
+  CHECK(Converters::select_converter_(def) == nullptr);
+  const uint8_t data[2] = {0x12, 0x34};
+  RegisterState state;
+  legacy::convert_one_(def, state, data);
+  CHECK(state.value.kind == RegisterValue::Kind::NONE);
+}
+//________________________________________________________________ converters end
+
+int main() {
+  RUN_TEST(every_convid_matches_the_old_switch);
+  RUN_TEST(texts_match_the_old_switch);
+  RUN_TEST(text_without_a_buffer);
+  RUN_TEST(convid_zero_has_no_converter);
+  return x10a_test_exit();
+}
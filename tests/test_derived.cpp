@@ -0,0 +1,146 @@
+// Derived metrics (daikin_derived.cpp) on frames polled from the simulated heat pump: a formula follows its input and is evaluated
+// when that changed, while the trapezoid integral of it gets a sample with every frame, identical ones included, leaves out gaps
+// longer than max_gap and continues after a reboot from the total kept in flash
+
+#include "x10a_test.h"
+#include "x10a_rig.h"
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+static constexpr uint32_t EnergyKey = 0x5EED0001;
+
+// power = max(0, the register), energy = its integral in kWh
+struct Rig : HostRig {
+  sensor::Sensor power, energy;
+  DerivedOp ops[3] = {{DerivedOp::CONST, 0, 0.0f}, {DerivedOp::REGISTER, 0, 0}, {DerivedOp::MAX, 0, 0}};
+  DerivedDef defs[2] = {{0, 3, DERIVED_NO_METRIC, 0, 0}, {0, 0, 0, 15 * 60000, EnergyKey}};
+
+  explicit Rig(uint32_t max_gap_ms = 15 * 60000, uint32_t restore_key = EnergyKey) {
+    table.add("Heat pump power (kW)", 0x10, 0, 105, 2);
+    hp.set_payload(0x10, {20, 0, 0});  // 2.0 kW
+    defs[1].max_gap_ms = max_gap_ms;
+    defs[1].restore_key = restore_key;
+    attach(10000);
+    component.set_derived_metrics(ops, defs, 2);
+    component.bind_derived_sensor(0, &power);
+    component.bind_derived_sensor(1, &energy);
+    component.setup();
+  }
+  float kwh() const { return component.get_derived_value(1); }
+};
+
+//__________________________________________________________________________________________________________________________ derived begin
+// The frames stay identical for the whole hour, so nothing is decoded after the first one; the integral still gets every poll
+static void constant_power_integrates() {
+  Rig rig;
+  rig.run(US_PER_HOUR);
+  CHECK(rig.hp.requests() > 90u);  // every 10 to 40 s, the backoff of identical frames
+  CHECK_NEAR(rig.power.state, 2.0, 1e-4);
+  CHECK_EQ(rig.power.publishes, 1u);
+  CHECK_NEAR(rig.kwh(), 2.0, 2.0 * 40.0 / 3600.0);
+  CHECK_NEAR(rig.energy.state, rig.kwh(), 1e-6);
+}
+
+// Trapezoids: a step from 2 kW to 4 kW is averaged over the poll it falls in
+static void power_step_is_time_weighted() {
+  Rig rig;
+  rig.component.set_adaptive_backoff(1);
+  rig.run(US_PER_HOUR);
+  const float first_hour = rig.kwh();
+  rig.hp.payload(0x10)[0] = 40;
+  rig.run(US_PER_HOUR);
+  CHECK_NEAR(rig.power.state, 4.0, 1e-4);
+  CHECK_NEAR(rig.kwh() - first_hour, 4.0, 4.0 * 20.0 / 3600.0);
+}
+
+// The formula is evaluated when its input register changed, not with every frame of its registry: a value planted in between survives
+// identical frames, and frames in which only other bytes changed
+static void formula_waits_for_its_input() {
+  Rig rig;
+  rig.component.set_adaptive_backoff(1);
+  rig.run(US_PER_MIN);
+  rig.component.derived_value(0) = -1.0f;
+  rig.run(US_PER_MIN);
+  CHECK_EQ(rig.component.get_derived_value(0), -1.0f);
+  rig.hp.payload(0x10)[2] = 1;
+  rig.run(US_PER_MIN);
+  CHECK_EQ(rig.component.get_derived_value(0), -1.0f);
+
+  rig.hp.payload(0x10)[0] = 30;
+  rig.run(US_PER_MIN);
+  CHECK_NEAR(rig.power.state, 3.0, 1e-4);
+  CHECK_EQ(rig.power.publishes, 2u);
+}
+
+// The registry does not answer for 20 minutes: that gap is left out, not bridged by one long trapezoid
+static void gap_is_left_out() {
+  Rig rig(60000);
+  rig.component.set_adaptive_backoff(1);
+  rig.run(20 * US_PER_MIN);
+  rig.hp.set_silent(0x10, true);
+  rig.run(20 * US_PER_MIN);
+  rig.hp.set_silent(0x10, false);
+  rig.run(20 * US_PER_MIN);
+  CHECK_NEAR(rig.kwh(), 2.0 * 40.0 / 60.0, 2.0 * 60.0 / 3600.0);
+}
+
+// The total is saved every minute and restored in setup(), published before the first frame
+static void total_survives_a_reboot() {
+  float saved;
+  {
+    Rig rig;
+    rig.run(US_PER_HOUR + US_PER_MIN);
+    global_preferences->sync();
+    saved = rig.kwh();
+    CHECK(saved > 1.9f);
+  }
+  host_reset(true);
+
+  Rig rig;
+  CHECK_EQ(rig.energy.publishes, 1u);
+  CHECK_NEAR(rig.energy.state, saved, 2.0 * 60.0 / 3600.0);
+  rig.run(US_PER_HOUR);
+  CHECK_NEAR(rig.kwh(), saved + 2.0, 2.0 * 120.0 / 3600.0);
+}
+
+// Without a restore key the integral starts at 0 with every boot
+static void total_without_a_key() {
+  {
+    Rig rig(15 * 60000, 0);
+    rig.run(10 * US_PER_MIN);
+    global_preferences->sync();
+    CHECK(host_flash.committed.empty());
+  }
+  host_reset(true);
+  Rig rig(15 * 60000, 0);
+  CHECK_EQ(rig.energy.publishes, 0u);
+  CHECK(std::isnan(rig.kwh()));
+}
+
+// With the UART task the frames are marked on its side; identical ones queue nothing, loop() still samples them
+static void task_frames_are_samples() {
+  Rig rig;
+  rig.component.loop();
+  rig.component.task_started();
+  const auto bytes = SimulatedHeatPump::make_frame(0x10, rig.hp.payload(0x10));
+  for (int i = 0; i <= 360; i++) {
+    daikin_package frame = daikin_package::FromBytes(bytes.data(), bytes.size());
+    rig.component.process_frame_(frame);
+    rig.component.loop();
+    host_clock_us.fetch_add(10 * US_PER_S);
+  }
+  CHECK_NEAR(rig.kwh(), 2.0, 1e-3);
+}
+//________________________________________________________________ derived end
+
+int main() {
+  RUN_TEST(constant_power_integrates);
+  RUN_TEST(power_step_is_time_weighted);
+  RUN_TEST(formula_waits_for_its_input);
+  RUN_TEST(gap_is_left_out);
+  RUN_TEST(total_survives_a_reboot);
+  RUN_TEST(total_without_a_key);
+  RUN_TEST(task_frames_are_samples);
+  return x10a_test_exit();
+}
@@ -0,0 +1,81 @@
+// Diagnostics (daikin_diagnostics.cpp) of polls on a simulated heat pump with a fixed latency: the published round trips are the
+// ones measured, percentiles at the bounds of their buckets, and the histogram halves every RoundTrip_DecayCount round trips so p50
+// follows the recent ones while min and max stay since boot
+
+#include "x10a_test.h"
+#include "x10a_rig.h"
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+// One registry, 7 bytes of frame. Polled on a 1 ms loop, a round trip is the latency, the frame's 7 characters and the rest of the
+// loop() in which the last one arrives: latency + 8.416 ms
+struct Rig : HostRig {
+  sensor::Sensor lwt, rtt_min, rtt_p50, rtt_p99, rtt_max, timeouts, bytes_per_second;
+
+  explicit Rig(uint32_t scan_interval_ms) {
+    table.add("Leaving water temp. before BUH (R1T)", 0x10, 0, 105, 2);
+    hp.set_payload(0x10, {0x63, 0x01, 0x00});
+    hp.timing.latency_jitter_us = 0;
+    attach(scan_interval_ms, 1);
+    component.set_diagnostics_interval(24 * 3600000);  // published by the test
+    component.set_round_trip_min_sensor(&rtt_min);
+    component.set_round_trip_p50_sensor(&rtt_p50);
+    component.set_round_trip_p99_sensor(&rtt_p99);
+    component.set_round_trip_max_sensor(&rtt_max);
+    component.set_timeouts_sensor(&timeouts);
+    component.set_bytes_per_second_sensor(&bytes_per_second);
+    component.bind_sensor(0, &lwt);
+    component.setup();
+  }
+  // Runs until the heat pump answered `count` more requests, and until the last answer is read
+  void poll(uint64_t latency_us, uint64_t count) {
+    hp.timing.latency_us = latency_us;
+    const uint64_t target = hp.stats().answers + count;
+    while (hp.stats().answers < target) step(US_PER_MS);
+    run(60 * US_PER_MS, US_PER_MS);
+  }
+};
+
+static constexpr double LoopAndFrameMs = 8.416;
+
+//__________________________________________________________________________________________________________________________ diagnostics begin
+static void round_trips_as_measured() {
+  Rig rig(1000);
+  rig.poll(10 * US_PER_MS, 59);
+  rig.poll(40 * US_PER_MS, 1);
+  rig.component.publish_diagnostics_();
+  CHECK_NEAR(rig.rtt_min.state, 10 + LoopAndFrameMs, 1e-3);
+  CHECK_NEAR(rig.rtt_p50.state, 20.0, 1e-3);  // the bound of the 10 to 20 ms bucket
+  CHECK_NEAR(rig.rtt_p99.state, 40 + LoopAndFrameMs, 1e-3);  // in the 40 to 50 ms bucket, capped at the largest one seen
+  CHECK_NEAR(rig.rtt_max.state, 40 + LoopAndFrameMs, 1e-3);
+  CHECK_EQ(rig.timeouts.state, 0.0f);
+  CHECK_NEAR(rig.bytes_per_second.state, 7.0, 0.2);  // one frame a second
+  CHECK_EQ(rig.component.get_timeouts(), 0u);
+}
+
+// 1000 slow round trips, then 524 fast ones. Without the decay the slow ones would still be the majority; the halving after 1024 leaves
+// 500 slow against 512 fast
+static void histogram_decays() {
+  Rig rig(100);
+  rig.poll(40 * US_PER_MS, 1000);
+  rig.component.publish_diagnostics_();
+  CHECK_NEAR(rig.rtt_p50.state, 40 + LoopAndFrameMs, 1e-3);
+
+  rig.poll(10 * US_PER_MS, 24);
+  rig.component.publish_diagnostics_();
+  CHECK_NEAR(rig.rtt_p50.state, 40 + LoopAndFrameMs, 1e-3);
+  rig.poll(10 * US_PER_MS, 500);
+  rig.component.publish_diagnostics_();
+  CHECK_NEAR(rig.rtt_p50.state, 20.0, 1e-3);
+  CHECK_NEAR(rig.rtt_min.state, 10 + LoopAndFrameMs, 1e-3);
+  CHECK_NEAR(rig.rtt_max.state, 40 + LoopAndFrameMs, 1e-3);
+  CHECK_EQ(rig.component.get_timeouts(), 0u);
+}
+//________________________________________________________________ diagnostics end
+
+int main() {
+  RUN_TEST(round_trips_as_measured);
+  RUN_TEST(histogram_decays);
+  return x10a_test_exit();
+}
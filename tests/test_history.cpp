@@ -0,0 +1,288 @@
+// History (daikin_history.h, daikin_history.cpp) filled from frames polled from the simulated heat pump and read back the way a user
+// would: GET /history.csv from the component's HTTP port and export_history() in binary to a TCP listener, both on 127.0.0.1. Both
+// carry the samples the sensor saw, and the same ones
+
+#include "x10a_test.h"
+#include "x10a_rig.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+static const char *const FlowLabel = "Flow, \"l/min\"";  // quoted in the CSV
+
+//__________________________________________________________________________________________________________________________ sockets begin
+static uint16_t bound_port(socket::Socket &socket) {
+  struct sockaddr_storage addr;
+  socklen_t len = sizeof(addr);
+  ::getsockname(socket.get_fd(), reinterpret_cast<struct sockaddr *>(&addr), &len);
+  return ntohs(reinterpret_cast<struct sockaddr_in *>(&addr)->sin_port);
+}
+
+static std::unique_ptr<socket::Socket> tcp_listener() {
+  auto socket = socket::socket_ip(SOCK_STREAM, 0);
+  struct sockaddr_storage addr;
+  const socklen_t len = socket::set_sockaddr(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr), "127.0.0.1", 0);
+  if (socket->bind(reinterpret_cast<struct sockaddr *>(&addr), len) != 0 || socket->listen(1) != 0) return nullptr;
+  return socket;
+}
+
+// A port nobody listens on right now, for the component's HTTP server
+static uint16_t free_port() {
+  auto socket = tcp_listener();
+  return socket == nullptr ? 0 : bound_port(*socket);
+}
+
+// Runs loop() without moving the clock until the peer closes; returns everything it sent
+static std::string read_until_closed(DaikinX10A &component, socket::Socket &socket) {
+  socket.setblocking(false);
+  std::string received;
+  char buffer[4096];
+  for (int pass = 0; pass < 100000; pass++) {
+    component.loop();
+    const ssize_t n = socket.read(buffer, sizeof(buffer));
+    if (n == 0) break;
+    if (n > 0) received.append(buffer, (size_t)n);
+  }
+  return received;
+}
+
+static std::string http_get(DaikinX10A &component, uint16_t port, const char *path) {
+  auto client = socket::socket_ip(SOCK_STREAM, 0);
+  struct sockaddr_storage addr;
+  const socklen_t len = socket::set_sockaddr(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr), "127.0.0.1", port);
+  if (client->connect(reinterpret_cast<struct sockaddr *>(&addr), len) != 0) return "";
+  const std::string request = std::string("GET ") + path + " HTTP/1.1\r\nHost: x10a\r\n\r\n";
+  client->write(request.data(), request.size());
+  return read_until_closed(component, *client);
+}
+//________________________________________________________________ sockets end
+
+//__________________________________________________________________________________________________________________________ formats begin
+struct Row {
+  std::string label, tier, age, value, min, max;
+};
+
+// Fields as Python's csv module writes them: quoted when needed, quotes doubled
+static std::vector<std::string> csv_fields(const std::string &line) {
+  std::vector<std::string> fields(1);
+  bool quoted = false;
+  for (size_t i = 0; i < line.size(); i++) {
+    const char c = line[i];
+    if (quoted && c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+      fields.back() += '"';
+      i++;
+    } else if (c == '"') {
+      quoted = !quoted;
+    } else if (c == ',' && !quoted) {
+      fields.emplace_back();
+    } else {
+      fields.back() += c;
+    }
+  }
+  return fields;
+}
+
+// The rows after the header line
+static std::vector<Row> csv_rows(const std::string &body) {
+  std::vector<Row> rows;
+  size_t start = body.find('\n') + 1;
+  while (start < body.size()) {
+    const size_t end = body.find('\n', start);
+    const std::string line = body.substr(start, end - start);
+    start = end == std::string::npos ? body.size() : end + 1;
+    const auto fields = csv_fields(line);
+    if (fields.size() == 6) rows.push_back(Row{fields[0], fields[1], fields[2], fields[3], fields[4], fields[5]});
+  }
+  return rows;
+}
+
+static uint32_t u32(const uint8_t *p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+static float f32(const uint8_t *p) {
+  const uint32_t bits = u32(p);
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// The binary form written as the CSV rows it stands for, like tools/x10a_history.py does; empty when it is malformed
+static std::vector<Row> binary_rows(const std::string &data) {
+  const auto *p = reinterpret_cast<const uint8_t *>(data.data());
+  const size_t size = data.size();
+  if (size < 4 || p[0] != 'X' || p[1] != 'H' || p[2] != daikin_history_export::VERSION) return {};
+  std::vector<std::string> labels(p[3]);
+  std::vector<int> decimals(p[3]);
+  std::vector<Row> rows;
+  auto number = [&decimals](uint8_t series, float value) {
+    if (std::isnan(value)) return std::string();
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.*f", decimals[series], (double)value);
+    return std::string(text);
+  };
+  size_t at = 4;
+  while (at < size) {
+    const uint8_t type = p[at], series = p[at + 1];
+    if (series >= labels.size()) return {};
+    if (type == 0) {
+      decimals[series] = p[at + 2];
+      labels[series].assign(data, at + 4, p[at + 3]);
+      at += 4 + p[at + 3];
+    } else if (type == 1) {
+      const uint32_t age_ms = u32(p + at + 2);
+      rows.push_back(Row{labels[series], "raw", std::to_string(age_ms / 1000) + "." + std::to_string(age_ms % 1000 / 100),
+                         number(series, f32(p + at + 6)), "", ""});
+      at += 10;
+    } else if (type == 2 || type == 3) {
+      rows.push_back(Row{labels[series], type == 2 ? "1min" : "15min", std::to_string(u32(p + at + 2) / 1000),
+                         number(series, f32(p + at + 10)), number(series, f32(p + at + 6)), number(series, f32(p + at + 14))});
+      at += 18;
+    } else {
+      return {};
+    }
+  }
+  return at == size ? rows : std::vector<Row>{};
+}
+
+static bool same_rows(const std::vector<Row> &a, const std::vector<Row> &b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].label != b[i].label || a[i].tier != b[i].tier || a[i].age != b[i].age || a[i].value != b[i].value ||
+        a[i].min != b[i].min || a[i].max != b[i].max)
+      return false;
+  }
+  return true;
+}
+//________________________________________________________________ formats end
+
+// The leaving water temperature steps up by 0.1 every minute, the flow stays at 12.0
+struct Rig : HostRig {
+  sensor::Sensor lwt;
+  uint16_t port;
+
+  Rig() : port(free_port()) {
+    table.add("Leaving water temp. before BUH (R1T)", 0x10, 0, 105, 2);
+    table.add(FlowLabel, 0x10, 2, 105, 2, 0);
+    hp.set_payload(0x10, {200, 0, 120, 0, 0});
+    attach(10000, 1);
+    component.bind_sensor(0, &lwt);
+    component.set_history_storage(4096, 60, 8, 0.1f, 900000, false);
+    component.add_history_register(0);
+    component.add_history_register(1);
+    component.set_history_http_port(port);
+    component.setup();
+  }
+  void run_minutes(int minutes) {
+    for (int i = 0; i < minutes; i++) {
+      run(US_PER_MIN);
+      hp.payload(0x10)[0]++;
+    }
+  }
+};
+
+//__________________________________________________________________________________________________________________________ history begin
+static void csv_over_http() {
+  Rig rig;
+  CHECK(rig.port != 0);
+  rig.run_minutes(30);
+  CHECK_NEAR(rig.lwt.state, 22.9, 1e-4);
+
+  const std::string response = http_get(rig.component, rig.port, "/history.csv");
+  CHECK_EQ(response.compare(0, 15, "HTTP/1.1 200 OK"), 0);
+  CHECK(response.find("Content-Type: text/csv\r\n") != std::string::npos);
+  const size_t body = response.find("\r\n\r\n");
+  CHECK(body != std::string::npos);
+  if (body == std::string::npos) return;
+  CHECK_EQ(response.compare(body + 4, 34, "register,tier,age_s,value,min,max\n"), 0);
+
+  // Every value the sensor had, oldest first, each from the first frame after the step
+  const auto rows = csv_rows(response.substr(body + 4));
+  std::vector<std::string> lwt_raw;
+  unsigned flow_raw = 0, lwt_minutes = 0;
+  for (const auto &row : rows) {
+    if (row.label == rig.table.rows[0].label && row.tier == "raw") lwt_raw.push_back(row.value);
+    if (row.label == FlowLabel && row.tier == "raw") flow_raw++;
+    if (row.label == FlowLabel) CHECK(row.value == "12.0" || row.tier == "raw");
+    if (row.label == rig.table.rows[0].label && row.tier == "1min") {
+      lwt_minutes++;
+      CHECK(std::atof(row.min.c_str()) <= std::atof(row.value.c_str()) && std::atof(row.value.c_str()) <= std::atof(row.max.c_str()));
+    }
+  }
+  CHECK_EQ(lwt_raw.size(), 30u);
+  for (size_t i = 0; i < lwt_raw.size(); i++) {
+    char expected[16];
+    std::snprintf(expected, sizeof(expected), "%.1f", 20.0 + 0.1 * (double)i);
+    CHECK_EQ(lwt_raw[i], std::string(expected));
+  }
+  CHECK(flow_raw >= 1u);
+  CHECK(lwt_minutes >= 29u);
+}
+
+// export_history() pushes the binary form; it holds exactly the rows of the CSV, the ages included since the clock stands still
+static void binary_export_matches_the_csv() {
+  Rig rig;
+  rig.run_minutes(20);
+  const std::string response = http_get(rig.component, rig.port, "/history.csv");
+  const size_t body = response.find("\r\n\r\n");
+  CHECK(body != std::string::npos);
+  if (body == std::string::npos) return;
+  const auto csv = csv_rows(response.substr(body + 4));
+
+  auto listener = tcp_listener();
+  CHECK(listener != nullptr);
+  if (listener == nullptr) return;
+  CHECK(rig.component.export_history("127.0.0.1", bound_port(*listener), true));
+  CHECK(!rig.component.export_history("127.0.0.1", bound_port(*listener), true));  // one export at a time
+  rig.component.loop();
+  auto connection = listener->accept(nullptr, nullptr);
+  CHECK(connection != nullptr);
+  if (connection == nullptr) return;
+  const auto binary = binary_rows(read_until_closed(rig.component, *connection));
+
+  CHECK(csv.size() > 40u);
+  CHECK(same_rows(binary, csv));
+}
+
+// Only the two paths, with a query or without: anything else gets a short text page
+static void unknown_path() {
+  Rig rig;
+  rig.run_minutes(2);
+  for (const char *path : {"/index.html", "/history.csvX", "/history.binary", "/history"}) {
+    const std::string response = http_get(rig.component, rig.port, path);
+    CHECK_EQ(response.compare(0, 22, "HTTP/1.1 404 Not Found"), 0);
+    CHECK(response.find("Content-Type: text/plain\r\n") != std::string::npos);
+    CHECK(response.find("/history.csv") != std::string::npos);
+  }
+  const std::string response = http_get(rig.component, rig.port, "/history.csv?tier=0");
+  CHECK_EQ(response.compare(0, 15, "HTTP/1.1 200 OK"), 0);
+}
+
+// A client that hangs up before its request is dropped at once, not after the idle timeout: the next one is served without the clock
+// moving
+static void client_gone_before_the_request() {
+  Rig rig;
+  rig.run_minutes(2);
+  {
+    auto client = socket::socket_ip(SOCK_STREAM, 0);
+    struct sockaddr_storage addr;
+    const socklen_t len = socket::set_sockaddr(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr), "127.0.0.1", rig.port);
+    CHECK_EQ(client->connect(reinterpret_cast<struct sockaddr *>(&addr), len), 0);
+  }
+  rig.component.loop();
+  rig.component.loop();
+  const std::string response = http_get(rig.component, rig.port, "/history.csv");
+  CHECK_EQ(response.compare(0, 15, "HTTP/1.1 200 OK"), 0);
+}
+//________________________________________________________________ history end
+
+int main() {
+  RUN_TEST(csv_over_http);
+  RUN_TEST(binary_export_matches_the_csv);
+  RUN_TEST(unknown_path);
+  RUN_TEST(client_gone_before_the_request);
+  return x10a_test_exit();
+}
@@ -0,0 +1,124 @@
+// Two heat pumps on one node: two components, each on its own simulated heat pump, run by the same host_run() like App.loop() runs
+// them. Every value stays with its instance, the two sweeps run side by side instead of one after the other, and the warm start
+// records are kept per instance name
+
+#include "x10a_test.h"
+#include "x10a_rig.h"
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+static constexpr uint8_t Registries[] = {0x10, 0x11, 0x20, 0x21, 0x30, 0x60, 0x61, 0x62};
+
+// One heat pump: a register per registry, every payload starting with base + the registry id (tenths of a degree)
+struct Pump : HostRig {
+  sensor::Sensor sensors[sizeof(Registries)];
+
+  Pump(const char *name, uint8_t base) : HostRig(base) {
+    for (const uint8_t registry_id : Registries) {
+      table.add(("Temp " + std::to_string(registry_id)).c_str(), registry_id, 0, 105, 2);
+      hp.set_payload(registry_id, {(uint8_t)(base + registry_id), 0, 0});
+    }
+    attach(10000, 1);
+    component.set_instance_name(name);
+    for (uint16_t handle = 0; handle < table.rows.size(); handle++) component.bind_sensor(handle, &sensors[handle]);
+  }
+  bool swept() const { return hp.stats().answers >= sizeof(Registries); }
+  float expected(uint16_t handle, uint8_t base) const { return (float)(base + table.rows[handle].registryID) / 10.0f; }
+};
+
+// Loops until every pump in the list answered a whole sweep; returns the virtual time it took
+static uint64_t sweep_time(std::initializer_list<Component *> components, std::initializer_list<const Pump *> pumps) {
+  const uint64_t start = host_clock_us.load();
+  for (int pass = 0; pass < 100000; pass++) {
+    bool done = true;
+    for (const Pump *pump : pumps) done = done && pump->swept();
+    if (done) break;
+    host_loop(components);
+    host_clock_us.fetch_add(US_PER_MS);
+  }
+  return host_clock_us.load() - start;
+}
+
+//__________________________________________________________________________________________________________________________ instances begin
+static void values_stay_per_instance() {
+  Pump first("daikin_comp", 100), second("daikin_comp2", 150);
+  first.component.setup();
+  second.component.setup();
+  host_run({&first.component, &second.component}, 30 * US_PER_S);
+  for (uint16_t handle = 0; handle < first.table.rows.size(); handle++) {
+    CHECK_NEAR(first.sensors[handle].state, first.expected(handle, 100), 1e-4);
+    CHECK_NEAR(second.sensors[handle].state, second.expected(handle, 150), 1e-4);
+  }
+  CHECK_NEAR(first.component.get_register_float(first.component.find_register("Temp 16")), 11.6, 1e-4);
+  CHECK_NEAR(second.component.get_register_float(second.component.find_register("Temp 16")), 16.6, 1e-4);
+
+  second.hp.payload(0x10)[0] = 0;
+  host_run({&first.component, &second.component}, 15 * US_PER_S);
+  CHECK_NEAR(first.sensors[0].state, 11.6, 1e-4);
+  CHECK_NEAR(second.sensors[0].state, 0.0, 1e-4);
+}
+
+// Each instance has its own UART and a request in flight at the same time: two sweeps take about as long as one
+static void sweeps_run_side_by_side() {
+  uint64_t alone;
+  {
+    Pump pump("daikin_comp", 100);
+    pump.component.setup();
+    alone = sweep_time({&pump.component}, {&pump});
+    CHECK(pump.swept());
+  }
+  host_reset();
+
+  Pump first("daikin_comp", 100), second("daikin_comp2", 150);
+  first.component.setup();
+  second.component.setup();
+  const uint64_t both = sweep_time({&first.component, &second.component}, {&first, &second});
+  CHECK(first.swept() && second.swept());
+  CHECK(both < alone * 5 / 4);
+}
+
+// A heat pump that stops answering does not hold the other one back
+static void silent_pump_does_not_stall_the_other() {
+  Pump first("daikin_comp", 100), second("daikin_comp2", 150);
+  for (const uint8_t registry_id : Registries) second.hp.set_silent(registry_id, true);
+  first.component.setup();
+  second.component.setup();
+  host_run({&first.component, &second.component}, 60 * US_PER_S);
+  CHECK(first.hp.stats().answers >= 6 * sizeof(Registries));
+  CHECK_EQ(second.hp.stats().answers, 0u);
+  CHECK(second.hp.requests() > 0u);
+  CHECK_EQ(second.sensors[0].publishes, 0u);
+}
+
+// Both instances save their frames under their own key and get their own back after a reboot
+static void warm_start_per_instance() {
+  {
+    Pump first("daikin_comp", 100), second("daikin_comp2", 150);
+    first.component.setup();
+    second.component.setup();
+    host_run({&first.component, &second.component}, 20 * US_PER_S);
+    first.component.on_shutdown();
+    second.component.on_shutdown();
+  }
+  host_reset(true);
+  CHECK_EQ(host_flash.committed.size(), 2 * sizeof(Registries));
+
+  Pump first("daikin_comp", 100), second("daikin_comp2", 150);
+  first.component.setup();
+  second.component.setup();
+  CHECK_EQ(first.hp.requests(), 0u);
+  for (uint16_t handle = 0; handle < first.table.rows.size(); handle++) {
+    CHECK_NEAR(first.sensors[handle].state, first.expected(handle, 100), 1e-4);
+    CHECK_NEAR(second.sensors[handle].state, second.expected(handle, 150), 1e-4);
+  }
+}
+//________________________________________________________________ instances end
+
+int main() {
+  RUN_TEST(values_stay_per_instance);
+  RUN_TEST(sweeps_run_side_by_side);
+  RUN_TEST(silent_pump_does_not_stall_the_other);
+  RUN_TEST(warm_start_per_instance);
+  return x10a_test_exit();
+}
@@ -0,0 +1,392 @@
+// The non-blocking UART poller (poll_uart_()): loop() never waits for the heat pump, one request is in flight at a time, an answer is
+// assembled from whatever bytes each loop() finds, and a registry that does not answer costs one allowance, not a stalled loop(). Also
+// what the poller feeds: the schedule (reschedule_(), next_due_entry_()) and the change detection of publish_register_()
+
+#include "x10a_test.h"
+#include "x10a_rig.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+struct Rig : HostRig {
+  sensor::Sensor lwt, iwt;
+
+  Rig() {
+    table.add("Leaving water temp. before BUH (R1T)", 0x10, 0, 105, 2);
+    table.add("Inlet water temp.(R4T)", 0x20, 0, 105, 2);
+    hp.set_payload(0x10, {0x63, 0x01, 0x00});
+    hp.set_payload(0x20, {0x2C, 0x01, 0x00});
+    hp.timing.latency_jitter_us = 0;
+    attach();
+    component.bind_sensor(0, &lwt);
+    component.bind_sensor(1, &iwt);
+  }
+};
+
+// Both registries have 3 data bytes, 7 bytes of frame: the request (4 bytes), 30 ms latency, then the frame
+static constexpr uint64_t FrameBytes = 7;
+static uint64_t answer_us(uint64_t byte_us) { return 4 * byte_us + 30000 + FrameBytes * byte_us; }
+
+// Request times of one registry in ms, from SimulatedHeatPump::log_requests
+static std::vector<uint64_t> request_ms(const SimulatedHeatPump &hp, uint8_t registry_id) {
+  std::vector<uint64_t> times;
+  for (const auto &request : hp.request_log()) {
+    if (request.registry_id == registry_id) times.push_back(request.at_us / US_PER_MS);
+  }
+  return times;
+}
+
+//__________________________________________________________________________________________________________________________ poller begin
+static void boot_delay() {
+  Rig rig;
+  rig.component.set_boot_delay(15000);
+  rig.component.setup();
+  rig.run(14 * US_PER_S);
+  CHECK_EQ(rig.hp.requests(), 0u);
+  rig.run(2 * US_PER_S);
+  CHECK_EQ(rig.hp.requests(), 2u);
+}
+
+static void loop_returns_while_the_request_is_in_flight() {
+  Rig rig;
+  rig.component.setup();
+  rig.component.loop();
+  CHECK_EQ(rig.hp.requests(), 1u);
+  CHECK(rig.component.awaiting());
+
+  // No time passes: nothing more is sent and nothing is decoded, however often loop() runs
+  for (int i = 0; i < 100; i++) rig.component.loop();
+  CHECK_EQ(rig.hp.requests(), 1u);
+  CHECK_EQ(rig.lwt.publishes, 0u);
+  CHECK_EQ(host_clock_us.load(), 0u);
+}
+
+// The frame trickles in over many loop() passes; the pass that completes it also sends the next request
+static void answer_assembled_across_loops() {
+  Rig rig;
+  rig.component.setup();
+  rig.component.loop();
+  uint64_t elapsed = 0;
+  while (elapsed + 1000 < answer_us(rig.hp.timing.byte_us)) {
+    rig.step(1000);
+    elapsed += 1000;
+    CHECK_EQ(rig.hp.requests(), 1u);
+  }
+  CHECK(rig.hp.line_bytes() < FrameBytes && rig.hp.line_bytes() > 0u);  // part of the frame is read already
+  CHECK_EQ(rig.lwt.publishes, 0u);
+
+  rig.step(1000);
+  CHECK_NEAR(rig.lwt.state, 35.5, 1e-4);
+  CHECK_EQ(rig.hp.requests(), 2u);
+  CHECK(rig.component.awaiting());
+  CHECK_EQ(rig.component.get_bytes_received(), FrameBytes);
+}
+
+static void one_request_in_flight() {
+  Rig rig;
+  rig.hp.timing.latency_jitter_us = 30000;
+  rig.hp.timing.byte_jitter_us = 2000;
+  rig.attach(1000, 1);
+  rig.component.setup();
+  uint64_t requests = 0;
+  for (int i = 0; i < 10000; i++) {
+    rig.step(1000);
+    if (rig.hp.requests() == requests) continue;
+    // A request goes out only once the previous answer is read completely: the line holds the new answer and nothing else
+    CHECK_EQ(rig.hp.requests(), requests + 1);
+    CHECK_EQ(rig.hp.line_bytes(), FrameBytes);
+    requests = rig.hp.requests();
+  }
+  CHECK_EQ(rig.component.get_timeouts(), 0u);
+  CHECK(rig.hp.requests() >= 18u);  // both registries, every second
+}
+
+// A silent registry times out once the first-byte allowance (300 ms until a latency is measured) has passed, and only then
+static void timeout_after_the_allowance() {
+  Rig rig;
+  rig.hp.set_silent(0x10, true);
+  rig.component.setup();
+  rig.component.loop();
+  for (int i = 0; i < 290; i++) rig.step(1000);
+  CHECK_EQ(rig.component.get_timeouts(), 0u);
+  CHECK_EQ(rig.hp.requests(), 1u);
+  for (int i = 0; i < 30; i++) rig.step(1000);
+  CHECK_EQ(rig.component.get_timeouts(), 1u);
+  CHECK_EQ(rig.hp.requests(), 2u);  // on to 0x20 in the same loop()
+
+  rig.run(2 * US_PER_S, 1000);
+  CHECK_NEAR(rig.iwt.state, 30.0, 1e-4);
+}
+
+// An answer past the allowance lands while the next registry is awaited: it is decoded as its own registry all the same
+static void late_answer_is_decoded() {
+  Rig rig;
+  rig.hp.faults.late = 1000000;
+  rig.component.setup();
+  rig.run(2 * US_PER_S, 1000);
+  CHECK(rig.component.get_timeouts() >= 1u);
+  CHECK(rig.component.get_wrong_registry_frames() >= 1u);
+  CHECK_NEAR(rig.lwt.state, 35.5, 1e-4);
+}
+
+static void fetch_registers_makes_every_registry_due() {
+  Rig rig;
+  rig.component.setup();
+  rig.run(1 * US_PER_S, 1000);
+  CHECK_EQ(rig.hp.requests(), 2u);
+  CHECK(rig.component.idle());
+
+  rig.component.FetchRegisters();
+  rig.run(1 * US_PER_S, 1000);
+  CHECK_EQ(rig.hp.requests(), 4u);
+}
+//________________________________________________________________ poller end
+
+//__________________________________________________________________________________________________________________________ line speed begin
+static constexpr uint32_t BaudRates[] = {2400, 9600};
+
+// The receive deadline is counted in characters of the line setup() found: the request, the 300 ms first-byte allowance and three
+// characters of slack. The request for the next registry leaves in the loop() that gives up
+static void deadline_follows_the_baud_rate() {
+  for (const uint32_t baud : BaudRates) {
+    host_reset();
+    Rig rig;
+    rig.hp.set_baud(baud);
+    rig.hp.set_silent(0x10, true);
+    rig.component.setup();
+    rig.component.loop();
+    const uint64_t deadline_us = 4 * rig.hp.timing.byte_us + 300 * US_PER_MS + 3 * rig.hp.timing.byte_us;
+    while (rig.component.get_timeouts() == 0 && host_clock_us.load() < US_PER_S) rig.step(1000);
+    CHECK(host_clock_us.load() >= deadline_us);
+    CHECK(host_clock_us.load() < deadline_us + 1000);
+    CHECK_EQ(rig.hp.requests(), 2u);
+  }
+}
+
+// The pass that reads the last byte of a frame decodes it and sends the next request; at 2400 baud that is 4 times later than at 9600
+static void next_request_with_the_last_byte() {
+  for (const uint32_t baud : BaudRates) {
+    host_reset();
+    Rig rig;
+    rig.hp.set_baud(baud);
+    rig.component.setup();
+    rig.component.loop();
+    while (rig.lwt.publishes == 0 && host_clock_us.load() < US_PER_S) {
+      CHECK_EQ(rig.hp.requests(), 1u);
+      rig.step(1000);
+    }
+    const uint64_t answer = answer_us(rig.hp.timing.byte_us);
+    CHECK(host_clock_us.load() >= answer);
+    CHECK(host_clock_us.load() < answer + 1000);
+    CHECK_EQ(rig.hp.requests(), 2u);
+  }
+}
+
+// A frame that takes longer on the wire than the first-byte allowance: once its header is in, the deadline is where its last byte is due
+static void long_frame_at_2400_baud() {
+  Rig rig;
+  rig.table.add("Software version", 0x21, 0, 100, 8);
+  rig.attach();
+  text_sensor::TextSensor software;
+  rig.component.bind_text_sensor(2, &software);
+  std::vector<uint8_t> data(100, 0);
+  std::memcpy(data.data(), "ID66F2", 6);
+  rig.hp.set_payload(0x21, data);
+  rig.hp.set_baud(2400);
+  rig.component.setup();
+  rig.run(2 * US_PER_S, 1000);
+  CHECK(104 * rig.hp.timing.byte_us > 300 * US_PER_MS);
+  CHECK_EQ(rig.component.get_timeouts(), 0u);
+  CHECK_EQ(software.state, std::string("ID66F2"));
+}
+//________________________________________________________________ line speed end
+
+//__________________________________________________________________________________________________________________________ schedule begin
+// Identical frames double a registry's interval up to the adaptive backoff (4 by default), a frame that changed brings it back to the
+// scan interval
+static void backoff_on_identical_frames() {
+  Rig rig;
+  rig.hp.log_requests = true;
+  rig.component.setup();
+  rig.run(7 * US_PER_MIN, 1000);
+  rig.hp.payload(0x10)[0] = 0x64;
+  rig.run(2 * US_PER_MIN + 30 * US_PER_S, 1000);
+
+  const std::vector<uint64_t> times = request_ms(rig.hp, 0x10);
+  const uint64_t expected[] = {30000, 60000, 120000, 120000, 120000, 30000, 60000};
+  CHECK_EQ(times.size(), 8u);
+  for (size_t i = 0; i + 1 < times.size() && i < 7; i++) CHECK_NEAR(times[i + 1] - times[i], expected[i], 1);
+  CHECK_NEAR(rig.lwt.state, 35.6, 1e-4);
+}
+
+// Without backoff every registry is asked once per scan interval, whatever it answers
+static void no_backoff() {
+  Rig rig;
+  rig.hp.log_requests = true;
+  rig.attach(10000, 1);
+  rig.component.setup();
+  rig.run(2 * US_PER_MIN, 1000);
+  const std::vector<uint64_t> times = request_ms(rig.hp, 0x20);
+  CHECK_EQ(times.size(), 12u);
+  for (size_t i = 0; i + 1 < times.size(); i++) CHECK_NEAR(times[i + 1] - times[i], 10000, 1);
+}
+
+// Registries due at the same time go out by priority: at boot and after FetchRegisters(). Priority does not move a registry ahead of
+// one that is due earlier, nor poll it more often
+static void priority_breaks_ties() {
+  Rig rig;
+  rig.hp.log_requests = true;
+  rig.attach(10000, 1);
+  rig.component.set_registry_schedule(0x20, 30000, 5);
+  rig.component.setup();
+  rig.run(1 * US_PER_S, 1000);
+  CHECK_EQ(rig.hp.request_log().size(), 2u);
+  CHECK_EQ(rig.hp.request_log()[0].registry_id, 0x20);
+
+  rig.run(2 * US_PER_MIN, 1000);
+  CHECK_EQ(request_ms(rig.hp, 0x10).size(), 13u);
+  CHECK_EQ(request_ms(rig.hp, 0x20).size(), 5u);
+  CHECK_EQ(rig.hp.request_log()[2].registry_id, 0x10);  // 0x10 at 10 s, while 0x20 waits until 30 s
+
+  const size_t before = rig.hp.request_log().size();
+  rig.component.FetchRegisters();
+  rig.run(1 * US_PER_S, 1000);
+  CHECK_EQ(rig.hp.request_log().size(), before + 2);
+  CHECK_EQ(rig.hp.request_log()[before].registry_id, 0x20);
+}
+//________________________________________________________________ schedule end
+
+//__________________________________________________________________________________________________________________________ change detection begin
+// Frames of 0x10 are polled every second, one value written into it at a time
+static void write_lwt(Rig &rig, int16_t tenths) {
+  rig.hp.payload(0x10)[0] = (uint8_t)tenths;
+  rig.hp.payload(0x10)[1] = (uint8_t)(tenths >> 8);
+  rig.run(1 * US_PER_S, 1000);
+}
+
+// Identical frames are not decoded at all; a frame that differs is decoded, but a value within the deadband of the last published one
+// is not sent. The absolute deadband and the relative one (of the last published value), whichever is larger
+static void deadband() {
+  Rig rig;
+  rig.attach(1000, 1);
+  rig.component.set_publish_deadband(0.5f);
+  rig.component.setup();
+  rig.run(10 * US_PER_S, 1000);
+  CHECK_EQ(rig.lwt.publishes, 1u);
+  CHECK_EQ(rig.component.get_frames_skipped(), 18u);
+  CHECK_EQ(rig.component.get_publishes_suppressed(), 0u);
+
+  write_lwt(rig, 358);
+  CHECK_EQ(rig.lwt.publishes, 1u);
+  CHECK_NEAR(rig.lwt.state, 35.5, 1e-4);
+  CHECK_EQ(rig.component.get_publishes_suppressed(), 1u);
+  write_lwt(rig, 360);  // 0.5 from the published value: not past the deadband
+  CHECK_EQ(rig.lwt.publishes, 1u);
+  write_lwt(rig, 361);
+  CHECK_EQ(rig.lwt.publishes, 2u);
+  CHECK_NEAR(rig.lwt.state, 36.1, 1e-4);
+  write_lwt(rig, 355);  // either way
+  CHECK_EQ(rig.lwt.publishes, 3u);
+  CHECK_EQ(rig.component.get_publishes_suppressed(), 2u);
+
+  rig.component.set_publish_deadband_percent(0.05f);  // 1.775 at 35.5
+  write_lwt(rig, 372);
+  CHECK_EQ(rig.lwt.publishes, 3u);
+  write_lwt(rig, 375);
+  CHECK_EQ(rig.lwt.publishes, 4u);
+  CHECK_EQ(rig.iwt.publishes, 1u);  // 0x20 never changed
+}
+
+// With publish_max_age the unchanged frames are decoded and published again once that age has passed, deadband or not
+static void heartbeat() {
+  Rig rig;
+  rig.attach(1000, 1);
+  rig.component.set_publish_deadband(10.0f);
+  rig.component.set_publish_max_age(5000);
+  rig.component.setup();
+  rig.run(21 * US_PER_S, 1000);
+  CHECK_EQ(rig.lwt.publishes, 5u);  // 0, 5, 10, 15 and 20 s
+  CHECK_EQ(rig.iwt.publishes, 5u);
+  CHECK_EQ(rig.component.get_frames_skipped(), 2 * 21u - 10u);
+  CHECK_EQ(rig.component.get_publishes_suppressed(), 0u);
+
+  write_lwt(rig, 356);  // decoded, within the deadband, and no heartbeat due yet
+  CHECK_EQ(rig.lwt.publishes, 5u);
+  CHECK_EQ(rig.component.get_publishes_suppressed(), 1u);
+}
+
+// Lookup tables and texts count as changed when what the sensor shows changed: a bit flag or a nibble shares its byte, a text its
+// frame, with registers that change on their own
+struct TextRig : HostRig {
+  text_sensor::TextSensor pump, compressor, mode, software;
+  sensor::Sensor lwt;
+
+  TextRig() {
+    table.add("Water pump (bit 0)", 0x30, 0, 300, 1);
+    table.add("Compressor (bit 1)", 0x30, 0, 301, 1);
+    table.add("Operation mode", 0x30, 1, 315, 1);
+    table.add("Software version", 0x30, 2, 100, 6);
+    table.add("Leaving water temp. before BUH (R1T)", 0x30, 8, 105, 2);
+    hp.set_payload(0x30, {0x01, 0x10, 'I', 'D', '6', '6', 'F', '2', 0x63, 0x01});
+    attach(1000, 1);
+    component.bind_text_sensor(0, &pump);
+    component.bind_text_sensor(1, &compressor);
+    component.bind_text_sensor(2, &mode);
+    component.bind_text_sensor(3, &software);
+    component.bind_sensor(4, &lwt);
+    component.setup();
+    run(2 * US_PER_S, 1000);
+  }
+};
+
+static void flags_and_texts_by_what_they_show() {
+  TextRig rig;
+  CHECK_EQ(rig.pump.state, std::string("ON"));
+  CHECK_EQ(rig.compressor.state, std::string("OFF"));
+  CHECK_EQ(rig.mode.state, std::string("Heating"));
+  CHECK_EQ(rig.software.state, std::string("ID66F2"));
+
+  rig.hp.payload(0x30)[0] = 0x03;  // compressor on, the pump bit as it was
+  rig.hp.payload(0x30)[1] = 0x1F;  // the low nibble is not the mode
+  rig.hp.payload(0x30)[8] = 0x64;
+  rig.run(2 * US_PER_S, 1000);
+  CHECK_EQ(rig.compressor.state, std::string("ON"));
+  CHECK_EQ(rig.compressor.publishes, 2u);
+  CHECK_EQ(rig.lwt.publishes, 2u);
+  CHECK_EQ(rig.pump.publishes, 1u);
+  CHECK_EQ(rig.mode.publishes, 1u);
+  CHECK_EQ(rig.software.publishes, 1u);
+  CHECK_EQ(rig.component.get_publishes_suppressed(), 3u);
+
+  rig.hp.payload(0x30)[1] = 0x2F;
+  rig.hp.payload(0x30)[7] = '3';
+  rig.run(2 * US_PER_S, 1000);
+  CHECK_EQ(rig.mode.state, std::string("Cooling"));
+  CHECK_EQ(rig.software.state, std::string("ID66F3"));
+  CHECK_EQ(rig.software.publishes, 2u);
+}
+//________________________________________________________________ change detection end
+
+int main() {
+  RUN_TEST(boot_delay);
+  RUN_TEST(loop_returns_while_the_request_is_in_flight);
+  RUN_TEST(answer_assembled_across_loops);
+  RUN_TEST(one_request_in_flight);
+  RUN_TEST(timeout_after_the_allowance);
+  RUN_TEST(late_answer_is_decoded);
+  RUN_TEST(fetch_registers_makes_every_registry_due);
+  RUN_TEST(deadline_follows_the_baud_rate);
+  RUN_TEST(next_request_with_the_last_byte);
+  RUN_TEST(long_frame_at_2400_baud);
+  RUN_TEST(backoff_on_identical_frames);
+  RUN_TEST(no_backoff);
+  RUN_TEST(priority_breaks_ties);
+  RUN_TEST(deadband);
+  RUN_TEST(heartbeat);
+  RUN_TEST(flags_and_texts_by_what_they_show);
+  return x10a_test_exit();
+}
@@ -0,0 +1,127 @@
+// Registry probe (probe_result_(), check_frame_shape_()) against a simulated heat pump that does not answer every registry: the first
+// sweep finds the dead ones and they leave the schedule, a re-probe brings one back once it answers, and the registry probe text
+// sensor says which registries answer and which frames end before their registers
+
+#include "x10a_test.h"
+#include "x10a_rig.h"
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+// 0x10 and 0x20 answer, 0x30 stays silent and 0x31 answers with an error frame
+struct Rig : HostRig {
+  sensor::Sensor lwt, pressure;
+  text_sensor::TextSensor probe;
+
+  // with_pressure: a register past the end of the 0x20 frame
+  explicit Rig(bool with_pressure = false) {
+    table.add("Leaving water temp. before BUH (R1T)", 0x10, 0, 105, 2);
+    table.add("Inlet water temp.(R4T)", 0x20, 0, 105, 2);
+    if (with_pressure) table.add("Water pressure", 0x20, 2, 105, 2);
+    table.add("Outdoor air temp.(R1T)", 0x30, 0, 105, 2);
+    table.add("Fan 1 (step)", 0x31, 0, 152, 1);
+    hp.set_payload(0x10, {0x63, 0x01, 0x00, 0x00});
+    hp.set_payload(0x20, {0x2C, 0x01});
+    hp.set_payload(0x30, {0x32, 0x00});
+    hp.set_payload(0x31, {0x02});
+    hp.set_silent(0x30, true);
+    hp.set_reject(0x31, true);
+    attach(10000, 1);
+    component.bind_sensor(0, &lwt);
+    if (with_pressure) component.bind_sensor(component.find_register("Water pressure"), &pressure);
+    component.set_registry_probe_sensor(&probe);
+  }
+};
+
+//__________________________________________________________________________________________________________________________ probe begin
+// Two misses in the first sweep and a registry is dead: it is not asked again until the re-probe, the others keep their interval
+static void dead_registries_leave_the_schedule() {
+  Rig rig;
+  rig.component.setup();
+  rig.run(5 * US_PER_S);
+  CHECK_EQ(rig.component.get_dead_registries(), 2u);
+  CHECK_EQ(rig.requests(0x30), 2u);
+  CHECK_EQ(rig.requests(0x31), 2u);
+  CHECK_EQ(rig.probe.publishes, 1u);
+  CHECK_EQ(rig.probe.state, std::string("2 of 4 answer; no answer: 0x30 0x31"));
+
+  rig.run(30 * US_PER_MIN);
+  CHECK_EQ(rig.requests(0x30), 2u);
+  CHECK_EQ(rig.requests(0x31), 2u);
+  CHECK(rig.requests(0x10) >= 180u);
+  CHECK_NEAR(rig.lwt.state, 35.5, 1e-4);
+  CHECK_EQ(rig.probe.publishes, 1u);
+}
+
+// The probe learns the size of every frame that answered, which bounds its receive deadline from then on
+static void frame_sizes_are_learned() {
+  Rig rig;
+  rig.component.setup();
+  rig.run(5 * US_PER_S);
+  CHECK_EQ(rig.component.frame_size(0x10), SimulatedHeatPump::make_frame(0x10, rig.hp.payload(0x10)).size());
+  CHECK_EQ(rig.component.frame_size(0x20), SimulatedHeatPump::make_frame(0x20, rig.hp.payload(0x20)).size());
+  CHECK_EQ(rig.component.frame_size(0x30), 0u);
+}
+
+// A dead registry is asked again every reprobe interval; once it answers it is back on the schedule
+static void reprobe_brings_a_registry_back() {
+  Rig rig;
+  rig.component.set_reprobe_interval(10 * 60000);
+  rig.component.setup();
+  rig.run(5 * US_PER_MIN);
+  rig.hp.set_silent(0x30, false);
+  rig.run(4 * US_PER_MIN);
+  CHECK_EQ(rig.requests(0x30), 2u);
+  rig.run(65 * US_PER_S);  // the re-probe is due 10 min after the first sweep
+  CHECK_EQ(rig.requests(0x30), 3u);
+  CHECK_EQ(rig.requests(0x31), 3u);
+  CHECK_EQ(rig.component.get_dead_registries(), 1u);
+  CHECK_EQ(rig.probe.state, std::string("3 of 4 answer; no answer: 0x31"));
+  CHECK_EQ(rig.probe.publishes, 2u);
+
+  rig.run(5 * US_PER_MIN);
+  CHECK(rig.requests(0x30) >= 30u);
+  CHECK_EQ(rig.requests(0x31), 3u);
+}
+
+// While nothing answers the bus may just be down: no registry is declared dead, and nothing is published until the probe is complete
+static void silent_bus_declares_nothing() {
+  Rig rig;
+  rig.hp.set_silent(0x10, true);
+  rig.hp.set_silent(0x20, true);
+  rig.component.setup();
+  rig.run(5 * US_PER_MIN);
+  CHECK_EQ(rig.component.get_dead_registries(), 0u);
+  CHECK(rig.requests(0x30) > 10u);
+  CHECK_EQ(rig.probe.publishes, 0u);
+
+  rig.hp.set_silent(0x10, false);
+  rig.hp.set_silent(0x20, false);
+  rig.run(30 * US_PER_S);
+  CHECK_EQ(rig.component.get_dead_registries(), 2u);
+  CHECK_EQ(rig.probe.state, std::string("2 of 4 answer; no answer: 0x30 0x31"));
+}
+
+// A register past the end of the frame the heat pump sends is reported, and not published from bytes that are not there
+static void short_frame_is_reported() {
+  Rig rig(true);
+  rig.component.setup();
+  rig.run(5 * US_PER_S);
+  CHECK_EQ(rig.probe.state, std::string("2 of 4 answer; no answer: 0x30 0x31; past frame end: 0x20"));
+  CHECK_EQ(rig.pressure.publishes, 0u);
+
+  rig.hp.set_payload(0x20, {0x2C, 0x01, 0x0F, 0x00});
+  rig.run(15 * US_PER_S);
+  CHECK_EQ(rig.probe.state, std::string("2 of 4 answer; no answer: 0x30 0x31"));
+  CHECK_NEAR(rig.pressure.state, 1.5, 1e-4);
+}
+//________________________________________________________________ probe end
+
+int main() {
+  RUN_TEST(dead_registries_leave_the_schedule);
+  RUN_TEST(frame_sizes_are_learned);
+  RUN_TEST(reprobe_brings_a_registry_back);
+  RUN_TEST(silent_bus_declares_nothing);
+  RUN_TEST(short_frame_is_reported);
+  return x10a_test_exit();
+}
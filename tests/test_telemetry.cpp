@@ -0,0 +1,270 @@
+// The telemetry stream (daikin_telemetry.h, daikin_telemetry.cpp) received by a listener on 127.0.0.1 while the component polls the
+// simulated heat pump: every request and frame arrives as sent, values decode to what the sensors get, and a listener that is not
+// there costs records, never a stalled poll
+
+#include "x10a_test.h"
+#include "x10a_rig.h"
+
+#include <cerrno>
+#include <memory>
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+//__________________________________________________________________________________________________________________________ listener begin
+// A socket on 127.0.0.1 with a port the kernel picks; TCP listens, UDP receives
+struct Listener {
+  std::unique_ptr<socket::Socket> socket;
+  uint16_t port{0};
+
+  explicit Listener(bool tcp, uint16_t wanted_port = 0) {
+    socket = socket::socket_ip(tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+    const int reuse = 1;
+    socket->setsockopt(SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_storage addr;
+    const socklen_t len = socket::set_sockaddr(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr), "127.0.0.1", wanted_port);
+    if (socket->bind(reinterpret_cast<struct sockaddr *>(&addr), len) != 0) return;
+    if (tcp) socket->listen(1);
+    socket->setblocking(false);
+    socklen_t bound_len = sizeof(addr);
+    ::getsockname(socket->get_fd(), reinterpret_cast<struct sockaddr *>(&addr), &bound_len);
+    port = ntohs(reinterpret_cast<struct sockaddr_in *>(&addr)->sin_port);
+  }
+};
+
+// Everything waiting on a non-blocking socket; one vector per UDP datagram, or the whole TCP stream in one
+static std::vector<std::vector<uint8_t>> receive_all(socket::Socket &socket) {
+  std::vector<std::vector<uint8_t>> received;
+  uint8_t buffer[2048];
+  ssize_t n;
+  while ((n = socket.read(buffer, sizeof(buffer))) > 0) received.emplace_back(buffer, buffer + n);
+  return received;
+}
+
+static std::vector<uint8_t> joined(const std::vector<std::vector<uint8_t>> &chunks) {
+  std::vector<uint8_t> bytes;
+  for (const auto &chunk : chunks) bytes.insert(bytes.end(), chunk.begin(), chunk.end());
+  return bytes;
+}
+//________________________________________________________________ listener end
+
+//__________________________________________________________________________________________________________________________ stream begin
+// The format of daikin_telemetry.h, read back independently of daikin_telemetry_buffer
+struct Record {
+  uint8_t type;
+  uint32_t timestamp_us;
+  std::vector<uint8_t> payload;
+};
+
+struct Batch {
+  uint32_t sequence;
+  std::vector<Record> records;
+};
+
+static uint16_t u16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t u32(const uint8_t *p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+
+// Cuts whole batches off the front of bytes; returns the number of bytes used, or -1 when the stream is malformed
+static long parse_batches(const std::vector<uint8_t> &bytes, std::vector<Batch> &batches) {
+  size_t pos = 0;
+  while (bytes.size() - pos >= daikin_telemetry_buffer::HEADER_SIZE) {
+    const uint8_t *header = &bytes[pos];
+    if (header[0] != 'X' || header[1] != 'T' || header[2] != daikin_telemetry_buffer::VERSION) return -1;
+    const size_t length = u16(header + 4);
+    if (bytes.size() - pos - daikin_telemetry_buffer::HEADER_SIZE < length) break;
+
+    Batch batch{u32(header + 6), {}};
+    size_t at = pos + daikin_telemetry_buffer::HEADER_SIZE;
+    const size_t end = at + length;
+    while (at < end) {
+      if (end - at < daikin_telemetry_buffer::RECORD_HEADER_SIZE) return -1;
+      const size_t payload = u16(&bytes[at + 1]);
+      if (end - at - daikin_telemetry_buffer::RECORD_HEADER_SIZE < payload) return -1;
+      const auto first = bytes.begin() + (long)(at + daikin_telemetry_buffer::RECORD_HEADER_SIZE);
+      batch.records.push_back(Record{bytes[at], u32(&bytes[at + 3]), std::vector<uint8_t>(first, first + (long)payload)});
+      at += daikin_telemetry_buffer::RECORD_HEADER_SIZE + payload;
+    }
+    if (batch.records.size() != header[3]) return -1;
+    batches.push_back(std::move(batch));
+    pos = end;
+  }
+  return (long)pos;
+}
+
+static std::vector<Record> records_of(const std::vector<Batch> &batches, daikin_telemetry_buffer::Record type) {
+  std::vector<Record> records;
+  for (const auto &batch : batches) {
+    for (const auto &record : batch.records) {
+      if (record.type == static_cast<uint8_t>(type)) records.push_back(record);
+    }
+  }
+  return records;
+}
+
+static bool consecutive(const std::vector<Batch> &batches) {
+  for (size_t i = 1; i < batches.size(); i++) {
+    if (batches[i].sequence != batches[0].sequence + i) return false;
+  }
+  return true;
+}
+//________________________________________________________________ stream end
+
+struct Rig : HostRig {
+  sensor::Sensor lwt, iwt;
+
+  explicit Rig(uint16_t port, bool tcp) {
+    table.add("Leaving water temp. before BUH (R1T)", 0x10, 0, 105, 2);
+    table.add("Inlet water temp.(R4T)", 0x20, 0, 105, 2);
+    hp.set_payload(0x10, {0x63, 0x01, 0x00});
+    hp.set_payload(0x20, {0x2C, 0x01, 0x00});
+    attach(500, 1);  // both registries twice a second, identical frames or not
+    component.bind_sensor(0, &lwt);
+    component.bind_sensor(1, &iwt);
+    component.set_telemetry_target("127.0.0.1", port, tcp);
+    component.set_telemetry_values(true);
+  }
+};
+
+//__________________________________________________________________________________________________________________________ telemetry begin
+// Flushed with every poll: once host_run() returns, everything recorded is in the listener's socket, one batch per datagram
+static void udp_listener_gets_every_request_and_frame() {
+  Listener listener(false);
+  CHECK(listener.port != 0);
+  Rig rig(listener.port, false);
+  rig.component.set_telemetry_flush_interval(0);
+  rig.component.setup();
+  rig.run(5 * US_PER_S);
+
+  std::vector<Batch> batches;
+  for (const auto &datagram : receive_all(*listener.socket)) CHECK_EQ(parse_batches(datagram, batches), (long)datagram.size());
+  CHECK(!batches.empty());
+  CHECK_EQ(batches.front().sequence, 0u);
+  CHECK(consecutive(batches));
+  CHECK_EQ(rig.component.get_telemetry_dropped(), 0u);
+
+  const auto requests = records_of(batches, daikin_telemetry_buffer::Record::REQUEST);
+  CHECK_EQ(requests.size(), (size_t)rig.hp.requests());
+  for (size_t i = 0; i < requests.size(); i++) {
+    const auto request = daikin_package::MakeRequest(i % 2 == 0 ? 0x10 : 0x20);
+    CHECK(requests[i].payload == std::vector<uint8_t>(request.data(), request.data() + request.size()));
+  }
+
+  const auto frames = records_of(batches, daikin_telemetry_buffer::Record::FRAME);
+  CHECK_EQ(frames.size(), (size_t)rig.hp.stats().answers);
+  for (const auto &frame : frames) {
+    const uint8_t registry_id = frame.payload.size() > 1 ? frame.payload[1] : 0;
+    CHECK(frame.payload == SimulatedHeatPump::make_frame(registry_id, rig.hp.payload(registry_id)));
+  }
+
+  uint32_t previous_us = 0;
+  for (const auto &batch : batches) {
+    for (const auto &record : batch.records) {
+      CHECK(record.timestamp_us >= previous_us);
+      previous_us = record.timestamp_us;
+    }
+  }
+  CHECK(previous_us <= micros());
+}
+
+// The first frame of each registry is decoded in full; its values go out as VALUE records, as the sensors get them
+static void values_match_the_sensors() {
+  Listener listener(false);
+  Rig rig(listener.port, false);
+  rig.component.setup();
+  rig.run(2 * US_PER_S);
+
+  std::vector<Batch> batches;
+  for (const auto &datagram : receive_all(*listener.socket)) parse_batches(datagram, batches);
+  const auto values = records_of(batches, daikin_telemetry_buffer::Record::VALUE);
+  unsigned seen[2] = {0, 0};
+  for (const auto &value : values) {
+    CHECK_EQ(value.payload.size(), daikin_telemetry_buffer::VALUE_SIZE);
+    const uint16_t handle = u16(value.payload.data());
+    CHECK(handle < 2);
+    if (handle >= 2) continue;
+    seen[handle]++;
+    CHECK_EQ(value.payload[2], static_cast<uint8_t>(RegisterValue::Kind::NUMBER));
+    float number;
+    std::memcpy(&number, &value.payload[4], sizeof(number));
+    CHECK_NEAR(number, handle == 0 ? 35.5 : 30.0, 1e-4);
+  }
+  CHECK(seen[0] >= 1 && seen[1] >= 1);
+  CHECK_NEAR(rig.lwt.state, 35.5, 1e-4);
+  CHECK_NEAR(rig.iwt.state, 30.0, 1e-4);
+
+  // Batched by the 100 ms flush interval, not one per poll
+  size_t records = 0;
+  for (const auto &batch : batches) records += batch.records.size();
+  CHECK(batches.size() < records / 2);
+}
+
+// Non-blocking connect, writes from the next polls on: the stream ends on a batch boundary and carries every request
+static void tcp_listener_gets_the_stream() {
+  Listener listener(true);
+  CHECK(listener.port != 0);
+  Rig rig(listener.port, true);
+  rig.component.set_telemetry_flush_interval(0);
+  rig.component.setup();
+  rig.run(US_PER_S);
+  auto connection = listener.socket->accept(nullptr, nullptr);
+  CHECK(connection != nullptr);
+  if (connection == nullptr) return;
+  connection->setblocking(false);
+  rig.run(4 * US_PER_S);
+
+  const std::vector<uint8_t> stream = joined(receive_all(*connection));
+  std::vector<Batch> batches;
+  CHECK_EQ(parse_batches(stream, batches), (long)stream.size());
+  CHECK(!batches.empty());
+  CHECK_EQ(batches.front().sequence, 0u);
+  CHECK(consecutive(batches));
+  CHECK_EQ(rig.component.get_telemetry_dropped(), 0u);
+  CHECK_EQ(records_of(batches, daikin_telemetry_buffer::Record::REQUEST).size(), (size_t)rig.hp.requests());
+  CHECK_EQ(records_of(batches, daikin_telemetry_buffer::Record::FRAME).size(), (size_t)rig.hp.stats().answers);
+}
+
+// Nobody listens: the records are counted as dropped and polling keeps the pace of a component whose listener is up. Once a listener
+// is there, the next connect attempt (5 s after the last failure) reaches it
+static void tcp_listener_that_comes_later() {
+  uint16_t port;
+  {
+    Listener gone(true);
+    port = gone.port;
+  }
+  Listener udp(false);
+  Rig rig(port, true), reference(udp.port, false);
+  rig.component.set_telemetry_flush_interval(0);
+  rig.component.setup();
+  reference.component.setup();
+  host_run({&rig.component, &reference.component}, 10 * US_PER_S);
+  CHECK(rig.component.get_telemetry_dropped() > 0u);
+  CHECK_EQ(rig.hp.requests(), reference.hp.requests());
+  CHECK_EQ(reference.component.get_telemetry_dropped(), 0u);
+
+  Listener listener(true, port);
+  CHECK_EQ(listener.port, port);
+  rig.run(6 * US_PER_S);
+  auto connection = listener.socket->accept(nullptr, nullptr);
+  CHECK(connection != nullptr);
+  if (connection == nullptr) return;
+  connection->setblocking(false);
+  const uint32_t dropped = rig.component.get_telemetry_dropped();
+  rig.run(2 * US_PER_S);
+
+  const std::vector<uint8_t> stream = joined(receive_all(*connection));
+  std::vector<Batch> batches;
+  CHECK_EQ(parse_batches(stream, batches), (long)stream.size());
+  CHECK(!records_of(batches, daikin_telemetry_buffer::Record::FRAME).empty());
+  CHECK(consecutive(batches));
+  CHECK_EQ(rig.component.get_telemetry_dropped(), dropped);
+}
+//________________________________________________________________ telemetry end
+
+int main() {
+  RUN_TEST(udp_listener_gets_every_request_and_frame);
+  RUN_TEST(values_match_the_sensors);
+  RUN_TEST(tcp_listener_gets_the_stream);
+  RUN_TEST(tcp_listener_that_comes_later);
+  return x10a_test_exit();
+}
@@ -0,0 +1,193 @@
+// The hand-over between the UART task and loop(): daikin_spsc_queue between two real threads, and what process_frame_() queues while the
+// task runs. FreeRTOS is not on the host, so the task's side is played by the test (or a std::thread) calling process_frame_(), and
+// loop()'s side by drain_updates_()
+
+#include "x10a_test.h"
+#include "x10a_rig.h"
+
+#include <string>
+#include <thread>
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+//__________________________________________________________________________________________________________________________ spsc queue begin
+// Every field is derived from seq, so a torn or reordered copy shows up as a mismatch
+struct Item {
+  uint32_t seq;
+  uint32_t check;
+  char text[REGISTER_TEXT_SIZE];
+};
+
+static Item make_item(uint32_t seq) {
+  Item item{seq, ~seq * 2654435761u, {}};
+  for (size_t i = 0; i + 1 < sizeof(item.text); i++) item.text[i] = (char)('a' + (seq + i) % 26);
+  return item;
+}
+
+static bool item_ok(const Item &item, uint32_t seq) {
+  const Item expected = make_item(seq);
+  return item.seq == seq && item.check == expected.check && std::memcmp(item.text, expected.text, sizeof(item.text)) == 0;
+}
+
+// One producer, one consumer, both spinning on a full or empty queue: every item arrives once, in order and intact
+static void spsc_queue_between_two_threads() {
+  static constexpr uint32_t Items = 2000000;
+  daikin_spsc_queue<Item, 64> queue;
+  std::thread producer([&queue]() {
+    for (uint32_t seq = 0; seq < Items; seq++) {
+      const Item item = make_item(seq);
+      while (!queue.push(item)) std::this_thread::yield();
+    }
+  });
+
+  uint32_t received = 0, bad = 0;
+  Item item;
+  while (received < Items) {
+    if (!queue.pop(&item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (!item_ok(item, received)) bad++;
+    received++;
+  }
+  producer.join();
+  CHECK_EQ(bad, 0u);
+  CHECK(queue.empty());
+  CHECK(!queue.pop(&item));
+}
+
+static void spsc_queue_full_and_empty() {
+  daikin_spsc_queue<Item, 4> queue;
+  Item item;
+  CHECK(!queue.pop(&item));
+  for (uint32_t seq = 0; seq < 4; seq++) CHECK(queue.push(make_item(seq)));
+  CHECK(!queue.push(make_item(4)));
+  CHECK_EQ(queue.size(), 4u);
+  for (uint32_t seq = 0; seq < 4; seq++) CHECK(queue.pop(&item) && item_ok(item, seq));
+  CHECK(queue.empty());
+}
+//________________________________________________________________ spsc queue end
+
+//__________________________________________________________________________________________________________________________ hand-over begin
+// The component with task_running_ set but no task: the test calls what the task would
+struct Rig : HostRig {
+  sensor::Sensor lwt;
+  text_sensor::TextSensor software;
+  daikin_package frame{daikin_package::Mode::RECEIVE};
+
+  Rig() {
+    table.add("Leaving water temp. before BUH (R1T)", 0x10, 0, 105, 2);
+    table.add("Flow sensor (l/min)", 0x10, 2, 152, 2);     // Mode 1, no sensor
+    table.add("Hidden", 0x10, 4, 105, 2, 0);               // decoded on demand only
+    table.add("Software version", 0x10, 6, 100, 8);
+    attach();
+    component.bind_sensor(0, &lwt);
+    component.bind_text_sensor(3, &software);
+    component.setup();
+    component.task_started();
+  }
+  // One frame of 0x10 through process_frame_(), as the task decodes it
+  bool send(int16_t lwt_tenths, int16_t hidden_tenths, const char *version) {
+    std::vector<uint8_t> data = {(uint8_t)lwt_tenths, (uint8_t)(lwt_tenths >> 8), 0x2A, 0x00, (uint8_t)hidden_tenths,
+                                 (uint8_t)(hidden_tenths >> 8)};
+    for (size_t i = 0; i < 8; i++) data.push_back(i < std::strlen(version) ? (uint8_t)version[i] : 0);
+    const auto bytes = SimulatedHeatPump::make_frame(0x10, data);
+    frame = daikin_package::FromBytes(bytes.data(), bytes.size());
+    component.serve_task_requests_();
+    return component.process_frame_(frame);
+  }
+};
+
+// Only the registers something in loop() reads are queued: the bound sensor and text sensor, not the unbound Mode 1 and Mode 0 rows
+static void only_registers_with_a_consumer_are_queued() {
+  Rig rig;
+  rig.send(355, 200, "ID66F2");
+  CHECK_EQ(rig.component.queued(), 2u);
+  rig.component.drain_updates_();
+  CHECK_NEAR(rig.lwt.state, 35.5, 1e-4);
+  CHECK_EQ(rig.software.state, std::string("ID66F2"));
+  CHECK(std::isnan(rig.component.get_register_float(rig.component.find_register("Flow sensor (l/min)"))));
+}
+
+// The text travels in the update: the task never writes register_states_, and two frames in the queue keep their own texts
+static void text_travels_with_the_update() {
+  Rig rig;
+  rig.send(355, 200, "ID66F2");
+  CHECK_EQ(std::string(rig.component.state(3).text), std::string(""));
+  rig.send(356, 200, "ID66F3");
+  CHECK_EQ(std::string(rig.component.state(3).text), std::string(""));
+  CHECK_EQ(rig.component.queued(), 4u);
+
+  rig.component.drain_updates_();
+  CHECK_EQ(rig.software.publishes, 2u);
+  CHECK_EQ(rig.software.state, std::string("ID66F3"));
+  CHECK_EQ(std::string(rig.component.state(3).text), std::string("ID66F3"));
+}
+
+// A Mode 0 register read while the task runs is queued from the next frame on, even an identical one
+static void register_read_is_queued_from_the_next_frame() {
+  Rig rig;
+  const auto hidden = rig.component.find_register("Hidden");
+  rig.send(355, 200, "ID66F2");
+  rig.component.drain_updates_();
+  CHECK(std::isnan(rig.component.get_register_float(hidden)));
+
+  rig.send(355, 200, "ID66F2");
+  rig.component.drain_updates_();
+  CHECK_NEAR(rig.component.get_register_float(hidden), 20.0, 1e-4);
+  CHECK_EQ(rig.lwt.publishes, 1u);  // the identical frame was decoded again, its unchanged values are not published again
+}
+
+// loop() falls behind: what does not fit is dropped and counted, the task never waits, and the next frame of the registry is decoded
+// again even though it is identical
+static void full_queue_drops_and_decodes_again() {
+  Rig rig;
+  for (int16_t i = 0; i < 100; i++) rig.send(300 + i, 200, "ID66F2");
+  CHECK_EQ(rig.component.queued(), 128u);
+  CHECK_EQ(rig.component.get_updates_dropped(), 200u - 128u);
+
+  rig.component.drain_updates_();
+  CHECK_NEAR(rig.lwt.state, 36.3, 1e-4);  // the 64th frame, the last one that fit
+  const uint32_t skipped = rig.component.get_frames_skipped();
+  rig.send(399, 200, "ID66F2");
+  rig.component.drain_updates_();
+  CHECK_NEAR(rig.lwt.state, 39.9, 1e-4);
+  rig.send(399, 200, "ID66F2");
+  CHECK_EQ(rig.component.get_frames_skipped(), skipped + 1);  // handed over in full, identical frames are skipped again
+}
+
+// The task's side on a thread of its own, loop()'s side on this one. Whatever was dropped on the way, the values of the last frame end
+// up in loop()'s register states
+static void frames_decoded_on_another_thread() {
+  static constexpr int Frames = 20000;
+  Rig rig;
+  std::atomic<bool> done{false};
+  std::thread task([&rig, &done]() {
+    for (int i = 0; i < Frames; i++) rig.send((int16_t)(i % 1000), 0, (i & 1) ? "ID66F3" : "ID66F2");
+    done.store(true);
+  });
+  while (!done.load()) rig.component.drain_updates_();
+  task.join();
+  rig.component.drain_updates_();
+  for (int i = 0; i < 2; i++) {  // a frame whose values were dropped is decoded again
+    rig.send((int16_t)((Frames - 1) % 1000), 0, "ID66F3");
+    rig.component.drain_updates_();
+  }
+  CHECK(rig.lwt.publishes > 1u);
+  CHECK_NEAR(rig.lwt.state, 99.9, 1e-4);
+  CHECK_EQ(rig.software.state, std::string("ID66F3"));
+  CHECK_EQ(std::string(rig.component.state(3).text), std::string("ID66F3"));
+}
+//________________________________________________________________ hand-over end
+
+int main() {
+  RUN_TEST(spsc_queue_between_two_threads);
+  RUN_TEST(spsc_queue_full_and_empty);
+  RUN_TEST(only_registers_with_a_consumer_are_queued);
+  RUN_TEST(text_travels_with_the_update);
+  RUN_TEST(register_read_is_queued_from_the_next_frame);
+  RUN_TEST(full_queue_drops_and_decodes_again);
+  RUN_TEST(frames_decoded_on_another_thread);
+  return x10a_test_exit();
+}
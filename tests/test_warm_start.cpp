@@ -0,0 +1,145 @@
+// Warm start (daikin_warm_start.cpp) across a reboot: the frames saved before it are published from flash in setup(), marked stale
+// until the heat pump is read again, and the first sweep starts once the line is quiet rather than after the boot delay. Flash is the
+// shim's host_flash: save() stages, sync() commits, host_reset(true) reboots with it
+
+#include "x10a_test.h"
+#include "x10a_rig.h"
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+struct Rig : HostRig {
+  sensor::Sensor lwt, iwt, stale;
+
+  Rig() {
+    table.add("Leaving water temp. before BUH (R1T)", 0x10, 0, 105, 2);
+    table.add("Inlet water temp.(R4T)", 0x20, 0, 105, 2);
+    hp.set_payload(0x10, {0x63, 0x01, 0x00});
+    hp.set_payload(0x20, {0x2C, 0x01, 0x00});
+    attach();
+    component.set_boot_delay(15000);  // the default, which the warm start cuts short
+    component.set_warm_start_write_interval(60000);
+    component.set_stale_registries_sensor(&stale);
+    component.bind_sensor(0, &lwt);
+    component.bind_sensor(1, &iwt);
+  }
+};
+
+// Runs a first boot until both registries were read, and shuts down cleanly: both frames end up in flash
+static void first_boot(uint64_t duration_us = 20 * US_PER_S) {
+  Rig rig;
+  rig.component.setup();
+  rig.run(duration_us);
+  CHECK_NEAR(rig.lwt.state, 35.5, 1e-4);
+  rig.component.on_shutdown();
+  host_reset(true);
+}
+
+//__________________________________________________________________________________________________________________________ warm start begin
+static void restored_before_the_first_sweep() {
+  first_boot();
+  CHECK_EQ(host_flash.committed.size(), 2u);
+
+  Rig rig;
+  rig.component.setup();
+  CHECK_NEAR(rig.lwt.state, 35.5, 1e-4);
+  CHECK_NEAR(rig.iwt.state, 30.0, 1e-4);
+  CHECK_EQ(rig.component.get_stale_registries(), 2u);
+  CHECK_EQ(rig.stale.state, 2.0f);
+  CHECK_EQ(rig.hp.requests(), 0u);
+
+  // The line is quiet from boot on: the first sweep goes out after 500 ms, not after the 15 s boot delay
+  rig.run(2 * US_PER_S);
+  CHECK_EQ(rig.hp.requests(), 2u);
+  CHECK_EQ(rig.component.get_stale_registries(), 0u);
+  CHECK_EQ(rig.stale.state, 0.0f);
+  CHECK_EQ(rig.lwt.publishes, 2u);  // restored, then read from the HP
+}
+
+// Without a saved frame nothing is published at boot; the first sweep still waits only for a quiet line
+static void cold_boot() {
+  Rig rig;
+  rig.component.setup();
+  CHECK_EQ(rig.lwt.publishes, 0u);
+  CHECK_EQ(rig.component.get_stale_registries(), 0u);
+  rig.run(2 * US_PER_S);
+  CHECK_EQ(rig.hp.requests(), 2u);
+}
+
+// Bytes on the line from before the reboot hold the first sweep back until it has been quiet for 500 ms
+static void first_sweep_waits_for_a_quiet_line() {
+  first_boot();
+  Rig rig;
+  rig.component.setup();
+  for (uint64_t at = 0; at < 3 * US_PER_S; at += 100 * US_PER_MS) rig.hp.inject({0x40}, at);
+  rig.run(3 * US_PER_S);
+  CHECK_EQ(rig.hp.requests(), 0u);
+  rig.run(US_PER_S);
+  CHECK_EQ(rig.hp.requests(), 2u);
+}
+
+// Changed frames are staged once per write interval, unchanged ones never: the flash sees a write per registry that changed
+static void writes_only_what_changed() {
+  Rig rig;
+  rig.component.set_adaptive_backoff(1);  // every registry read every 30 s
+  rig.component.setup();
+  rig.run(59 * US_PER_S);
+  CHECK(host_flash.staged.empty());
+  rig.run(2 * US_PER_S);
+  CHECK_EQ(host_flash.staged.size(), 2u);
+  global_preferences->sync();
+  CHECK_EQ(host_flash.writes, 2u);
+
+  rig.run(60 * US_PER_S);  // same frames again
+  CHECK(host_flash.staged.empty());
+
+  rig.hp.set_payload(0x20, {0x2D, 0x01, 0x00});
+  rig.run(90 * US_PER_S);
+  CHECK_EQ(host_flash.staged.size(), 1u);
+  global_preferences->sync();
+  CHECK_EQ(host_flash.writes, 3u);
+}
+
+// A record that fails its CRC, or was written by another version, is left alone; the other registries are still restored
+static void damaged_records_are_skipped() {
+  first_boot();
+  CHECK_EQ(host_flash.committed.size(), 2u);
+  auto record = host_flash.committed.begin();
+  record->second[7] ^= 0x01;     // a data byte of the frame
+  (++record)->second[0] = 0x7F;  // the version
+  Rig rig;
+  rig.component.setup();
+  CHECK_EQ(rig.component.get_stale_registries(), 0u);
+  CHECK_EQ(rig.lwt.publishes, 0u);
+  CHECK_EQ(rig.iwt.publishes, 0u);
+
+  host_reset(false);
+  first_boot();
+  host_flash.committed.begin()->second[7] ^= 0x01;
+  Rig again;
+  again.component.setup();
+  CHECK_EQ(again.component.get_stale_registries(), 1u);
+  CHECK_EQ(again.lwt.publishes, 0u);
+  CHECK_NEAR(again.iwt.state, 30.0, 1e-4);
+}
+
+// Every instance keeps its own records
+static void instances_do_not_share_records() {
+  first_boot();
+  Rig rig;
+  rig.component.set_instance_name("second");
+  rig.component.setup();
+  CHECK_EQ(rig.component.get_stale_registries(), 0u);
+  CHECK_EQ(rig.lwt.publishes, 0u);
+}
+//________________________________________________________________ warm start end
+
+int main() {
+  RUN_TEST(restored_before_the_first_sweep);
+  RUN_TEST(cold_boot);
+  RUN_TEST(first_sweep_waits_for_a_quiet_line);
+  RUN_TEST(writes_only_what_changed);
+  RUN_TEST(damaged_records_are_skipped);
+  RUN_TEST(instances_do_not_share_records);
+  return x10a_test_exit();
+}
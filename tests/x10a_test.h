@@ -0,0 +1,53 @@
+// x10a_test.h
+#pragma once
+
+#include "x10a_host.h"
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <type_traits>
+
+// Checks for the host tests: a failed check is reported with its line and the test goes on; the program exits 1 when any failed,
+// which is what ctest looks at. Every test function starts from boot (host_reset())
+inline int x10a_test_failures = 0;
+
+template<typename T> auto x10a_printable(const T &v) {
+  if constexpr (std::is_enum_v<T>) {
+    return static_cast<long long>(v);
+  } else if constexpr (std::is_arithmetic_v<T>) {
+    return +v;  // uint8_t as a number
+  } else {
+    return v;
+  }
+}
+
+template<typename A, typename B> void x10a_check_eq(const A &a, const B &b, const char *expr, const char *file, int line) {
+  if (a == b) return;
+  std::cout << file << ":" << line << ": CHECK_EQ(" << expr << ") failed: " << x10a_printable(a) << " != " << x10a_printable(b)
+            << std::endl;
+  x10a_test_failures++;
+}
+
+#define CHECK(cond)                                                         \
+  do {                                                                      \
+    if (!(cond)) {                                                          \
+      std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);  \
+      x10a_test_failures++;                                                 \
+    }                                                                       \
+  } while (0)
+#define CHECK_EQ(a, b) x10a_check_eq((a), (b), #a ", " #b, __FILE__, __LINE__)
+#define CHECK_NEAR(a, b, tolerance) CHECK(std::fabs((double)(a) - (double)(b)) <= (tolerance))
+
+#define RUN_TEST(test)                                                              \
+  do {                                                                              \
+    const int before = x10a_test_failures;                                          \
+    host_reset();                                                                   \
+    test();                                                                         \
+    std::printf("%s %s\n", x10a_test_failures == before ? "ok  " : "FAIL", #test);  \
+  } while (0)
+
+inline int x10a_test_exit() {
+  std::printf("%s\n", x10a_test_failures == 0 ? "PASS" : "FAIL");
+  return x10a_test_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,357 @@
+// Host benchmark of the decode path: process_frame_() on frames of every registry of the YAML, timed per frame, with the allocations it
+// makes counted by an operator new hook (like tools/x10a_soak), then the converter of every register, per register and per convid
+// family. The host counterpart of run_decode_benchmark(): it covers the whole frame (change detection, conversion, publishing) as well
+// as the converters alone, and compares with a stored baseline.
+//
+// Timings are gated as ratios to a reference timed in the same run, a plain int16 to float loop over the frame bytes: it does not
+// depend on the decoder, so a faster or slower machine moves both and the stored ratios hold across machines.
+//
+//   cmake -S . -B build && cmake --build build --target x10a_decode_bench
+//   build/x10a_decode_bench                       (reads m5poe.yaml, compares with tools/x10a_decode_bench/baseline.txt)
+//   build/x10a_decode_bench --write-baseline      (after a change that is meant to move the numbers)
+//   build/x10a_decode_bench --allocations-only    (what ctest runs: the allocations are exact, the timings noisy even as ratios)
+//
+// Every register of the YAML is read (mode 1) unless --yaml-modes keeps the modes of the YAML. Three passes over all registries:
+//   changed    every frame differs from the previous one of its registry: decoded and published to the numeric sensors
+//   identical  every frame equals the previous one: skipped after the comparison
+//   texts      like changed, with the text sensors bound as well; their std::string in TextSensor::publish_state() allocates for texts
+//              past its inline capacity, on ESPHome as much as here, so its allocations are reported but not gated
+
+#include "daikin_x10a.h"
+#include "x10a_simulator.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+static constexpr uint32_t Default_Sweeps = 20000;
+static constexpr int Timing_Runs = 7;           // every timing is the median of these
+static constexpr double Ratio_Tolerance = 0.3;  // relative; timings are noisy even as ratios
+
+//__________________________________________________________________________________________________________________________ heap begin
+static bool counting = false;
+static uint64_t allocations = 0;
+
+static void *bench_alloc(size_t size) {
+  if (counting) allocations++;
+  void *ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new(size_t size) { return bench_alloc(size); }
+void *operator new[](size_t size) { return bench_alloc(size); }
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+//________________________________________________________________ heap end
+
+//__________________________________________________________________________________________________________________________ bench begin
+// process_frame_() and select_converter_() are protected
+class Bench : public DaikinX10A {
+ public:
+  using DaikinX10A::DaikinX10A;
+  using DaikinX10A::process_frame_;
+  using DaikinX10A::ConvertFn;
+  using DaikinX10A::select_converter_;
+};
+
+// Two frames per registry that differ in every data byte, so alternating them changes every register
+struct RegistryFrames {
+  uint8_t registry_id{0};
+  daikin_package a{daikin_package::Mode::RECEIVE};
+  daikin_package b{daikin_package::Mode::RECEIVE};
+};
+
+static void build_frame(daikin_package &frame, uint8_t registry_id, const std::vector<uint8_t> &data) {
+  frame.clear();
+  uint8_t sum = 0;
+  auto push = [&](uint8_t byte) {
+    frame.push_back(byte);
+    sum += byte;
+  };
+  push(0x40);
+  push(registry_id);
+  push((uint8_t)(data.size() + 2));
+  for (uint8_t byte : data) push(byte);
+  frame.push_back((uint8_t)~sum);
+}
+
+static std::vector<RegistryFrames> build_frames(const RegisterTable &table, uint64_t seed) {
+  std::map<uint8_t, size_t> sizes;
+  for (const auto &row : table.rows) sizes[row.registryID] = std::max<size_t>(sizes[row.registryID], row.offset + row.dataSize);
+  Random random(seed);
+  std::vector<RegistryFrames> frames(sizes.size());
+  size_t i = 0;
+  for (const auto &size : sizes) {
+    std::vector<uint8_t> data(size.second);
+    for (auto &byte : data) byte = (uint8_t)random.below(256);
+    frames[i].registry_id = size.first;
+    build_frame(frames[i].a, size.first, data);
+    for (auto &byte : data) byte ^= 0x11;
+    build_frame(frames[i].b, size.first, data);
+    i++;
+  }
+  return frames;
+}
+
+// The in-run reference: every pair of bytes of every frame read as a little-endian int16 and scaled to a float, a tenth of the sweeps;
+// about what a converter does, without the component around it
+struct Reference {
+  const std::vector<RegistryFrames> &frames;
+  uint32_t sweeps;
+
+  double ns_per_frame() const {
+    static volatile float sink __attribute__((unused));
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t sweep = 0; sweep < sweeps; sweep++) {
+      for (const auto &registry : frames) {
+        const daikin_package &frame = (sweep & 1) == 0 ? registry.b : registry.a;
+        const uint8_t *data = frame.data();
+        for (size_t i = 3; i + 2 < frame.size(); i += 2) sink = (float)(int16_t)(data[i] | data[i + 1] << 8) * 0.1f;
+      }
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ((double)sweeps * frames.size());
+  }
+};
+
+struct Measured {
+  double ns;             // per unit of work
+  double per_reference;  // over the reference's ns per frame
+};
+
+static double median(std::array<double, Timing_Runs> values) {
+  std::sort(values.begin(), values.end());
+  return values[Timing_Runs / 2];
+}
+
+// Timing_Runs runs of body, each right after a run of the reference so that both see the machine in the same state: the medians of
+// the ns per unit of work (count units per run) and of its ratio to the reference
+template<typename Body> static Measured time_runs(const Reference &reference, double count, Body &&body) {
+  std::array<double, Timing_Runs> ns, ratios;  // not on the heap: run_pass() counts allocations around this
+  for (int run = 0; run < Timing_Runs; run++) {
+    const double reference_ns = reference.ns_per_frame();
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    ns[run] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    ratios[run] = ns[run] / reference_ns;
+  }
+  return Measured{median(ns), median(ratios)};
+}
+
+struct PassResult {
+  Measured frame;
+  double allocations_per_frame;
+};
+
+// sweeps times every registry's frame; alternate picks a or b by sweep, so every frame differs from the one before it
+static PassResult run_pass(const Reference &reference, Bench &component, std::vector<RegistryFrames> &frames, uint32_t sweeps,
+                           bool alternate) {
+  for (auto &registry : frames) component.process_frame_(registry.a);  // sizes the frame caches
+  const double count = (double)sweeps * frames.size();
+  const uint64_t before = allocations;
+  counting = true;
+  const Measured frame = time_runs(reference, count, [&] {
+    for (uint32_t sweep = 0; sweep < sweeps; sweep++) {
+      const bool b = alternate && (sweep & 1) == 0;
+      for (auto &registry : frames) component.process_frame_(b ? registry.b : registry.a);
+    }
+  });
+  counting = false;
+  return PassResult{frame, (allocations - before) / (count * Timing_Runs)};
+}
+
+// The families of run_decode_benchmark(), with the text and unsupported converters as their own
+static const char *convid_family(uint16_t convid) {
+  if (convid == 100) return "text";
+  if (convid >= 101 && convid <= 108) return "signed";
+  if (convid >= 151 && convid <= 156) return "unsigned";
+  if (text_convid(convid) || convid == 312) return "tables";
+  if (convid >= 401 && convid <= 406) return "r32";
+  return "unsupported";
+}
+
+struct RegisterTiming {
+  const RegisterDef *def;
+  Measured conversion;
+};
+
+// The converter of every register with one, iterations times on its bytes of the a and b frames of its registry. ns per conversion
+static std::vector<RegisterTiming> time_registers(const Reference &reference, const RegisterTable &table,
+                                                  const std::vector<RegistryFrames> &frames, uint32_t iterations) {
+  std::vector<RegisterTiming> timings;
+  char text[2 * REGISTER_TEXT_SIZE];
+  for (const auto &row : table.rows) {
+    const Bench::ConvertFn convert = Bench::select_converter_(row);
+    if (convert == nullptr) continue;
+    const RegistryFrames *registry = nullptr;
+    for (const auto &candidate : frames) {
+      if (candidate.registry_id == row.registryID) registry = &candidate;
+    }
+    RegisterState state;
+    state.text = text;
+    const uint8_t *data[2] = {registry->a.data() + 3 + row.offset, registry->b.data() + 3 + row.offset};
+    timings.push_back({&row, time_runs(reference, iterations, [&] {
+                         for (uint32_t i = 0; i < iterations; i++) convert(row, state, data[i & 1]);
+                       })});
+  }
+  return timings;
+}
+//________________________________________________________________ bench end
+
+//__________________________________________________________________________________________________________________________ main begin
+struct Options {
+  uint32_t sweeps{Default_Sweeps};
+  uint64_t seed{1};
+  bool read_all{true};
+  std::string yaml{source_path("m5poe.yaml")};
+  std::string baseline{source_path("tools/x10a_decode_bench/baseline.txt")};
+  bool write{false};
+  bool allocations_only{false};
+};
+
+static void usage() {
+  std::printf("usage: x10a_decode_bench [--sweeps N] [--seed N] [--yaml PATH] [--yaml-modes] [--baseline PATH] [--write-baseline]\n"
+              "                         [--allocations-only]\n");
+}
+
+int main(int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (arg == "--sweeps" && has_value) {
+      options.sweeps = (uint32_t)std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--seed" && has_value) {
+      options.seed = std::strtoull(argv[++i], nullptr, 0);
+    } else if (arg == "--yaml" && has_value) {
+      options.yaml = argv[++i];
+    } else if (arg == "--yaml-modes") {
+      options.read_all = false;
+    } else if (arg == "--baseline" && has_value) {
+      options.baseline = argv[++i];
+    } else if (arg == "--write-baseline") {
+      options.write = true;
+    } else if (arg == "--allocations-only") {
+      options.allocations_only = true;
+    } else {
+      usage();
+      return 2;
+    }
+  }
+
+  RegisterTable table;
+  if (!load_registers(options.yaml, options.read_all, table)) {
+    std::printf("no register lines in %s\n", options.yaml.c_str());
+    return 2;
+  }
+  std::vector<RegistryFrames> frames = build_frames(table, options.seed);
+
+  // One component with the numeric sensors bound, one with the text sensors as well. loop() never runs, so the heat pump is never
+  // asked: the frames go into process_frame_() directly
+  SimulatedHeatPump hp;
+  Bench numeric(&hp), texts(&hp);
+  std::deque<sensor::Sensor> sensors;
+  std::deque<text_sensor::TextSensor> text_sensors;
+  unsigned bound = 0;
+  for (Bench *component : {&numeric, &texts}) {
+    component->set_register_table(table.rows.data(), (uint16_t)table.rows.size());
+    for (uint16_t handle = 0; handle < table.rows.size(); handle++) {
+      const RegisterDef &row = table.rows[handle];
+      if (row.Mode != 1 || row.convid == 0x00) continue;
+      if (!text_convid(row.convid)) {
+        sensors.emplace_back();
+        component->bind_sensor(handle, &sensors.back());
+      } else if (component == &texts) {
+        text_sensors.emplace_back();
+        component->bind_text_sensor(handle, &text_sensors.back());
+      }
+      if (component == &texts) bound++;
+    }
+    component->setup();
+  }
+  std::printf("%u registers, %u sensors, %u registries, %u sweeps\n", (unsigned)table.rows.size(), bound, (unsigned)frames.size(),
+              options.sweeps);
+
+  const Reference reference{frames, std::max<uint32_t>(1, options.sweeps / 10)};
+  const PassResult changed = run_pass(reference, numeric, frames, options.sweeps, true);
+  const PassResult identical = run_pass(reference, numeric, frames, options.sweeps, false);
+  const PassResult with_texts = run_pass(reference, texts, frames, options.sweeps, true);
+
+  // Allocations are gated exactly: process_frame_() itself never allocates once the frame caches are sized
+  std::vector<Metric> metrics = {
+      {"changed_allocations_per_frame", changed.allocations_per_frame, Rule::LOWER, 0, 0},
+      {"identical_allocations_per_frame", identical.allocations_per_frame, Rule::LOWER, 0, 0},
+      {"texts_allocations_per_frame", with_texts.allocations_per_frame, Rule::INFO, 0, 0},
+  };
+  if (!options.allocations_only) {
+    // ns are machine specific and only shown, the ratios are gated
+    const std::pair<const char *, const PassResult *> passes[] = {{"changed", &changed}, {"identical", &identical}, {"texts", &with_texts}};
+    for (const auto &pass : passes) {
+      metrics.push_back({std::string(pass.first) + "_ns_per_frame", pass.second->frame.ns, Rule::INFO, 0, 0});
+      metrics.push_back({std::string(pass.first) + "_per_reference", pass.second->frame.per_reference, Rule::LOWER, Ratio_Tolerance, 0.1});
+    }
+
+    // Per register on stdout, per family (the mean over its registers) in the baseline
+    const std::vector<RegisterTiming> timings = time_registers(reference, table, frames, options.sweeps);
+    std::map<std::string, std::pair<Measured, unsigned>> families;
+    std::printf("  %-8s %-6s %-8s %-44s %10s %10s\n", "registry", "offset", "convid", "label", "ns", "reference");
+    for (const auto &timing : timings) {
+      const RegisterDef &row = *timing.def;
+      std::printf("  0x%02X     %-6u %-8u %-44.44s %10.2f %10.3f\n", (unsigned)row.registryID, (unsigned)row.offset,
+                  (unsigned)row.convid, row.label, timing.conversion.ns, timing.conversion.per_reference);
+      auto &family = families[convid_family(row.convid)];
+      family.first.ns += timing.conversion.ns;
+      family.first.per_reference += timing.conversion.per_reference;
+      family.second++;
+    }
+    for (const auto &family : families) {
+      const unsigned count = family.second.second;
+      std::printf("  %-12s %4u registers %10.2f ns/register\n", family.first.c_str(), count, family.second.first.ns / count);
+      metrics.push_back({"family_" + family.first + "_per_reference", family.second.first.per_reference / count, Rule::LOWER,
+                         Ratio_Tolerance, 0.1});
+    }
+  }
+
+  std::ostringstream config;
+  config << "registers=" << table.rows.size() << " read_all=" << (options.read_all ? 1 : 0) << " seed=" << options.seed;
+  if (options.write) {
+    write_baseline(options.baseline,
+                   {"x10a_decode_bench baseline, written with --write-baseline; *_per_reference are timings over the in-run reference",
+                    "texts_allocations_per_frame are TextSensor::publish_state() copies of texts longer than std::string keeps inline"},
+                   config.str(), metrics);
+    for (const auto &metric : metrics) std::printf("  %-32s %12.6g\n", metric.key.c_str(), metric.value);
+    std::printf("baseline written to %s\n", options.baseline.c_str());
+    return 0;
+  }
+
+  std::string baseline_config;
+  std::map<std::string, double> baseline;
+  if (!read_baseline(options.baseline, baseline_config, baseline)) {
+    for (const auto &metric : metrics) std::printf("  %-32s %12.6g\n", metric.key.c_str(), metric.value);
+    std::printf("no baseline at %s; --write-baseline stores this run as one\n", options.baseline.c_str());
+    return 0;
+  }
+  if (baseline_config != config.str()) {
+    std::printf("%s was written for %s, this run is %s; compare like with like or pass --write-baseline\n", options.baseline.c_str(),
+                baseline_config.c_str(), config.str().c_str());
+    return 2;
+  }
+  const int regressions = compare_baseline(metrics, baseline);
+  std::printf("%s\n", regressions == 0 ? "PASS" : "FAIL");
+  return regressions == 0 ? 0 : 1;
+}
+//________________________________________________________________ main end
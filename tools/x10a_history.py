@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Downloads or decodes the daikin_x10a history export; writes the same CSV the device serves at /history.csv.
+
+The binary format is described in components/daikin_x10a/daikin_history.h.
+
+    x10a_history.py http://m5poe.local:8081/history.bin -o history.csv
+    x10a_history.py --file history.bin             (saved earlier, or received with: nc -l 5556 > history.bin)
+
+Ages count back from the moment the export started; --now adds a column with the local time of every row.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import urllib.request
+from datetime import datetime, timedelta
+
+HEADER = struct.Struct("<2sBB")  # 'XH', version, series count
+RAW = struct.Struct("<BIf")  # series, age (ms), value
+SLOT = struct.Struct("<BIfff")  # series, age of the period start (ms), min, avg, max
+TIERS = {1: "raw", 2: "1min", 3: "15min"}
+COLUMNS = ["register", "tier", "age_s", "value", "min", "max"]
+
+
+def number(value, decimals):
+    return "" if value != value else f"{value:.{decimals}f}"
+
+
+def decode(data, writer, now):
+    magic, version, count = HEADER.unpack_from(data)
+    if magic != b"XH" or version != 1:
+        sys.exit("not a daikin_x10a history export (version 1)")
+    labels = [""] * count
+    decimals = [1] * count
+    pos = HEADER.size
+    while pos < len(data):
+        kind = data[pos]
+        pos += 1
+        if kind == 0:
+            series, places, length = data[pos:pos + 3]
+            decimals[series] = places
+            labels[series] = data[pos + 3:pos + 3 + length].decode("utf-8", "replace")
+            pos += 3 + length
+            continue
+        if kind == 1:
+            series, age_ms, value = RAW.unpack_from(data, pos)
+            pos += RAW.size
+            row = dict(tier="raw", age_s=f"{age_ms // 1000}.{age_ms % 1000 // 100}", value=number(value, decimals[series]), min="",
+                       max="")
+        elif kind in TIERS:
+            series, age_ms, low, avg, high = SLOT.unpack_from(data, pos)
+            pos += SLOT.size
+            places = decimals[series]
+            row = dict(tier=TIERS[kind], age_s=str(age_ms // 1000), value=number(avg, places), min=number(low, places),
+                       max=number(high, places))
+        else:
+            sys.exit(f"unknown record type {kind} at byte {pos - 1}")
+        row["register"] = labels[series]
+        if now is not None:
+            row["time"] = (now - timedelta(milliseconds=age_ms)).isoformat(timespec="seconds")
+        writer.writerow(row)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("url", nargs="?", help="http://<device>:<port>/history.bin")
+    source.add_argument("--file", help="decode a binary export saved earlier")
+    parser.add_argument("--now", action="store_true", help="add a time column, counting back from now (downloads only)")
+    parser.add_argument("-o", "--output", help="CSV file (default: stdout)")
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    else:
+        with urllib.request.urlopen(args.url, timeout=30) as response:
+            data = response.read()
+    now = datetime.now() if args.now and not args.file else None
+
+    out = open(args.output, "w", newline="", encoding="utf-8") if args.output else sys.stdout
+    writer = csv.DictWriter(out, fieldnames=COLUMNS + (["time"] if now else []), lineterminator="\n")
+    writer.writeheader()
+    decode(data, writer, now)
+
+
+if __name__ == "__main__":
+    main()
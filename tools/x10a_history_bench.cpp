@@ -0,0 +1,105 @@
+// Host benchmark of the history store (components/daikin_x10a/daikin_history.h): memory per register, insert cost and export
+// throughput, for the defaults of the history block or the sizes given on the command line.
+//
+//   cmake -S . -B build && cmake --build build --target x10a_history_bench
+//   build/x10a_history_bench [--check] [registers] [raw_size] [minute_slots] [quarter_hour_slots] [poll_s] [days]
+//
+// --check is what ctest runs: the timings depend on the machine, what the store keeps does not. It fails when a series kept no raw
+// samples, an aggregate tier is not filled as far as the run reaches, or an export does not end or differs between two rounds
+
+#include "daikin_history.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) { return std::chrono::duration<double>(Clock::now() - start).count(); }
+
+int main(int argc, char **argv) {
+  const bool check = argc > 1 && std::string(argv[1]) == "--check";
+  if (check) {
+    argc--;
+    argv++;
+  }
+  const int registers = argc > 1 ? std::atoi(argv[1]) : 8;
+  const uint32_t raw_bytes = argc > 2 ? std::atoi(argv[2]) : 4096;
+  const uint16_t slots[daikin_history_series::TIERS] = {(uint16_t)(argc > 3 ? std::atoi(argv[3]) : 360),
+                                                         (uint16_t)(argc > 4 ? std::atoi(argv[4]) : 672)};
+  const uint32_t poll_ms = (argc > 5 ? std::atoi(argv[5]) : 30) * 1000;
+  const uint32_t days = argc > 6 ? std::atoi(argv[6]) : 7;
+
+  const size_t per_series = daikin_history_series::memory_needed(raw_bytes, slots);
+  std::vector<uint8_t> memory(per_series * registers);
+  std::vector<daikin_history_series> series(registers);
+  std::vector<std::string> names;
+  std::vector<const char *> labels;
+  for (int i = 0; i < registers; i++) {
+    series[i].init(memory.data() + i * per_series, raw_bytes, slots, 0.1f, 900000);
+    names.push_back("Register " + std::to_string(i));
+  }
+  for (const auto &name : names) labels.push_back(name.c_str());
+
+  // Water temperatures: a slow random walk in 0.1 degree steps, a few percent of the polls without a value
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> step(-2, 2);
+  std::uniform_int_distribution<int> percent(0, 99);
+  std::vector<float> value(registers, 35.0f);
+  const uint32_t polls = days * 86400000ULL / poll_ms;
+  std::vector<float> samples((size_t)polls * registers);
+  for (auto &v : samples) {
+    const size_t i = &v - samples.data();
+    float &current = value[i % registers];
+    current += step(rng) * 0.1f;
+    v = percent(rng) < 2 ? NAN : current;
+  }
+
+  const auto start = Clock::now();
+  uint32_t now_ms = 0;
+  for (uint32_t p = 0; p < polls; p++, now_ms += poll_ms) {
+    for (int i = 0; i < registers; i++) series[i].add(now_ms, samples[(size_t)p * registers + i]);
+  }
+  const double insert_s = seconds_since(start);
+  for (auto &s : series) s.tick(now_ms);
+
+  std::printf("%d registers, %u bytes each (%u raw, %u x 1 min, %u x 15 min), %u bytes in total\n", registers, (unsigned)per_series,
+              (unsigned)raw_bytes, (unsigned)slots[0], (unsigned)slots[1], (unsigned)memory.size());
+  std::printf("insert: %u samples in %.3f s, %.1f ns per sample\n", polls * registers, insert_s, insert_s * 1e9 / (polls * registers));
+  const daikin_history_series &first = series[0];
+  if (first.raw_samples() > 0)
+    std::printf("raw: %u samples kept, %.2f bytes per sample, %.1f hours at a %u s poll\n", (unsigned)first.raw_samples(),
+                (double)first.raw_bytes_used() / first.raw_samples(), first.raw_span_ms() / 3600000.0, (unsigned)(poll_ms / 1000));
+  std::printf("aggregates: %u x 1 min (%.1f hours), %u x 15 min (%.1f days)\n", first.slots_used(0), first.slots_used(0) / 60.0,
+              first.slots_used(1), first.slots_used(1) / 96.0);
+
+  int failures = 0;
+  const uint32_t reached[daikin_history_series::TIERS] = {std::min<uint32_t>(slots[0], days * 1440 - 1),
+                                                          std::min<uint32_t>(slots[1], days * 96 - 1)};
+  for (const auto &s : series) {
+    if (s.raw_samples() == 0 || s.slots_used(0) < reached[0] || s.slots_used(1) < reached[1]) failures++;
+  }
+
+  for (auto format : {daikin_history_export::Format::CSV, daikin_history_export::Format::BINARY}) {
+    daikin_history_export exporter;
+    uint8_t chunk[1024];  // the chunk size daikin_history.cpp sends
+    size_t bytes = 0, first_round = 0;
+    const int rounds = 20;
+    const auto export_start = Clock::now();
+    for (int r = 0; r < rounds; r++) {
+      exporter.begin(series.data(), labels.data(), (uint8_t)registers, format, now_ms);
+      while (size_t n = exporter.fill(chunk, sizeof(chunk))) bytes += n;
+      if (r == 0) first_round = bytes;
+      if (!exporter.done() || bytes != first_round * (r + 1)) failures++;
+    }
+    const double export_s = seconds_since(export_start);
+    std::printf("export %-6s: %u bytes, %.1f MB/s\n", format == daikin_history_export::Format::CSV ? "csv" : "binary",
+                (unsigned)(bytes / rounds), bytes / export_s / 1e6);
+  }
+  if (check) std::printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return check && failures != 0 ? 1 : 0;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "esphome/core/hal.h"
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+namespace sensor {
+
+// Counts its publishes and remembers when the last one was, on the virtual clock
+class Sensor {
+ public:
+  void publish_state(float state) {
+    this->state = state;
+    publishes++;
+    last_publish_us = host_clock_us.load(std::memory_order_relaxed);
+  }
+  float state{0.0f};
+  uint64_t publishes{0};
+  uint64_t last_publish_us{0};
+};
+
+}  // namespace sensor
+}  // namespace esphome
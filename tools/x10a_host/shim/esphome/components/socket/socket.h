@@ -0,0 +1,75 @@
+#pragma once
+#include <arpa/inet.h>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace esphome {
+namespace socket {
+
+// POSIX sockets behind ESPHome's socket API (IPv4), so telemetry and the history export talk to real listeners on the host
+class Socket {
+ public:
+  explicit Socket(int fd) : fd_(fd) {}
+  ~Socket() { ::close(fd_); }
+  Socket(const Socket &) = delete;
+  Socket &operator=(const Socket &) = delete;
+
+  int connect(const struct sockaddr *addr, socklen_t addrlen) { return ::connect(fd_, addr, addrlen); }
+  ssize_t write(const void *buf, size_t len) { return ::send(fd_, buf, len, MSG_NOSIGNAL); }
+  ssize_t sendto(const void *buf, size_t len, int flags, const struct sockaddr *to, socklen_t tolen) {
+    return ::sendto(fd_, buf, len, flags | MSG_NOSIGNAL, to, tolen);
+  }
+  ssize_t read(void *buf, size_t len) { return ::recv(fd_, buf, len, 0); }
+  int bind(const struct sockaddr *addr, socklen_t addrlen) { return ::bind(fd_, addr, addrlen); }
+  int listen(int backlog) { return ::listen(fd_, backlog); }
+  int setsockopt(int level, int optname, const void *optval, socklen_t optlen) {
+    return ::setsockopt(fd_, level, optname, optval, optlen);
+  }
+  int setblocking(bool blocking) {
+    const int flags = ::fcntl(fd_, F_GETFL, 0);
+    return ::fcntl(fd_, F_SETFL, blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK);
+  }
+  std::unique_ptr<Socket> accept(struct sockaddr *addr, socklen_t *addrlen) {
+    const int fd = ::accept(fd_, addr, addrlen);
+    return fd < 0 ? nullptr : std::make_unique<Socket>(fd);
+  }
+  int get_fd() const { return fd_; }
+
+ private:
+  int fd_;
+};
+
+inline std::unique_ptr<Socket> socket_ip(int type, int protocol) {
+  const int fd = ::socket(AF_INET, type, protocol);
+  return fd < 0 ? nullptr : std::make_unique<Socket>(fd);
+}
+
+// An IP literal only, like ESPHome; 0 when it is not one
+inline socklen_t set_sockaddr(struct sockaddr *addr, socklen_t addrlen, const std::string &ip_address, uint16_t port) {
+  if (addrlen < sizeof(struct sockaddr_in)) return 0;
+  auto *server = reinterpret_cast<struct sockaddr_in *>(addr);
+  std::memset(server, 0, sizeof(*server));
+  server->sin_family = AF_INET;
+  server->sin_port = htons(port);
+  if (::inet_pton(AF_INET, ip_address.c_str(), &server->sin_addr) != 1) return 0;
+  return sizeof(struct sockaddr_in);
+}
+
+inline socklen_t set_sockaddr_any(struct sockaddr *addr, socklen_t addrlen, uint16_t port) {
+  if (addrlen < sizeof(struct sockaddr_in)) return 0;
+  auto *server = reinterpret_cast<struct sockaddr_in *>(addr);
+  std::memset(server, 0, sizeof(*server));
+  server->sin_family = AF_INET;
+  server->sin_port = htons(port);
+  server->sin_addr.s_addr = htonl(INADDR_ANY);
+  return sizeof(struct sockaddr_in);
+}
+
+}  // namespace socket
+}  // namespace esphome
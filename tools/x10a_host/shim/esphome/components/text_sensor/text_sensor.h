@@ -0,0 +1,22 @@
+#pragma once
+#include "esphome/core/hal.h"
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor {
+ public:
+  void publish_state(const std::string &state) {
+    this->state = state;
+    publishes++;
+    last_publish_us = host_clock_us.load(std::memory_order_relaxed);
+  }
+  std::string state;
+  uint64_t publishes{0};
+  uint64_t last_publish_us{0};
+};
+
+}  // namespace text_sensor
+}  // namespace esphome
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace uart {
+
+enum UARTParityOptions { UART_CONFIG_PARITY_NONE, UART_CONFIG_PARITY_EVEN, UART_CONFIG_PARITY_ODD };
+
+// tools/x10a_host/x10a_simulator.h derives the simulated heat pump from this; 8E1 like the X10A port, 9600 baud unless set
+class UARTComponent {
+ public:
+  virtual ~UARTComponent() = default;
+  virtual void write_array(const uint8_t *data, size_t len) = 0;
+  virtual int available() = 0;
+  virtual bool read_array(uint8_t *data, size_t len) = 0;
+  void set_baud_rate(uint32_t baud_rate) { baud_rate_ = baud_rate; }
+  uint32_t get_baud_rate() const { return baud_rate_; }
+  uint8_t get_data_bits() const { return 8; }
+  uint8_t get_stop_bits() const { return 1; }
+  UARTParityOptions get_parity() const { return UART_CONFIG_PARITY_EVEN; }
+
+ protected:
+  uint32_t baud_rate_{9600};
+};
+
+class UARTDevice {
+ public:
+  UARTDevice() = default;
+  explicit UARTDevice(UARTComponent *parent) : parent_(parent) {}
+  void write_array(const uint8_t *data, size_t len) { parent_->write_array(data, len); }
+  int available() { return parent_->available(); }
+  bool read_array(uint8_t *data, size_t len) { return parent_->read_array(data, len); }
+  bool read_byte(uint8_t *data) { return parent_->read_array(data, 1); }
+  void flush() {}
+
+ protected:
+  UARTComponent *parent_{nullptr};
+};
+
+}  // namespace uart
+}  // namespace esphome
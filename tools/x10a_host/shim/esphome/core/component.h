@@ -0,0 +1,71 @@
+#pragma once
+#include "hal.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace esphome {
+
+class Component;
+
+// set_interval()/set_timeout() land here; host_run_timers() runs the due ones on the virtual clock, like App does before every loop()
+struct HostTimer {
+  Component *owner;
+  std::string name;
+  uint64_t due_ms;
+  uint32_t interval_ms;  // 0 = timeout, runs once
+  std::function<void()> callback;
+};
+inline std::vector<HostTimer> host_timers;
+
+inline void host_run_timers() {
+  const uint64_t now_ms = host_clock_us.load(std::memory_order_relaxed) / 1000;
+  for (size_t i = 0; i < host_timers.size(); i++) {
+    if (host_timers[i].due_ms > now_ms) continue;
+    if (host_timers[i].interval_ms != 0) host_timers[i].due_ms += host_timers[i].interval_ms;
+    else host_timers[i].due_ms = UINT64_MAX;
+    host_timers[i].callback();
+  }
+}
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual void on_shutdown() {}
+  virtual float get_setup_priority() const { return 0.0f; }
+  void mark_failed() { failed_ = true; }
+  bool is_failed() const { return failed_; }
+  void status_set_warning() {}
+  void status_clear_warning() {}
+
+ protected:
+  void set_interval(const std::string &name, uint32_t interval_ms, std::function<void()> &&f) {
+    this->schedule_(name, interval_ms, interval_ms, std::move(f));
+  }
+  void set_timeout(const std::string &name, uint32_t timeout_ms, std::function<void()> &&f) {
+    this->schedule_(name, timeout_ms, 0, std::move(f));
+  }
+
+ private:
+  void schedule_(const std::string &name, uint32_t delay_ms, uint32_t interval_ms, std::function<void()> &&f) {
+    const uint64_t due = host_clock_us.load(std::memory_order_relaxed) / 1000 + delay_ms;
+    for (auto &timer : host_timers) {
+      if (timer.owner != this || timer.name != name) continue;
+      timer = HostTimer{this, name, due, interval_ms, std::move(f)};
+      return;
+    }
+    host_timers.push_back(HostTimer{this, name, due, interval_ms, std::move(f)});
+  }
+  bool failed_{false};
+};
+
+namespace setup_priority {
+inline constexpr float DATA = 600.0f;
+inline constexpr float AFTER_CONNECTION = 100.0f;
+}  // namespace setup_priority
+
+}  // namespace esphome
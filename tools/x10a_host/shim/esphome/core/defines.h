@@ -0,0 +1,3 @@
+#pragma once
+// Host stand-in for the ESPHome headers the daikin_x10a component uses (tools/x10a_host). ESPHome generates this file with the
+// USE_DAIKIN_X10A_* defines of the blocks in the YAML; on the host they come from the build instead, per library in CMakeLists.txt
@@ -0,0 +1,8 @@
+#pragma once
+#include <cstdint>
+
+namespace esphome {
+
+enum EntityCategory : uint8_t { ENTITY_CATEGORY_NONE = 0, ENTITY_CATEGORY_CONFIG = 1, ENTITY_CATEGORY_DIAGNOSTIC = 2 };
+
+}  // namespace esphome
@@ -0,0 +1,14 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace esphome {
+
+// The virtual clock: the host program (test, benchmark, soak) moves host_clock_us forward. millis() and micros() truncate it to 32 bits
+// like the ESP32 does, so micros() wraps every 71.6 minutes and millis() every 49.7 days. Atomic because the UART task reads it too
+inline std::atomic<uint64_t> host_clock_us{0};
+inline uint32_t micros() { return static_cast<uint32_t>(host_clock_us.load(std::memory_order_relaxed)); }
+inline uint32_t millis() { return static_cast<uint32_t>(host_clock_us.load(std::memory_order_relaxed) / 1000); }
+inline void delay(uint32_t ms) { host_clock_us.fetch_add(ms * 1000ULL, std::memory_order_relaxed); }
+
+}  // namespace esphome
@@ -0,0 +1,28 @@
+#include "esphome/core/log.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+namespace esphome {
+
+int host_log_level = 2;
+void (*host_log_sink)(int level, const char *tag, const char *text) = nullptr;
+std::atomic<uint64_t> host_log_counts[6];
+
+void host_log(int level, const char *tag, const char *format, ...) {
+  host_log_counts[level].fetch_add(1, std::memory_order_relaxed);
+  if (level > host_log_level) return;
+  char text[512];
+  va_list args;
+  va_start(args, format);
+  std::vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  if (host_log_sink != nullptr) {
+    host_log_sink(level, tag, text);
+    return;
+  }
+  static const char *const Levels = "?EWIDV";
+  std::printf("%c %s: %s\n", Levels[level], tag, text);
+}
+
+}  // namespace esphome
@@ -0,0 +1,21 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace esphome {
+
+// Every message is counted per level (1 error, 2 warning, 3 info, 4 debug, 5 verbose). The ones at or above host_log_level are
+// formatted and handed to host_log_sink, or printed when there is none (log.cpp)
+void host_log(int level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+extern int host_log_level;
+extern void (*host_log_sink)(int level, const char *tag, const char *text);
+extern std::atomic<uint64_t> host_log_counts[6];
+
+}  // namespace esphome
+
+#define ESP_LOGE(tag, ...) ::esphome::host_log(1, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) ::esphome::host_log(2, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) ::esphome::host_log(3, tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) ::esphome::host_log(3, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) ::esphome::host_log(4, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) ::esphome::host_log(5, tag, __VA_ARGS__)
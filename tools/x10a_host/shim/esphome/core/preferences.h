@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace esphome {
+
+// Flash in memory. save() only stages a copy of the record (ESPHome's ESP32 preferences allocate a pending save too, so a host program
+// counts it); sync() commits the staged records that differ from flash, which the host program calls every flash_write_interval like
+// ESPHome does, and counts as flash writes
+struct HostFlash {
+  std::map<uint32_t, std::vector<uint8_t>> committed, staged;
+  uint64_t writes{0};
+  uint64_t bytes_written{0};
+};
+inline HostFlash host_flash;
+
+class ESPPreferenceObject {
+ public:
+  ESPPreferenceObject() = default;
+  explicit ESPPreferenceObject(uint32_t key) : key_(key) {}
+  template<typename T> bool save(const T *src) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(src);
+    host_flash.staged[key_].assign(bytes, bytes + sizeof(T));
+    return true;
+  }
+  template<typename T> bool load(T *dest) {
+    auto it = host_flash.committed.find(key_);
+    if (it == host_flash.committed.end() || it->second.size() != sizeof(T)) return false;
+    std::memcpy(dest, it->second.data(), sizeof(T));
+    return true;
+  }
+
+ private:
+  uint32_t key_{0};
+};
+
+class ESPPreferences {
+ public:
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool in_flash) {
+    (void) in_flash;
+    return ESPPreferenceObject(type);
+  }
+  bool sync() {
+    for (auto &record : host_flash.staged) {
+      auto &flash = host_flash.committed[record.first];
+      if (flash == record.second) continue;
+      flash = record.second;
+      host_flash.writes++;
+      host_flash.bytes_written += flash.size();
+    }
+    host_flash.staged.clear();
+    return true;
+  }
+};
+
+inline ESPPreferences host_preferences;
+inline ESPPreferences *global_preferences = &host_preferences;
+
+}  // namespace esphome
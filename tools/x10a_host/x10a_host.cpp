@@ -0,0 +1,134 @@
+#include "x10a_host.h"
+#include "esphome/core/preferences.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <regex>
+#include <sstream>
+
+using namespace esphome;
+
+//__________________________________________________________________________________________________________________________ register table begin
+bool text_convid(uint16_t convid) {
+  return convid == 200 || convid == 201 || convid == 203 || convid == 204 || convid == 211 || convid == 217 ||
+         (convid >= 300 && convid <= 307) || convid == 315 || convid == 316;
+}
+
+bool known_convid(uint16_t convid) {
+  return convid == 0x00 || (convid >= 100 && convid <= 108) || (convid >= 151 && convid <= 156) || text_convid(convid) ||
+         convid == 312 || (convid >= 401 && convid <= 406);
+}
+
+void RegisterTable::add(const char *label, uint8_t registry_id, uint8_t offset, uint16_t convid, uint8_t data_size, uint8_t mode) {
+  labels.emplace_back(label);
+  rows.push_back(RegisterDef{labels.back().c_str(), convid, registry_id, offset, data_size, -1, mode});
+}
+
+bool load_registers(const std::string &path, bool read_all, RegisterTable &table) {
+  std::ifstream in(path);
+  if (!in) return false;
+  const std::regex row(R"re(^\s*- \{ mode: (\d+), registryID: (0x[0-9A-Fa-f]+), offset: (\d+), convid: (\d+), dataSize: (\d+), )re"
+                       R"re(dataType: (-?\d+), label: "(.*)" \})re");
+  std::string line;
+  std::smatch m;
+  while (std::getline(in, line)) {
+    if (!std::regex_search(line, m, row)) continue;
+    table.labels.push_back(m[7]);
+    RegisterDef def{};
+    def.label = table.labels.back().c_str();
+    def.convid = (uint16_t)std::stoi(m[4]);
+    def.registryID = (uint8_t)std::stoi(m[2], nullptr, 16);
+    def.offset = (uint8_t)std::stoi(m[3]);
+    def.dataSize = (uint8_t)std::stoi(m[5]);
+    def.dataType = (int8_t)std::stoi(m[6]);
+    def.Mode = read_all && known_convid(def.convid) ? 1 : (uint8_t)std::stoi(m[1]);
+    table.rows.push_back(def);
+  }
+  std::stable_sort(table.rows.begin(), table.rows.end(), [](const RegisterDef &a, const RegisterDef &b) {
+    return a.registryID != b.registryID ? a.registryID < b.registryID : a.offset < b.offset;
+  });
+  return !table.rows.empty();
+}
+
+std::string source_path(const std::string &relative) { return std::string(X10A_SOURCE_DIR) + "/" + relative; }
+//________________________________________________________________ register table end
+
+//__________________________________________________________________________________________________________________________ baseline begin
+bool read_baseline(const std::string &path, std::string &config, std::map<std::string, double> &values) {
+  std::ifstream in(path);
+  if (!in) return false;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.rfind("# config: ", 0) == 0) {
+      config = line.substr(10);
+    } else if (!line.empty() && line[0] != '#') {
+      std::istringstream fields(line);
+      std::string key;
+      double value;
+      if (fields >> key >> value) values[key] = value;
+    }
+  }
+  return true;
+}
+
+void write_baseline(const std::string &path, const std::vector<std::string> &notes, const std::string &config,
+                    const std::vector<Metric> &metrics) {
+  std::ofstream out(path);
+  for (const auto &note : notes) out << "# " << note << "\n";
+  out << "# config: " << config << "\n";
+  for (const auto &metric : metrics) {
+    char value[64];
+    std::snprintf(value, sizeof(value), "%.6g", metric.value);
+    out << metric.key << " " << value << "\n";
+  }
+}
+
+int compare_baseline(const std::vector<Metric> &metrics, const std::map<std::string, double> &baseline) {
+  int regressions = 0;
+  std::printf("  %-32s %12s %12s\n", "metric", "value", "baseline");
+  for (const auto &metric : metrics) {
+    auto it = baseline.find(metric.key);
+    if (it == baseline.end()) {
+      std::printf("  %-32s %12.6g %12s\n", metric.key.c_str(), metric.value, "-");
+      continue;
+    }
+    const char *verdict = "";
+    if (metric.rule != Rule::INFO) {
+      const double limit = it->second * metric.relative + metric.absolute;
+      const bool worse = metric.rule == Rule::LOWER ? metric.value > it->second + limit : std::fabs(metric.value - it->second) > limit;
+      if (worse) {
+        verdict = "  REGRESSION";
+        regressions++;
+      }
+    } else {
+      verdict = "  (info)";
+    }
+    std::printf("  %-32s %12.6g %12.6g%s\n", metric.key.c_str(), metric.value, it->second, verdict);
+  }
+  return regressions;
+}
+//________________________________________________________________ baseline end
+
+//__________________________________________________________________________________________________________________________ app begin
+void host_loop(std::initializer_list<Component *> components) {
+  host_run_timers();
+  for (Component *component : components) component->loop();
+}
+
+void host_run(std::initializer_list<Component *> components, uint64_t duration_us, uint64_t loop_us) {
+  const uint64_t end = host_clock_us.load() + duration_us;
+  while (host_clock_us.load() < end) {
+    host_loop(components);
+    host_clock_us.fetch_add(loop_us);
+  }
+}
+
+void host_reset(bool keep_flash) {
+  host_clock_us.store(0);
+  host_timers.clear();
+  if (!keep_flash) host_flash = HostFlash{};
+  host_flash.staged.clear();
+}
+//________________________________________________________________ app end
@@ -0,0 +1,90 @@
+// x10a_host.h
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "register_definitions.h"
+
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <vector>
+
+// Host build of the daikin_x10a component (CMakeLists.txt): shim/ stands in for ESPHome, x10a_simulator.h for the heat pump. This
+// header has what every host program needs besides those: register tables, stored baselines, a seeded random source and App.loop()
+
+inline constexpr uint64_t US_PER_MS = 1000;
+inline constexpr uint64_t US_PER_S = 1000000;
+inline constexpr uint64_t US_PER_MIN = 60 * US_PER_S;
+inline constexpr uint64_t US_PER_HOUR = 60 * US_PER_MIN;
+inline constexpr uint64_t US_PER_DAY = 24 * US_PER_HOUR;
+
+//__________________________________________________________________________________________________________________________ random begin
+// splitmix64: fast, and the same sequence on every platform
+struct Random {
+  uint64_t state;
+  explicit Random(uint64_t seed) : state(seed) {}
+  uint64_t next() {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+  uint32_t below(uint32_t n) { return (uint32_t)(next() % n); }
+  bool per_million(uint32_t rate) { return below(1000000) < rate; }
+};
+//________________________________________________________________ random end
+
+//__________________________________________________________________________________________________________________________ register table begin
+// Text convids and every convid select_converter_ knows, as in __init__.py
+bool text_convid(uint16_t convid);
+bool known_convid(uint16_t convid);
+
+struct RegisterTable {
+  std::deque<std::string> labels;  // stable addresses for RegisterDef::label
+  std::vector<RegisterDef> rows;
+
+  void add(const char *label, uint8_t registry_id, uint8_t offset, uint16_t convid, uint8_t data_size, uint8_t mode = 1);
+};
+
+// The register lines of a YAML: - { mode: 1, registryID: 0x10, offset: 0, convid: 217, dataSize: 1, dataType: -1, label: "..." }.
+// Sorted by registry and offset like __init__.py does. read_all makes every row mode 1 but the ones with an unknown convid, which
+// __init__.py only accepts as mode 0
+bool load_registers(const std::string &path, bool read_all, RegisterTable &table);
+
+// A file of this checkout, e.g. source_path("m5poe.yaml"); CMakeLists.txt sets X10A_SOURCE_DIR
+std::string source_path(const std::string &relative);
+//________________________________________________________________ register table end
+
+//__________________________________________________________________________________________________________________________ baseline begin
+// Stored results of a host program (tools/x10a_soak/baseline.txt, ...): "# config: ..." names the run they belong to, then one
+// "key value" per line. LOWER: worse when above baseline * (1 + relative) + absolute. BOTH: worse when further than that from the
+// baseline either way. INFO: printed next to the baseline, never a regression
+enum class Rule { LOWER, BOTH, INFO };
+
+struct Metric {
+  std::string key;
+  double value;
+  Rule rule;
+  double relative;
+  double absolute;
+};
+
+bool read_baseline(const std::string &path, std::string &config, std::map<std::string, double> &values);
+// notes: comment lines written above the values
+void write_baseline(const std::string &path, const std::vector<std::string> &notes, const std::string &config,
+                    const std::vector<Metric> &metrics);
+// Prints every metric next to its baseline value; returns the number of regressions
+int compare_baseline(const std::vector<Metric> &metrics, const std::map<std::string, double> &baseline);
+//________________________________________________________________ baseline end
+
+//__________________________________________________________________________________________________________________________ app begin
+// One pass of App.loop(): the due timers, then loop() of every component
+void host_loop(std::initializer_list<esphome::Component *> components);
+// host_loop() every loop_us of virtual time until duration_us have passed
+void host_run(std::initializer_list<esphome::Component *> components, uint64_t duration_us, uint64_t loop_us = 16 * US_PER_MS);
+// Back to boot: clock at 0, no timers, empty flash unless keep_flash (a reboot)
+void host_reset(bool keep_flash = false);
+//________________________________________________________________ app end
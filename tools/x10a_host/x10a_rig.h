@@ -0,0 +1,80 @@
+// x10a_rig.h
+#pragma once
+
+#include "x10a_host.h"
+#include "x10a_simulator.h"
+#include "daikin_x10a.h"
+
+// The component on a simulated heat pump, for the host tests: HostRig holds the register table, the heat pump and the component, a
+// test adds its rows and payloads, attach()es the table and binds its sensors. Header only, because every test program builds the
+// component with its own optional blocks (tests/CMakeLists.txt)
+
+//__________________________________________________________________________________________________________________________ host component begin
+// The component with the state the tests look at in reach. FreeRTOS is not on the host: a test plays the UART task by calling
+// process_frame_() and serve_task_requests_() after task_started(), and loop()'s side of the hand-over with drain_updates_()
+class HostX10A : public esphome::daikin_x10a::DaikinX10A {
+ public:
+  using DaikinX10A::DaikinX10A;
+  using DaikinX10A::drain_updates_;
+  using DaikinX10A::process_frame_;
+  using DaikinX10A::serve_task_requests_;
+
+  void task_started() { task_running_ = true; }
+  bool idle() const { return poll_state_ == PollState::IDLE; }
+  bool awaiting() const { return poll_state_ == PollState::AWAIT_HEADER || poll_state_ == PollState::AWAIT_BODY; }
+  size_t queued() const { return updates_.size(); }
+
+  RegisterState &state(RegisterHandle handle) { return register_states_[handle]; }
+  // Registers with a value, decoded eagerly or on demand
+  unsigned decoded() const {
+    unsigned count = 0;
+    for (const auto &state : register_states_) count += state.value.kind != RegisterValue::Kind::NONE;
+    return count;
+  }
+  uint32_t generation(uint8_t registry_id) const { return registry_cache_[registry_spans_[registry_id].cache].generation; }
+  // Learned by the probe, 0 until the registry answered
+  uint16_t frame_size(uint8_t registry_id) const {
+    for (const auto &entry : poll_schedule_) {
+      if (entry.registry_id == registry_id) return entry.frame_size;
+    }
+    return 0;
+  }
+#ifdef USE_DAIKIN_X10A_DIAGNOSTICS
+  using DaikinX10A::publish_diagnostics_;
+#endif
+#ifdef USE_DAIKIN_X10A_DERIVED
+  float &derived_value(uint8_t index) { return derived_states_[index].value; }
+#endif
+};
+//________________________________________________________________ host component end
+
+//__________________________________________________________________________________________________________________________ rig begin
+// HeatPump: SimulatedHeatPump, or a class derived from it (tests/test_allocations.cpp leaves its allocations out of the count)
+template<typename HeatPump = SimulatedHeatPump> struct BasicHostRig {
+  RegisterTable table;
+  HeatPump hp;
+  HostX10A component{&hp};
+
+  explicit BasicHostRig(uint64_t seed = 1) : hp(seed) {}
+
+  // Hands the rows added so far to the component and starts polling right at boot. max_backoff 1 polls every registry each scan
+  // interval, identical frames or not; 0 keeps the component's adaptive backoff
+  void attach(uint32_t scan_interval_ms = REGISTER_SCAN_INTERVAL_MS, uint8_t max_backoff = 0) {
+    component.set_register_table(table.rows.data(), (uint16_t)table.rows.size());
+    component.set_boot_delay(0);
+    component.set_scan_interval(scan_interval_ms);
+    if (max_backoff != 0) component.set_adaptive_backoff(max_backoff);
+  }
+  // One loop() after advancing the clock by step_us
+  void step(uint64_t step_us) {
+    esphome::host_clock_us.fetch_add(step_us);
+    component.loop();
+  }
+  void run(uint64_t duration_us, uint64_t loop_us = 16 * US_PER_MS) { host_run({&component}, duration_us, loop_us); }
+  uint64_t requests(uint8_t registry_id) const {
+    const auto it = hp.registries().find(registry_id);
+    return it == hp.registries().end() ? 0 : it->second.requests;
+  }
+};
+using HostRig = BasicHostRig<>;
+//________________________________________________________________ rig end
@@ -0,0 +1,213 @@
+#include "x10a_simulator.h"
+#include "daikin_package.h"
+
+#include <algorithm>
+#include <cctype>
+
+using namespace esphome;
+
+//__________________________________________________________________________________________________________________________ payloads begin
+void SimulatedHeatPump::add_registries(const RegisterTable &table) {
+  std::map<uint8_t, size_t> sizes;
+  for (const auto &row : table.rows) sizes[row.registryID] = std::max<size_t>(sizes[row.registryID], row.offset + row.dataSize);
+  for (const auto &size : sizes) {
+    Registry &registry = registries_[size.first];
+    registry.data.resize(std::max<size_t>(size.second, 1));
+    for (auto &b : registry.data) b = (uint8_t)random_.below(256);
+  }
+}
+
+void SimulatedHeatPump::set_payload(uint8_t registry_id, std::vector<uint8_t> data) {
+  Registry &registry = registries_[registry_id];
+  registry.data = std::move(data);
+  registry.script.clear();
+}
+
+// Uses the component's own stream decoder, so a capture is cut into frames exactly like the UART stream is
+size_t SimulatedHeatPump::load_capture(const std::string &hex) {
+  daikin_stream_decoder<512> decoder;
+  daikin_package frame(daikin_package::Mode::RECEIVE);
+  size_t frames = 0;
+  auto drain = [&]() {
+    for (;;) {
+      const auto result = decoder.next(frame);
+      if (result == daikin_stream_decoder<512>::Result::NEED_MORE) return;
+      if (result != daikin_stream_decoder<512>::Result::FRAME) continue;
+      registries_[frame.registry_id()].script.emplace_back(frame.data(), frame.data() + frame.size());
+      frames++;
+    }
+  };
+
+  size_t i = 0;
+  while (i < hex.size()) {
+    while (i < hex.size() && std::isspace((unsigned char)hex[i])) i++;
+    const size_t start = i;
+    while (i < hex.size() && !std::isspace((unsigned char)hex[i])) i++;
+    if (i - start != 2 || !std::isxdigit((unsigned char)hex[start]) || !std::isxdigit((unsigned char)hex[start + 1])) continue;
+    const uint8_t byte = (uint8_t)std::stoi(hex.substr(start, 2), nullptr, 16);
+    if (decoder.feed(&byte, 1) == 0) {
+      drain();
+      decoder.feed(&byte, 1);
+    }
+  }
+  drain();
+  while (decoder.buffered() > 0) {
+    decoder.resync();
+    drain();
+  }
+  return frames;
+}
+
+std::vector<uint8_t> SimulatedHeatPump::make_frame(uint8_t registry_id, const std::vector<uint8_t> &data) {
+  std::vector<uint8_t> frame;
+  frame.reserve(data.size() + 4);
+  frame.push_back(0x40);
+  frame.push_back(registry_id);
+  frame.push_back((uint8_t)(data.size() + 2));
+  for (uint8_t b : data) frame.push_back(b);
+  uint8_t sum = 0;
+  for (uint8_t b : frame) sum += b;
+  frame.push_back((uint8_t)~sum);
+  return frame;
+}
+
+std::vector<uint8_t> SimulatedHeatPump::answer_(uint8_t registry_id, Registry &registry) {
+  if (registry.script.empty()) return make_frame(registry_id, registry.data);
+  std::vector<uint8_t> frame = registry.script.front();
+  if (registry.script.size() > 1) registry.script.pop_front();
+  return frame;
+}
+//________________________________________________________________ payloads end
+
+//__________________________________________________________________________________________________________________________ line begin
+void SimulatedHeatPump::enable_outages() {
+  outages_enabled_ = true;
+  next_outage_us_ = host_clock_us.load() + (5 + random_.below(7)) * US_PER_DAY;
+}
+
+void SimulatedHeatPump::inject(const std::vector<uint8_t> &bytes, uint64_t at_us) {
+  uint64_t at = std::max(at_us, rx_.empty() ? 0 : rx_.back().first);
+  for (uint8_t b : bytes) rx_.emplace_back(at += timing.byte_us, b);
+}
+
+void SimulatedHeatPump::write_array(const uint8_t *data, size_t len) {
+  const uint64_t now = host_clock_us.load();
+  if (len != 4 || data[0] != 0x03 || data[1] != 0x40) {
+    stats_.unknown_requests++;
+    return;
+  }
+  stats_.requests++;
+  auto it = registries_.find(data[2]);
+  if (it == registries_.end() || data[3] != (uint8_t) ~(0x03 + 0x40 + data[2])) {
+    stats_.unknown_requests++;
+    return;
+  }
+  Registry &registry = it->second;
+  registry.requests++;
+  if (registry.last_request_us != 0) registry.max_gap_us = std::max(registry.max_gap_us, now - registry.last_request_us);
+  registry.last_request_us = now;
+  if (log_requests) request_log_.push_back(Request{now, data[2]});
+
+  if (outages_enabled_ && now >= next_outage_us_) {
+    outage_until_us_ = next_outage_us_ + OutageUs;
+    next_outage_us_ += (5 + random_.below(7)) * US_PER_DAY;
+    outages_++;
+  }
+  if (registry.silent || now < outage_until_us_) return;
+  if (chance_(faults.drop)) {
+    stats_.dropped++;
+    return;
+  }
+
+  std::vector<uint8_t> frame;
+  if (registry.reject) {
+    frame = {0x15, 0xEA};
+  } else {
+    frame = this->answer_(data[2], registry);
+    if (chance_(faults.corrupt) && frame.size() > 4) {
+      frame[3 + random_.below((uint32_t)frame.size() - 4)] ^= 0x10;
+      stats_.corrupted++;
+    }
+    if (chance_(faults.truncate)) {
+      frame.resize(frame.size() / 2);
+      stats_.truncated++;
+    }
+    if (chance_(faults.error_frame)) {
+      frame = {0x15, 0xEA};
+      stats_.error_frames++;
+    } else if (chance_(faults.wrong_registry)) {
+      // The next registry it has, the first one after the last
+      auto other = std::next(it);
+      if (other == registries_.end()) other = registries_.begin();
+      if (other != it) {
+        frame = make_frame(other->first, other->second.data);
+        stats_.wrong_registry++;
+      }
+    }
+  }
+  if (chance_(faults.noise)) {
+    frame.insert(frame.begin(), (uint8_t)random_.below(256));
+    stats_.noise++;
+  }
+
+  uint64_t latency = timing.latency_us + (timing.latency_jitter_us != 0 ? random_.below(timing.latency_jitter_us) : 0);
+  if (chance_(faults.late)) {
+    latency = timing.late_us;
+    stats_.late++;
+  }
+  registry.answers++;
+  stats_.answers++;
+  uint64_t at = std::max(now + len * timing.byte_us + latency, rx_.empty() ? 0 : rx_.back().first);
+  for (uint8_t b : frame) {
+    at += timing.byte_us + (timing.byte_jitter_us != 0 ? random_.below(timing.byte_jitter_us) : 0);
+    rx_.emplace_back(at, b);
+  }
+}
+
+int SimulatedHeatPump::available() {
+  const uint64_t now = host_clock_us.load();
+  int n = 0;
+  for (const auto &byte : rx_) {
+    if (byte.first > now) break;
+    n++;
+  }
+  return n;
+}
+
+bool SimulatedHeatPump::read_array(uint8_t *data, size_t len) {
+  const uint64_t now = host_clock_us.load();
+  for (size_t i = 0; i < len; i++) {
+    if (rx_.empty() || rx_.front().first > now) return false;
+    data[i] = rx_.front().second;
+    rx_.pop_front();
+  }
+  return true;
+}
+//________________________________________________________________ line end
+
+//__________________________________________________________________________________________________________________________ statistics begin
+void SimulatedHeatPump::drift() {
+  for (auto &entry : registries_) {
+    if (random_.below(10) >= 4) continue;
+    auto &data = entry.second.data;
+    if (data.empty()) continue;
+    data[random_.below((uint32_t)data.size())] += random_.below(2) ? 1 : -1;
+  }
+}
+
+void SimulatedHeatPump::check_gaps(uint64_t now, uint64_t allowed_us, uint64_t silent_allowed_us) {
+  for (auto &entry : registries_) {
+    Registry &registry = entry.second;
+    if (registry.last_request_us == 0) continue;
+    const uint64_t allowed = registry.silent || registry.reject ? silent_allowed_us : allowed_us;
+    if (now - registry.last_request_us <= allowed) continue;
+    registry.missed++;
+    registry.last_request_us = now;  // one miss per allowed interval
+  }
+}
+
+bool SimulatedHeatPump::answers(uint8_t registry_id) const {
+  auto it = registries_.find(registry_id);
+  return it != registries_.end() && !it->second.silent && !it->second.reject;
+}
+//________________________________________________________________ statistics end
@@ -0,0 +1,135 @@
+// x10a_simulator.h
+#pragma once
+
+#include "x10a_host.h"
+#include "esphome/components/uart/uart.h"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Faults, per million requests. All off by default: the heat pump answers every request correctly until a test asks for more
+struct FaultRates {
+  uint32_t drop{0};            // no answer at all
+  uint32_t corrupt{0};         // one data bit flipped, so the checksum does not match
+  uint32_t truncate{0};        // the answer stops halfway
+  uint32_t noise{0};           // a stray byte on the line before the answer
+  uint32_t late{0};            // the answer starts Timing::late_us after the request, past the poller's allowance
+  uint32_t error_frame{0};     // 15 EA instead of the frame
+  uint32_t wrong_registry{0};  // the frame of another registry instead
+};
+
+// The first byte follows the end of the request after latency_us plus up to latency_jitter_us; every byte then takes byte_us (one
+// character at 9600 8E1) plus up to byte_jitter_us
+struct Timing {
+  uint64_t latency_us{30 * US_PER_MS};
+  uint32_t latency_jitter_us{30000};
+  uint64_t byte_us{1146};
+  uint32_t byte_jitter_us{0};
+  uint64_t late_us{400 * US_PER_MS};
+};
+
+//__________________________________________________________________________________________________________________________ heat pump begin
+// The X10A side of the UART, on the virtual clock: answers 03 40 <registry> <crc> with 40 <registry> <length> <data> <checksum>.
+// The payload of every registry is configurable, or comes from a captured debug log; registries it does not know are not answered
+class SimulatedHeatPump : public esphome::uart::UARTComponent {
+ public:
+  static constexpr uint64_t OutageUs = 5 * US_PER_MIN;
+
+  struct Registry {
+    std::vector<uint8_t> data;                // payload of the answer
+    std::deque<std::vector<uint8_t>> script;  // captured frames, answered in order; the last one stays
+    bool silent{false};                       // never answers
+    bool reject{false};                       // answers with an error frame
+    uint64_t requests{0};
+    uint64_t answers{0};
+    uint64_t last_request_us{0};
+    uint64_t max_gap_us{0};
+    uint64_t missed{0};                       // see check_gaps()
+  };
+
+  struct Stats {
+    uint64_t requests{0};
+    uint64_t unknown_requests{0};  // malformed, or a registry it does not have
+    uint64_t answers{0};
+    uint64_t dropped{0};
+    uint64_t corrupted{0};
+    uint64_t truncated{0};
+    uint64_t noise{0};
+    uint64_t late{0};
+    uint64_t error_frames{0};
+    uint64_t wrong_registry{0};
+  };
+
+  // A request the heat pump understood, for the tests of the poll schedule
+  struct Request {
+    uint64_t at_us;
+    uint8_t registry_id;
+  };
+
+  explicit SimulatedHeatPump(uint64_t seed = 1) : random_(seed) {}
+
+  FaultRates faults;
+  Timing timing;
+  bool log_requests{false};  // keep every request in request_log()
+
+  // Another baud rate (8E1): the component reads it in setup(), the answers take one character time per byte
+  void set_baud(uint32_t baud_rate) {
+    this->set_baud_rate(baud_rate);
+    timing.byte_us = (11 * US_PER_S + baud_rate - 1) / baud_rate;
+  }
+
+  // Every registry of the table, with a random payload long enough for its furthest register
+  void add_registries(const RegisterTable &table);
+  void set_payload(uint8_t registry_id, std::vector<uint8_t> data);
+  std::vector<uint8_t> &payload(uint8_t registry_id) { return registries_[registry_id].data; }
+  void set_silent(uint8_t registry_id, bool silent) { registries_[registry_id].silent = silent; }
+  void set_reject(uint8_t registry_id, bool reject) { registries_[registry_id].reject = reject; }
+
+  // Frames of a captured debug log ("40 10 1D ... B1", every two-digit hex token is one byte, as daikin_package::to_hex() prints
+  // them) become the answers of their registries, in capture order. Returns the number of frames found
+  size_t load_capture(const std::string &hex);
+
+  // Goes quiet for OutageUs every 5 to 11 days, like a heat pump that reboots now and then
+  void enable_outages();
+  // Puts bytes on the line from at_us on, one per Timing::byte_us, whether anybody asked or not
+  void inject(const std::vector<uint8_t> &bytes, uint64_t at_us);
+  static std::vector<uint8_t> make_frame(uint8_t registry_id, const std::vector<uint8_t> &data);
+
+  // UARTComponent
+  void write_array(const uint8_t *data, size_t len) override;
+  int available() override;
+  bool read_array(uint8_t *data, size_t len) override;
+
+  // A few bytes of some registries move by one, so some frames change between two polls and some do not
+  void drift();
+  // A gap between two requests of a registry longer than allowed counts as a missed poll (silent_allowed_us for the registries that
+  // do not answer)
+  void check_gaps(uint64_t now, uint64_t allowed_us, uint64_t silent_allowed_us);
+
+  bool answers(uint8_t registry_id) const;
+  const std::map<uint8_t, Registry> &registries() const { return registries_; }
+  const Stats &stats() const { return stats_; }
+  uint64_t requests() const { return stats_.requests; }
+  const std::vector<Request> &request_log() const { return request_log_; }
+  uint32_t outages() const { return outages_; }
+  size_t line_bytes() const { return rx_.size(); }  // on the line or still to come, not read yet
+
+ private:
+  bool chance_(uint32_t rate) { return rate != 0 && random_.per_million(rate); }
+  std::vector<uint8_t> answer_(uint8_t registry_id, Registry &registry);
+
+  Random random_;
+  std::map<uint8_t, Registry> registries_;
+  std::deque<std::pair<uint64_t, uint8_t>> rx_;  // (virtual time the byte is on the line, byte)
+  Stats stats_;
+  std::vector<Request> request_log_;
+  bool outages_enabled_{false};
+  uint64_t next_outage_us_{0};
+  uint64_t outage_until_us_{0};
+  uint32_t outages_{0};
+};
+//________________________________________________________________ heat pump end
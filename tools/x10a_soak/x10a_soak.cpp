@@ -0,0 +1,535 @@
+// Endurance soak of the daikin_x10a component on the host. DaikinX10A runs against a simulated X10A heat pump behind the UART, on
+// a virtual clock. 60 days, through the 49.7 day millis() wraparound, take about half a minute. Along the way it tracks the heap (peak,
+// growth, allocations per day, fragmentation), the latency of every loop() pass, missed polls and sensor publishes. At the end
+// it compares them with a stored baseline and exits 1 on a regression.
+//
+//   cmake -S . -B build && cmake --build build --target x10a_soak
+//   build/x10a_soak                               (reads m5poe.yaml, compares with tools/x10a_soak/baseline.txt)
+//   build/x10a_soak --write-baseline              (after a change that is meant to move the numbers)
+//   build/x10a_soak --days 120 --seed 7 --yaml-modes -v
+//
+// It builds on the host target of CMakeLists.txt (tools/x10a_host): the shim stands in for ESPHome, the component is the
+// daikin_x10a_soak library (the features it is compiled with are listed there) and SimulatedHeatPump is the heat pump. The register
+// table comes from the YAML; every register is read (mode 1) unless --yaml-modes keeps the modes of the YAML. The heat pump does not
+// answer --silent registries (0xA1 by default). It also drops, corrupts, truncates and delays single answers, and goes quiet for 5
+// minutes every week or so. Loop latencies are wall-clock and depend on the machine, so they are only printed; what is compared is
+// how the last day's p99 drifted from the first day's. Everything else only depends on the virtual clock and the seed. ctest runs
+// the default configuration against the stored baseline.
+
+#include "daikin_x10a.h"
+#include "x10a_simulator.h"
+#include "esphome/core/log.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <new>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using namespace esphome;
+using namespace esphome::daikin_x10a;
+
+static constexpr uint64_t MILLIS_WRAP_US = (1ULL << 32) * US_PER_MS;
+
+// Component settings, the YAML defaults
+static constexpr uint32_t ScanIntervalMs = 30000;
+static constexpr uint32_t BootDelayMs = 15000;
+static constexpr uint8_t AdaptiveBackoff = 4;
+static constexpr uint32_t PublishMaxAgeMs = 300000;
+static constexpr uint32_t ReprobeIntervalMs = 3600000;
+static constexpr uint32_t WarmStartWriteMs = 900000;
+static constexpr uint32_t FlashWriteIntervalMs = 60000;  // ESPHome's preferences commit staged records at this interval
+
+//__________________________________________________________________________________________________________________________ heap begin
+// Every allocation carries a header with its size; only blocks allocated while the component runs (setup, loop, timers) are counted,
+// so the soak's own bookkeeping does not show up
+struct HeapStats {
+  bool counting{false};
+  uint64_t live_bytes{0};
+  uint64_t peak_bytes{0};
+  uint64_t allocations{0};
+  uint64_t live_blocks{0};
+};
+static HeapStats heap;
+
+struct alignas(16) BlockHeader {
+  size_t size;
+  bool counted;
+};
+
+static void *soak_alloc(size_t size) {
+  auto *header = static_cast<BlockHeader *>(std::malloc(sizeof(BlockHeader) + size));
+  if (header == nullptr) throw std::bad_alloc();
+  header->size = size;
+  header->counted = heap.counting;
+  if (heap.counting) {
+    heap.live_bytes += size;
+    heap.live_blocks++;
+    heap.allocations++;
+    heap.peak_bytes = std::max(heap.peak_bytes, heap.live_bytes);
+  }
+  return header + 1;
+}
+
+static void soak_free(void *ptr) {
+  if (ptr == nullptr) return;
+  auto *header = static_cast<BlockHeader *>(ptr) - 1;
+  if (header->counted) {
+    heap.live_bytes -= header->size;
+    heap.live_blocks--;
+  }
+  std::free(header);
+}
+
+void *operator new(size_t size) { return soak_alloc(size); }
+void *operator new[](size_t size) { return soak_alloc(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return soak_alloc(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+void operator delete(void *ptr) noexcept { soak_free(ptr); }
+void operator delete[](void *ptr) noexcept { soak_free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { soak_free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { soak_free(ptr); }
+
+struct CountHeap {
+  CountHeap() { heap.counting = true; }
+  ~CountHeap() { heap.counting = false; }
+};
+
+struct Uncounted {
+  bool was{heap.counting};
+  Uncounted() { heap.counting = false; }
+  ~Uncounted() { heap.counting = was; }
+};
+
+// The heat pump is test equipment: what it allocates to queue its answers is not the component's
+class HeatPump : public SimulatedHeatPump {
+ public:
+  using SimulatedHeatPump::SimulatedHeatPump;
+  void write_array(const uint8_t *data, size_t len) override {
+    Uncounted uncounted;
+    SimulatedHeatPump::write_array(data, len);
+  }
+  int available() override {
+    Uncounted uncounted;
+    return SimulatedHeatPump::available();
+  }
+  bool read_array(uint8_t *data, size_t len) override {
+    Uncounted uncounted;
+    return SimulatedHeatPump::read_array(data, len);
+  }
+};
+
+// Free memory the allocator holds below its top, relative to everything it holds: memory that is free but cut into pieces
+static double fragmentation_percent() {
+#ifdef __GLIBC__
+  const struct mallinfo2 info = mallinfo2();
+  const double held = static_cast<double>(info.uordblks + info.fordblks);
+  if (held == 0) return 0.0;
+  return 100.0 * static_cast<double>(info.fordblks - std::min(info.fordblks, info.keepcost)) / held;
+#else
+  return 0.0;
+#endif
+}
+//________________________________________________________________ heap end
+
+//__________________________________________________________________________________________________________________________ log begin
+static unsigned log_printed = 0;
+static constexpr unsigned Log_MaxPrinted = 200;
+
+static std::string day_time(uint64_t us) {
+  char text[32];
+  const uint64_t s = us / US_PER_S;
+  std::snprintf(text, sizeof(text), "day %" PRIu64 " %02u:%02u:%02u", s / 86400, (unsigned)(s / 3600 % 24), (unsigned)(s / 60 % 60),
+                (unsigned)(s % 60));
+  return text;
+}
+
+// host_log_sink: the shim formats, this adds the virtual time and stops after Log_MaxPrinted lines
+static void soak_log(int level, const char *tag, const char *text) {
+  if (log_printed >= Log_MaxPrinted) return;
+  Uncounted uncounted;
+  static const char *const Levels = "?EWIDV";
+  std::printf("[%s] %c %s: %s\n", day_time(host_clock_us.load()).c_str(), Levels[level], tag, text);
+  if (++log_printed == Log_MaxPrinted) std::printf("(further log lines suppressed)\n");
+}
+//________________________________________________________________ log end
+
+//__________________________________________________________________________________________________________________________ latency begin
+// Log-linear histogram of wall-clock nanoseconds: 4 buckets per power of two
+struct LatencyHistogram {
+  std::array<uint64_t, 64 * 4> buckets{};
+  uint64_t count{0};
+  uint64_t max_ns{0};
+
+  static size_t bucket_of(uint64_t ns) {
+    if (ns < 4) return (size_t)ns;
+    const int log2 = 63 - __builtin_clzll(ns);
+    return (size_t)log2 * 4 + ((ns >> (log2 - 2)) & 3);
+  }
+  static uint64_t upper_bound(size_t bucket) {
+    if (bucket < 4) return bucket;
+    const int log2 = (int)(bucket / 4);
+    return ((4 + bucket % 4 + 1) << (log2 - 2)) - 1;
+  }
+  void add(uint64_t ns) {
+    buckets[bucket_of(ns)]++;
+    count++;
+    max_ns = std::max(max_ns, ns);
+  }
+  double percentile_us(double fraction) const {
+    if (count == 0) return 0.0;
+    const uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(count * fraction));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+      seen += buckets[i];
+      if (seen >= rank) return std::min(upper_bound(i), max_ns) / 1000.0;
+    }
+    return max_ns / 1000.0;
+  }
+};
+
+static uint64_t wall_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+//________________________________________________________________ latency end
+
+//__________________________________________________________________________________________________________________________ baseline begin
+static std::string config_line(int days, uint64_t seed, size_t registers, bool read_all, const std::string &silent) {
+  std::ostringstream line;
+  line << "days=" << days << " seed=" << seed << " registers=" << registers << " read_all=" << (read_all ? 1 : 0) << " silent=" << silent;
+  return line.str();
+}
+//________________________________________________________________ baseline end
+
+//__________________________________________________________________________________________________________________________ soak begin
+struct Options {
+  int days{60};
+  uint64_t seed{1};
+  uint32_t loop_ms{16};
+  bool read_all{true};
+  std::string yaml{"m5poe.yaml"};
+  std::string baseline{"tools/x10a_soak/baseline.txt"};
+  bool write{false};
+  std::set<uint8_t> silent{0xA1};
+  std::set<uint8_t> reject;
+  FaultRates faults{2000, 2000, 1000, 1000, 1000};
+};
+
+static std::set<uint8_t> parse_registries(const char *list) {
+  std::set<uint8_t> ids;
+  std::istringstream in(list);
+  std::string id;
+  while (std::getline(in, id, ',')) {
+    if (!id.empty()) ids.insert((uint8_t)std::stoi(id, nullptr, 0));
+  }
+  return ids;
+}
+
+static std::string format_registries(const std::set<uint8_t> &ids) {
+  std::string text;
+  char id[8];
+  for (uint8_t r : ids) {
+    std::snprintf(id, sizeof(id), "%s0x%02X", text.empty() ? "" : ",", r);
+    text += id;
+  }
+  return text.empty() ? "none" : text;
+}
+
+static void usage() {
+  std::printf("usage: x10a_soak [--days N] [--seed N] [--loop-ms N] [--yaml PATH] [--yaml-modes] [--silent 0xA1,...] [--reject ...]\n"
+              "                 [--no-faults] [--baseline PATH] [--write-baseline] [-v|-q]\n");
+}
+
+int main(int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (arg == "--days" && has_value) {
+      options.days = std::atoi(argv[++i]);
+    } else if (arg == "--seed" && has_value) {
+      options.seed = std::strtoull(argv[++i], nullptr, 0);
+    } else if (arg == "--loop-ms" && has_value) {
+      options.loop_ms = (uint32_t)std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--yaml" && has_value) {
+      options.yaml = argv[++i];
+    } else if (arg == "--yaml-modes") {
+      options.read_all = false;
+    } else if (arg == "--silent" && has_value) {
+      options.silent = parse_registries(argv[++i]);
+    } else if (arg == "--reject" && has_value) {
+      options.reject = parse_registries(argv[++i]);
+    } else if (arg == "--no-faults") {
+      options.faults = FaultRates{};
+    } else if (arg == "--baseline" && has_value) {
+      options.baseline = argv[++i];
+    } else if (arg == "--write-baseline") {
+      options.write = true;
+    } else if (arg == "-v") {
+      host_log_level++;
+    } else if (arg == "-q") {
+      host_log_level = 1;
+    } else {
+      usage();
+      return 2;
+    }
+  }
+
+  RegisterTable table;
+  if (!load_registers(options.yaml, options.read_all, table)) {
+    std::printf("no register lines in %s (run from the repository root, or pass --yaml)\n", options.yaml.c_str());
+    return 2;
+  }
+  host_log_sink = soak_log;
+  HeatPump hp(options.seed);
+  hp.add_registries(table);
+  for (uint8_t id : options.silent) hp.set_silent(id, true);
+  for (uint8_t id : options.reject) hp.set_reject(id, true);
+  hp.faults = options.faults;
+  hp.enable_outages();
+  DaikinX10A component(&hp);
+  component.set_instance_name("soak");
+  component.set_register_table(table.rows.data(), (uint16_t)table.rows.size());
+  component.set_scan_interval(ScanIntervalMs);
+  component.set_boot_delay(BootDelayMs);
+  component.set_adaptive_backoff(AdaptiveBackoff);
+  component.set_publish_max_age(PublishMaxAgeMs);
+  component.set_reprobe_interval(ReprobeIntervalMs);
+  component.set_warm_start_write_interval(WarmStartWriteMs);
+
+  // A sensor for every mode 1 register, like __init__.py generates them
+  std::deque<sensor::Sensor> sensors;
+  std::deque<text_sensor::TextSensor> text_sensors;
+  struct Bound {
+    uint8_t registry_id;
+    const uint64_t *publishes;
+    const uint64_t *last_publish_us;
+    uint64_t stalled_since_us{0};
+  };
+  std::vector<Bound> bound;
+  for (uint16_t handle = 0; handle < table.rows.size(); handle++) {
+    const RegisterDef &row = table.rows[handle];
+    if (row.Mode != 1 || row.convid == 0x00) continue;
+    if (text_convid(row.convid)) {
+      text_sensors.emplace_back();
+      component.bind_text_sensor(handle, &text_sensors.back());
+      bound.push_back(Bound{row.registryID, &text_sensors.back().publishes, &text_sensors.back().last_publish_us});
+    } else {
+      sensors.emplace_back();
+      component.bind_sensor(handle, &sensors.back());
+      bound.push_back(Bound{row.registryID, &sensors.back().publishes, &sensors.back().last_publish_us});
+    }
+  }
+
+  // Diagnostics, a derived metric with its integral, and a history of two registers, when the YAML has the registers for them
+  std::deque<sensor::Sensor> extra_sensors;
+  auto extra = [&]() {
+    extra_sensors.emplace_back();
+    return &extra_sensors.back();
+  };
+  component.set_diagnostics_interval(60000);
+  component.set_round_trip_p99_sensor(extra());
+  component.set_timeouts_sensor(extra());
+  component.set_sweep_duration_sensor(extra());
+  component.set_loop_time_max_sensor(extra());
+  component.set_stale_registries_sensor(extra());
+  text_sensor::TextSensor probe_sensor;
+  component.set_registry_probe_sensor(&probe_sensor);
+  const auto flow = component.find_register("Flow sensor (l/min)");
+  const auto lwt = component.find_register("Leaving water temp. after BUH (R2T)");
+  const auto iwt = component.find_register("Inlet water temp.(R4T)");
+  static std::vector<DerivedOp> ops;
+  static std::vector<DerivedDef> defs;
+  if (flow != DaikinX10A::NO_REGISTER && lwt != DaikinX10A::NO_REGISTER && iwt != DaikinX10A::NO_REGISTER) {
+    // max(0, flow * (lwt - iwt)) * 4.18 / 60, and its integral
+    ops = {{DerivedOp::CONST, 0, 0.0f},      {DerivedOp::REGISTER, flow, 0}, {DerivedOp::REGISTER, lwt, 0}, {DerivedOp::REGISTER, iwt, 0},
+           {DerivedOp::SUB, 0, 0},           {DerivedOp::MUL, 0, 0},         {DerivedOp::MAX, 0, 0},        {DerivedOp::CONST, 0, 4.18f},
+           {DerivedOp::MUL, 0, 0},           {DerivedOp::CONST, 0, 60.0f},   {DerivedOp::DIV, 0, 0}};
+    defs = {{0, (uint8_t)ops.size(), DERIVED_NO_METRIC, 0, 0}, {0, 0, 0, 300000, 0}};
+    component.set_derived_metrics(ops.data(), defs.data(), (uint8_t)defs.size());
+    component.bind_derived_sensor(0, extra());
+    component.bind_derived_sensor(1, extra());
+    component.set_history_storage(4096, 360, 672, 0.1f, 900000, false);
+    component.add_history_register(lwt);
+    component.add_history_register(iwt);
+  }
+
+  const uint64_t end_us = (uint64_t)options.days * US_PER_DAY;
+  const uint64_t loop_us = options.loop_ms * US_PER_MS;
+  const uint64_t poll_allowed_us = ScanIntervalMs * US_PER_MS * AdaptiveBackoff + 60 * US_PER_S;
+  const uint64_t silent_allowed_us = ReprobeIntervalMs * US_PER_MS + 60 * US_PER_S;
+  const uint64_t stall_allowed_us =
+      (PublishMaxAgeMs + ScanIntervalMs * AdaptiveBackoff) * US_PER_MS + SimulatedHeatPump::OutageUs + 2 * US_PER_MIN;
+
+  LatencyHistogram all, first_day, last_day;
+  uint64_t live_after_first_day = 0, allocations_after_first_day = 0;
+  double fragmentation_peak = 0.0;
+  uint64_t stalls = 0;
+  uint32_t sweep_max_ms = 0;
+  bool wrapped = false;
+  const uint64_t wall_start = wall_ns();
+  Random jitter(options.seed ^ 0x5EEDULL);
+
+  {
+    CountHeap count;
+    component.setup();
+  }
+  std::printf("%u registers, %u sensors, %u registries, %d days, seed %" PRIu64 "\n", (unsigned)table.rows.size(), (unsigned)bound.size(),
+              (unsigned)hp.registries().size(), options.days, options.seed);
+
+  uint64_t next_minute = US_PER_MIN, next_hour = US_PER_HOUR, next_flash = FlashWriteIntervalMs * US_PER_MS;
+  uint64_t now = 0;
+  while (now < end_us) {
+    // One pass of App.loop(): due timers, then loop()
+    const uint64_t start = wall_ns();
+    {
+      CountHeap count;
+      host_loop({&component});
+    }
+    const uint64_t ns = wall_ns() - start;
+    all.add(ns);
+    if (now >= US_PER_DAY && now < 2 * US_PER_DAY) first_day.add(ns);
+    if (now + US_PER_DAY >= end_us) last_day.add(ns);
+
+    host_clock_us.fetch_add(loop_us + jitter.below(2000));
+    now = host_clock_us.load();
+    if (!wrapped && now >= MILLIS_WRAP_US) {
+      wrapped = true;
+      std::printf("[%s] millis() wrapped\n", day_time(now).c_str());
+    }
+
+    if (now >= next_flash) {
+      next_flash += FlashWriteIntervalMs * US_PER_MS;
+      global_preferences->sync();
+    }
+    if (now < next_minute) continue;
+    next_minute += US_PER_MIN;
+    hp.drift();
+    hp.check_gaps(now, poll_allowed_us, silent_allowed_us);
+    sweep_max_ms = std::max(sweep_max_ms, component.get_last_sweep_ms());
+
+    if (now < next_hour) continue;
+    next_hour += US_PER_HOUR;
+    fragmentation_peak = std::max(fragmentation_peak, fragmentation_percent());
+    for (auto &b : bound) {
+      // A sensor that published before and then stays silent longer than heartbeat, backoff and an outage explain has stalled
+      if (!hp.answers(b.registry_id) || *b.publishes == 0) continue;
+      const bool stalled = now - *b.last_publish_us > stall_allowed_us;
+      if (stalled && b.stalled_since_us == 0) {
+        stalls++;
+        b.stalled_since_us = now;
+      } else if (!stalled) {
+        b.stalled_since_us = 0;
+      }
+    }
+    if (now / US_PER_HOUR == 48) {
+      live_after_first_day = heap.live_bytes;
+      allocations_after_first_day = heap.allocations;
+    }
+    if (now / US_PER_HOUR % 240 == 0)
+      std::printf("[%s] heap %" PRIu64 " bytes in %" PRIu64 " blocks (peak %" PRIu64 "), %" PRIu64 " requests, %.0f s\n",
+                  day_time(now).c_str(), heap.live_bytes, heap.live_blocks, heap.peak_bytes, hp.requests(),
+                  (wall_ns() - wall_start) / 1e9);
+  }
+  {
+    CountHeap count;
+    component.on_shutdown();
+  }
+  hp.check_gaps(now, poll_allowed_us, silent_allowed_us);
+
+  //________________________________________________________________ report
+  uint64_t missed = 0, max_gap_us = 0, publishes = 0;
+  unsigned never_published = 0;
+  for (const auto &entry : hp.registries()) {
+    missed += entry.second.missed;
+    if (!entry.second.silent && !entry.second.reject) max_gap_us = std::max(max_gap_us, entry.second.max_gap_us);
+  }
+  for (const auto &b : bound) {
+    publishes += *b.publishes;
+    if (*b.publishes == 0 && hp.answers(b.registry_id)) never_published++;
+  }
+  const double days = options.days;
+  const double steady_days = std::max(1.0, days - 2);
+  std::vector<Metric> metrics = {
+      {"missed_polls", (double)missed, Rule::LOWER, 0, 0},
+      {"max_poll_gap_s", max_gap_us / 1e6, Rule::LOWER, 0.1, 1},
+      {"stalled_sensors", (double)stalls, Rule::LOWER, 0, 0},
+      {"sensors_never_published", (double)never_published, Rule::LOWER, 0, 0},
+      {"requests_per_day", hp.requests() / days, Rule::BOTH, 0.05, 10},
+      {"publishes_per_day", publishes / days, Rule::BOTH, 0.05, 10},
+      {"timeouts_per_day", component.get_timeouts() / days, Rule::LOWER, 0.1, 5},
+      {"crc_mismatches", (double)component.get_crc_mismatches(), Rule::INFO, 0, 0},
+      {"error_frames", (double)component.get_error_frames(), Rule::INFO, 0, 0},
+      {"wrong_registry_frames", (double)component.get_wrong_registry_frames(), Rule::INFO, 0, 0},
+      {"dead_registries", (double)component.get_dead_registries(), Rule::BOTH, 0, 0},
+      {"sweep_max_s", sweep_max_ms / 1000.0, Rule::LOWER, 0.1, 0.5},
+      {"warnings", (double)(host_log_counts[1] + host_log_counts[2]), Rule::LOWER, 0.1, 2},
+      {"heap_peak_bytes", (double)heap.peak_bytes, Rule::LOWER, 0.1, 1024},
+      {"heap_growth_bytes", (double)heap.live_bytes - (double)live_after_first_day, Rule::LOWER, 0, 1024},
+      {"allocations_per_day", (heap.allocations - allocations_after_first_day) / steady_days, Rule::LOWER, 0.1, 100},
+      {"fragmentation_pct", fragmentation_peak, Rule::LOWER, 0, 5},
+      {"flash_writes_per_day", host_flash.writes / days, Rule::LOWER, 0.1, 5},
+      {"loop_p50_us", all.percentile_us(0.50), Rule::INFO, 0, 0},
+      {"loop_p99_us", all.percentile_us(0.99), Rule::INFO, 0, 0},
+      {"loop_p999_us", all.percentile_us(0.999), Rule::INFO, 0, 0},
+      {"loop_p99_drift", last_day.percentile_us(0.99) / std::max(0.001, first_day.percentile_us(0.99)), Rule::LOWER, 0.5, 0.5},
+      {"loop_max_us", all.max_ns / 1000.0, Rule::INFO, 0, 0},
+  };
+
+  std::printf("\n%" PRIu64 " loop() passes in %.1f s, %u heat pump outages, millis() %s\n", all.count, (wall_ns() - wall_start) / 1e9,
+              hp.outages(), wrapped ? "wrapped" : "did not wrap (fewer than 50 days)");
+  std::printf("registry probe: %s\n", probe_sensor.state.c_str());
+
+  const std::string config = config_line(options.days, options.seed, table.rows.size(), options.read_all, format_registries(options.silent));
+  if (options.write) {
+    write_baseline(options.baseline,
+                   {"x10a_soak baseline, written with --write-baseline; loop_* are wall-clock and machine specific, only "
+                    "loop_p99_drift is compared",
+                    "allocations_per_day: the component allocates nothing once it runs and the simulated heat pump is not counted; "
+                    "what is left",
+                    "is the shim's ESPPreferenceObject::save(), which stages every record in host_flash (a map node and a vector per "
+                    "flash write)"},
+                   config, metrics);
+    for (const auto &metric : metrics) std::printf("  %-26s %12.6g\n", metric.key.c_str(), metric.value);
+    std::printf("baseline written to %s\n", options.baseline.c_str());
+    return 0;
+  }
+
+  std::string baseline_config;
+  std::map<std::string, double> baseline;
+  const bool have_baseline = read_baseline(options.baseline, baseline_config, baseline);
+  if (have_baseline && baseline_config != config) {
+    std::printf("%s was written for %s, this run is %s; compare like with like or pass --write-baseline\n", options.baseline.c_str(),
+                baseline_config.c_str(), config.c_str());
+    return 2;
+  }
+  const int regressions = compare_baseline(metrics, baseline);
+  if (!have_baseline) {
+    std::printf("no baseline at %s; --write-baseline stores this run as one\n", options.baseline.c_str());
+    return 0;
+  }
+  std::printf("%s\n", regressions == 0 ? "PASS" : "FAIL");
+  return regressions == 0 ? 0 : 1;
+}
+//________________________________________________________________ soak end
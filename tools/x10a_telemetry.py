@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""Listener for the daikin_x10a telemetry stream; writes every record as a CSV row.
+
+The stream format is described in components/daikin_x10a/daikin_telemetry.h.
+
+    x10a_telemetry.py --udp 5555 -o capture.csv
+    x10a_telemetry.py --tcp 5555 --table .esphome/build/m5poe/src/main.cpp
+    x10a_telemetry.py --file capture.bin            (a raw stream saved earlier with --raw)
+
+VALUE records carry a register handle, the row of the register table generated into main.cpp; with --table the handle is
+resolved to the register's label.
+"""
+
+import argparse
+import csv
+import re
+import signal
+import socket
+import struct
+import sys
+
+HEADER = struct.Struct("<2sBBHI")  # 'XT', version, record count, records length, batch sequence
+RECORD = struct.Struct("<BHI")  # type, payload length, timestamp (us)
+VALUE = struct.Struct("<HBBf")  # handle, kind, raw, number
+
+RECORD_TYPES = {1: "frame", 2: "request", 3: "value"}
+VALUE_KINDS = ["none", "number", "enum", "text", "not_available", "unsupported"]
+COLUMNS = ["batch", "time_s", "type", "registry", "handle", "label", "kind", "value", "bytes"]
+
+
+def load_labels(path):
+    """Labels of the generated register table, in handle order."""
+    with open(path, encoding="utf-8") as f:
+        source = f.read()
+    table = re.search(r"_register_table\[\] = \{(.*?)\n\};", source, re.S)
+    if table is None:
+        sys.exit(f"{path}: no register table found")
+    return [bytes(m.group(1), "utf-8").decode("unicode_escape") for m in re.finditer(r'^\s*\{"((?:[^"\\]|\\.)*)"', table.group(1), re.M)]
+
+
+class Decoder:
+    def __init__(self, writer, labels):
+        self.writer = writer
+        self.labels = labels
+        self.buffer = b""
+        self.last_sequence = None
+        self.lost_batches = 0
+        self.base_us = None
+        self.last_us = 0
+        self.wraps = 0
+
+    def feed(self, data):
+        """Accepts any chunk of the stream; complete batches are written out."""
+        self.buffer += data
+        while len(self.buffer) >= HEADER.size:
+            magic, version, count, length, sequence = HEADER.unpack_from(self.buffer)
+            if magic != b"XT" or version != 1:
+                # Out of step (e.g. a TCP capture that starts mid-batch): look for the next header
+                start = self.buffer.find(b"XT", 1)
+                self.buffer = self.buffer[start:] if start > 0 else self.buffer[-1:]
+                continue
+            if len(self.buffer) < HEADER.size + length:
+                return
+            records = self.buffer[HEADER.size:HEADER.size + length]
+            self.buffer = self.buffer[HEADER.size + length:]
+            self.batch(sequence, count, records)
+
+    def batch(self, sequence, count, records):
+        if self.last_sequence is not None and sequence != (self.last_sequence + 1) & 0xFFFFFFFF:
+            self.lost_batches += (sequence - self.last_sequence - 1) & 0xFFFFFFFF
+        self.last_sequence = sequence
+
+        pos = 0
+        for _ in range(count):
+            kind, length, timestamp = RECORD.unpack_from(records, pos)
+            payload = records[pos + RECORD.size:pos + RECORD.size + length]
+            pos += RECORD.size + length
+            self.record(sequence, kind, self.time_s(timestamp), payload)
+
+    def time_s(self, timestamp):
+        # micros() wraps every ~71 minutes
+        if timestamp < self.last_us and self.last_us - timestamp > 1 << 31:
+            self.wraps += 1
+        self.last_us = timestamp
+        us = timestamp + (self.wraps << 32)
+        if self.base_us is None:
+            self.base_us = us
+        return (us - self.base_us) / 1e6
+
+    def record(self, sequence, kind, time_s, payload):
+        row = dict.fromkeys(COLUMNS, "")
+        row.update(batch=sequence, time_s=f"{time_s:.6f}", type=RECORD_TYPES.get(kind, kind))
+        if kind in (1, 2):
+            row["registry"] = f"0x{payload[1] if kind == 1 else payload[2]:02X}" if len(payload) > 2 else ""
+            row["bytes"] = payload.hex(" ").upper()
+        elif kind == 3:
+            handle, value_kind, raw, number = VALUE.unpack(payload)
+            row.update(handle=handle, kind=VALUE_KINDS[value_kind] if value_kind < len(VALUE_KINDS) else value_kind)
+            if handle < len(self.labels):
+                row["label"] = self.labels[handle]
+            row["value"] = raw if value_kind == 2 else ("" if number != number else f"{number:g}")
+        self.writer.writerow(row)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--udp", type=int, metavar="PORT", help="listen for UDP batches")
+    source.add_argument("--tcp", type=int, metavar="PORT", help="accept one TCP connection at a time")
+    source.add_argument("--file", help="decode a raw stream saved with --raw")
+    parser.add_argument("--bind", default="0.0.0.0", help="address to listen on")
+    parser.add_argument("--table", help="generated main.cpp, to turn register handles into labels")
+    parser.add_argument("--raw", help="also save the raw stream to this file")
+    parser.add_argument("-o", "--output", help="CSV file (default: stdout)")
+    args = parser.parse_args()
+
+    labels = load_labels(args.table) if args.table else []
+    out = open(args.output, "w", newline="", encoding="utf-8") if args.output else sys.stdout
+    raw = open(args.raw, "ab") if args.raw else None
+    writer = csv.DictWriter(out, fieldnames=COLUMNS)
+    writer.writeheader()
+    decoder = Decoder(writer, labels)
+
+    def feed(data):
+        if raw:
+            raw.write(data)
+            raw.flush()
+        decoder.feed(data)
+        out.flush()
+
+    signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+    try:
+        if args.file:
+            with open(args.file, "rb") as f:
+                feed(f.read())
+        elif args.udp is not None:
+            sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            sock.bind((args.bind, args.udp))
+            while True:
+                feed(sock.recv(65535))
+        else:
+            server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+            server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+            server.bind((args.bind, args.tcp))
+            server.listen(1)
+            while True:
+                conn, _ = server.accept()
+                decoder.buffer = b""
+                with conn:
+                    while data := conn.recv(65535):
+                        feed(data)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if decoder.lost_batches:
+            print(f"{decoder.lost_batches} batches lost", file=sys.stderr)
+        if raw:
+            raw.close()
+
+
+if __name__ == "__main__":
+    main()